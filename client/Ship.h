@@ -7,6 +7,10 @@
 // Ориентация корабля
 enum class Orientation { Horizontal, Vertical };
 
+// Состав флота: один 4-палубный, два 3-, три 2- и четыре 1-палубных
+const int FLEET_SIZES[] = {4, 3, 3, 2, 2, 2, 1, 1, 1, 1};
+const int FLEET_SHIP_COUNT = sizeof(FLEET_SIZES) / sizeof(FLEET_SIZES[0]);
+
 class Ship {
 public:
     int id;             // Уникальный ID
@@ -18,9 +22,24 @@ public:
     Ship(int _id, int _size) : id(_id), size(_size), orientation(Orientation::Horizontal), hits(0) {
         topLeft = QPoint(-1, -1); // Не размещен
     }
+    Ship() : Ship(-1, 0) {} // Для массивов кораблей
 
     bool isPlaced() const { return topLeft.x() >= 0; }
     bool isDestroyed() const { return hits >= size; }
 };
 
+// Корабли обеих сторон партии одним массивом: флот игрока — первые FLEET_SHIP_COUNT, соперника — следующие.
+// Лежит прямо в окне партии: ни new на каждый корабль, ни удаления вручную. Поля (BoardWidget) им не владеют.
+struct MatchFleets {
+    Ship ships[2 * FLEET_SHIP_COUNT];
+
+    MatchFleets() { reset(); }
+    // Все корабли целы и сняты с поля; id сквозные (0..9 у игрока, 10..19 у соперника)
+    void reset() {
+        for (int i = 0; i < 2 * FLEET_SHIP_COUNT; ++i) ships[i] = Ship(i, FLEET_SIZES[i % FLEET_SHIP_COUNT]);
+    }
+    Ship *player() { return ships; }
+    Ship *enemy() { return ships + FLEET_SHIP_COUNT; }
+};
+
 #endif // SHIP_H
@@ -0,0 +1,55 @@
+#include "animationclock.h"
+#include <QCoreApplication>
+
+AnimationClock *AnimationClock::instance() {
+    static AnimationClock *clock = new AnimationClock(QCoreApplication::instance());
+    return clock;
+}
+
+AnimationClock::AnimationClock(QObject *parent) : QObject(parent) {
+    frameTimer.setInterval(FRAME_MS);
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&frameTimer, &QTimer::timeout, this, &AnimationClock::onFrame);
+    clock.start();
+}
+
+void AnimationClock::start(QObject *owner, int intervalMs, Tick tick) {
+    if (!subscribers.contains(owner)) {
+        connect(owner, &QObject::destroyed, this, [this, owner]() { subscribers.remove(owner); });
+    }
+    subscribers.insert(owner, Subscriber{std::move(tick), intervalMs, nextDue(clock.elapsed(), intervalMs), ++nextGeneration});
+    if (!frameTimer.isActive()) frameTimer.start();
+}
+
+void AnimationClock::repeat(QObject *owner, int intervalMs, std::function<void()> step) {
+    start(owner, intervalMs, [step]() { step(); return true; });
+}
+
+void AnimationClock::stop(QObject *owner) {
+    if (subscribers.remove(owner)) disconnect(owner, &QObject::destroyed, this, nullptr);
+    if (subscribers.isEmpty()) frameTimer.stop();
+}
+
+// Полкадра допуска: интервал 30 мс тикает через кадр, а не через два
+qint64 AnimationClock::nextDue(qint64 now, qint64 intervalMs) const {
+    return now + intervalMs - FRAME_MS / 2;
+}
+
+void AnimationClock::onFrame() {
+    qint64 now = clock.elapsed();
+    // Тик может запускать и снимать подписки (в том числе свою) — идем по снимку владельцев
+    const QList<QObject*> owners = subscribers.keys();
+    for (QObject *owner : owners) {
+        auto it = subscribers.find(owner);
+        if (it == subscribers.end() || it->dueMs > now) continue;
+        it->dueMs = nextDue(now, it->intervalMs);
+        quint64 generation = it->generation;
+        Tick tick = it->tick;
+        if (!tick()) {
+            // Тик мог перезапустить подписку — снимаем только ту, что тикала
+            auto again = subscribers.find(owner);
+            if (again != subscribers.end() && again->generation == generation) stop(owner);
+        }
+    }
+    if (subscribers.isEmpty()) frameTimer.stop();
+}
@@ -0,0 +1,55 @@
+#ifndef ANIMATIONCLOCK_H
+#define ANIMATIONCLOCK_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <functional>
+
+// Общие часы анимаций вместо собственных QTimer у каждого виджета.
+// Один таймер кадра на все приложение: все подписчики тикают в одном проходе,
+// их update() Qt сливает в одну перерисовку. Без подписчиков таймер стоит.
+class AnimationClock : public QObject
+{
+    Q_OBJECT
+public:
+    static const int FRAME_MS = 16;
+    // Шаг тряски виджетов (интервал их прежних таймеров)
+    static const int SHAKE_MS = 30;
+
+    // Тик подписчика; false — подписка снимается
+    using Tick = std::function<bool()>;
+
+    static AnimationClock *instance();
+
+    // Тикать tick не чаще раза в intervalMs (округляется до кадров). У владельца одна подписка:
+    // повторный start ее заменяет и сбрасывает отсчет. При удалении владельца подписка снимается сама.
+    void start(QObject *owner, int intervalMs, Tick tick);
+    // То же, но тикает до явного stop
+    void repeat(QObject *owner, int intervalMs, std::function<void()> step);
+    void stop(QObject *owner);
+    bool isRunning(QObject *owner) const { return subscribers.contains(owner); }
+
+private slots:
+    void onFrame();
+
+private:
+    explicit AnimationClock(QObject *parent = nullptr);
+
+    struct Subscriber {
+        Tick tick;
+        qint64 intervalMs;
+        qint64 dueMs;
+        quint64 generation; // Номер запуска: отличает перезапуск из самого тика
+    };
+
+    QTimer frameTimer;
+    QElapsedTimer clock;
+    QHash<QObject*, Subscriber> subscribers;
+    quint64 nextGeneration = 0;
+
+    qint64 nextDue(qint64 now, qint64 intervalMs) const;
+};
+
+#endif // ANIMATIONCLOCK_H
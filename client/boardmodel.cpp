@@ -0,0 +1,184 @@
+#include "boardmodel.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// Таблица ореолов клеток: считается один раз при первом обращении
+struct HaloTable {
+    Bitboard cells[BoardModel::CELLS];
+    HaloTable() {
+        for (int y = 0; y < BoardModel::SIZE; ++y) {
+            for (int x = 0; x < BoardModel::SIZE; ++x) {
+                Bitboard b;
+                for (int j = y - 1; j <= y + 1; ++j)
+                    for (int i = x - 1; i <= x + 1; ++i)
+                        if (BoardModel::inBounds(i, j)) b.set(BoardModel::index(i, j));
+                cells[BoardModel::index(x, y)] = b;
+            }
+        }
+    }
+};
+
+const HaloTable &haloTable() {
+    static const HaloTable table;
+    return table;
+}
+
+}
+
+BoardModel::BoardModel() {
+    std::fill(std::begin(cellShip), std::end(cellShip), std::int8_t(-1));
+}
+
+Bitboard BoardModel::shipMask(int x, int y, int size, Orientation orient) {
+    Bitboard b;
+    if (!inBounds(x, y) || size <= 0) return b;
+    if (orient == Orientation::Horizontal && x + size > SIZE) return b;
+    if (orient == Orientation::Vertical && y + size > SIZE) return b;
+    int step = (orient == Orientation::Horizontal) ? 1 : SIZE;
+    int idx = index(x, y);
+    for (int i = 0; i < size; ++i) b.set(idx + i * step);
+    return b;
+}
+
+const Bitboard &BoardModel::cellHalo(int idx) {
+    return haloTable().cells[idx];
+}
+
+Bitboard BoardModel::halo(const Bitboard &mask) {
+    Bitboard out;
+    Bitboard rest = mask;
+    for (int idx = rest.popFirst(); idx >= 0; idx = rest.popFirst()) out |= cellHalo(idx);
+    return out;
+}
+
+Bitboard BoardModel::component(const Bitboard &cells, int idx) {
+    Bitboard group = Bitboard::cell(idx);
+    Bitboard frontier = group;
+    while (frontier.any()) {
+        int c = frontier.popFirst();
+        int cx = c % SIZE, cy = c / SIZE;
+        const int dx[] = {-1, 1, 0, 0};
+        const int dy[] = {0, 0, -1, 1};
+        for (int i = 0; i < 4; ++i) {
+            int nx = cx + dx[i], ny = cy + dy[i];
+            if (!inBounds(nx, ny)) continue;
+            int n = index(nx, ny);
+            if (cells.test(n) && !group.test(n)) { group.set(n); frontier.set(n); }
+        }
+    }
+    return group;
+}
+
+void BoardModel::setFleet(const int *sizes, int count) {
+    if (count > MAX_SHIPS) count = MAX_SHIPS;
+    shipsTotal = count;
+    for (int i = 0; i < MAX_SHIPS; ++i) ships[i] = ShipSlot();
+    for (int i = 0; i < count; ++i) ships[i].size = sizes[i];
+    clear();
+}
+
+void BoardModel::clear() {
+    for (int i = 0; i < shipsTotal; ++i) {
+        ships[i].mask = Bitboard();
+        ships[i].halo = Bitboard();
+    }
+    shipCells = Bitboard();
+    std::fill(std::begin(cellShip), std::end(cellShip), std::int8_t(-1));
+    clearShots();
+}
+
+void BoardModel::clearShots() {
+    hitMask = Bitboard();
+    missMask = Bitboard();
+}
+
+bool BoardModel::canPlace(int x, int y, int size, Orientation orient, int ignoreSlot) const {
+    Bitboard m = shipMask(x, y, size, orient);
+    if (m.none()) return false;
+    for (int i = 0; i < shipsTotal; ++i) {
+        if (i == ignoreSlot) continue;
+        if (ships[i].halo.intersects(m)) return false;
+    }
+    return true;
+}
+
+bool BoardModel::placeShip(int slot, int x, int y, Orientation orient) {
+    if (slot < 0 || slot >= shipsTotal) return false;
+    if (!canPlace(x, y, ships[slot].size, orient, slot)) return false;
+    removeShip(slot);
+    ships[slot].mask = shipMask(x, y, ships[slot].size, orient);
+    ships[slot].halo = halo(ships[slot].mask);
+    shipCells |= ships[slot].mask;
+    Bitboard cells = ships[slot].mask;
+    for (int idx = cells.popFirst(); idx >= 0; idx = cells.popFirst()) cellShip[idx] = std::int8_t(slot);
+    return true;
+}
+
+void BoardModel::removeShip(int slot) {
+    if (slot < 0 || slot >= shipsTotal) return;
+    shipCells &= ~ships[slot].mask;
+    Bitboard cells = ships[slot].mask;
+    for (int idx = cells.popFirst(); idx >= 0; idx = cells.popFirst()) cellShip[idx] = -1;
+    ships[slot].mask = Bitboard();
+    ships[slot].halo = Bitboard();
+}
+
+bool BoardModel::isDestroyed(int slot) const {
+    return shipHits(slot) >= ships[slot].size;
+}
+
+CellState BoardModel::cellState(int x, int y) const {
+    int idx = index(x, y);
+    if (hitMask.test(idx)) return Hit;
+    if (missMask.test(idx)) return Miss;
+    if (shipCells.test(idx)) return ShipCell;
+    return Empty;
+}
+
+// Принудительная установка (ответ сервера). Empty/ShipCell снимают отметку выстрела.
+void BoardModel::setCellState(int x, int y, CellState state) {
+    if (!inBounds(x, y)) return;
+    int idx = index(x, y);
+    hitMask.reset(idx);
+    missMask.reset(idx);
+    if (state == Hit) hitMask.set(idx);
+    else if (state == Miss) missMask.set(idx);
+}
+
+bool BoardModel::canShootAt(int x, int y) const {
+    if (!inBounds(x, y)) return false;
+    return !shots().test(index(x, y));
+}
+
+int BoardModel::receiveShot(int x, int y, int *hitSlot) {
+    if (hitSlot) *hitSlot = -1;
+    if (!canShootAt(x, y)) return ShotAlready;
+
+    int idx = index(x, y);
+    int slot = shipAt(x, y);
+    if (slot < 0) {
+        missMask.set(idx);
+        return ShotMiss;
+    }
+
+    hitMask.set(idx);
+    if (hitSlot) *hitSlot = slot;
+    if (isDestroyed(slot)) {
+        markAroundDestroyed(slot);
+        return ShotKill;
+    }
+    return ShotHit;
+}
+
+void BoardModel::markAroundDestroyed(int slot) {
+    missMask |= ships[slot].halo & ~(shipCells | hitMask);
+}
+
+bool BoardModel::isAllDestroyed() const {
+    for (int i = 0; i < shipsTotal; ++i) {
+        if (!isDestroyed(i)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,153 @@
+#ifndef BOARDMODEL_H
+#define BOARDMODEL_H
+
+#include <cstdint>
+#include "Ship.h"
+
+// Состояние клетки (как его видит интерфейс)
+enum CellState { Empty, ShipCell, Miss, Hit };
+
+// 128-битная маска поля 10x10: бит (y * 10 + x), младшие 64 бита в lo, остальные 36 в hi
+struct Bitboard {
+    std::uint64_t lo = 0;
+    std::uint64_t hi = 0;
+
+    static Bitboard cell(int idx) {
+        Bitboard b;
+        if (idx < 64) b.lo = std::uint64_t(1) << idx;
+        else b.hi = std::uint64_t(1) << (idx - 64);
+        return b;
+    }
+    static Bitboard full() {
+        Bitboard b;
+        b.lo = ~std::uint64_t(0);
+        b.hi = (std::uint64_t(1) << 36) - 1;
+        return b;
+    }
+
+    bool test(int idx) const { return idx < 64 ? (lo >> idx) & 1 : (hi >> (idx - 64)) & 1; }
+    void set(int idx) { *this |= cell(idx); }
+    void reset(int idx) { *this &= ~cell(idx); }
+
+    bool any() const { return (lo | hi) != 0; }
+    bool none() const { return !any(); }
+    int count() const { return popcount(lo) + popcount(hi); }
+    bool intersects(const Bitboard &o) const { return ((lo & o.lo) | (hi & o.hi)) != 0; }
+
+    // Индекс младшего установленного бита (-1, если пусто)
+    int first() const {
+        if (lo) return ctz(lo);
+        if (hi) return 64 + ctz(hi);
+        return -1;
+    }
+    int popFirst() { int i = first(); if (i >= 0) reset(i); return i; }
+
+    Bitboard operator|(const Bitboard &o) const { Bitboard b; b.lo = lo | o.lo; b.hi = hi | o.hi; return b; }
+    Bitboard operator&(const Bitboard &o) const { Bitboard b; b.lo = lo & o.lo; b.hi = hi & o.hi; return b; }
+    Bitboard operator^(const Bitboard &o) const { Bitboard b; b.lo = lo ^ o.lo; b.hi = hi ^ o.hi; return b; }
+    // Дополнение только в пределах 100 клеток поля
+    Bitboard operator~() const { Bitboard b; b.lo = ~lo; b.hi = ~hi & full().hi; return b; }
+    Bitboard &operator|=(const Bitboard &o) { lo |= o.lo; hi |= o.hi; return *this; }
+    Bitboard &operator&=(const Bitboard &o) { lo &= o.lo; hi &= o.hi; return *this; }
+    bool operator==(const Bitboard &o) const { return lo == o.lo && hi == o.hi; }
+    bool operator!=(const Bitboard &o) const { return !(*this == o); }
+
+private:
+    static int popcount(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(v);
+#else
+        int n = 0; while (v) { v &= v - 1; ++n; } return n;
+#endif
+    }
+    static int ctz(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(v);
+#else
+        int n = 0; while (!(v & 1)) { v >>= 1; ++n; } return n;
+#endif
+    }
+};
+
+// Правила игры без виджетов: расстановка, выстрелы, проверка победы.
+// Корабли адресуются слотом (0..MAX_SHIPS-1), а не Ship::id — у флотов игрока и бота id сквозные.
+class BoardModel
+{
+public:
+    static const int SIZE = 10;
+    static const int CELLS = SIZE * SIZE;
+    static const int MAX_SHIPS = 10;
+
+    // Результат выстрела — те же коды, что возвращал BoardWidget::receiveShot
+    enum ShotResult { ShotAlready = -1, ShotMiss = 0, ShotHit = 1, ShotKill = 2 };
+
+    BoardModel();
+
+    static int index(int x, int y) { return y * SIZE + x; }
+    static bool inBounds(int x, int y) { return x >= 0 && x < SIZE && y >= 0 && y < SIZE; }
+
+    // Маска корабля (пустая, если не помещается на поле)
+    static Bitboard shipMask(int x, int y, int size, Orientation orient);
+    // Клетка и 8 соседей (предрасчитанная таблица)
+    static const Bitboard &cellHalo(int idx);
+    // Маска вместе с ореолом вокруг
+    static Bitboard halo(const Bitboard &mask);
+    // Связная (по сторонам) группа клеток из cells, содержащая idx
+    static Bitboard component(const Bitboard &cells, int idx);
+
+    // Флот: размеры кораблей по слотам. Сбрасывает расстановку и выстрелы.
+    void setFleet(const int *sizes, int count);
+    int shipCount() const { return shipsTotal; }
+    int shipSize(int slot) const { return ships[slot].size; }
+
+    void clear();       // Убрать выстрелы и корабли с поля (флот остается)
+    void clearShots();  // Только выстрелы
+
+    bool canPlace(int x, int y, int size, Orientation orient, int ignoreSlot = -1) const;
+    bool placeShip(int slot, int x, int y, Orientation orient);
+    void removeShip(int slot);
+    bool isPlaced(int slot) const { return ships[slot].mask.any(); }
+    bool isDestroyed(int slot) const;
+    int shipHits(int slot) const { return (ships[slot].mask & hitMask).count(); }
+
+    // Слот корабля в клетке или -1 (одно чтение из таблицы занятости)
+    int shipAt(int x, int y) const { return inBounds(x, y) ? cellShip[index(x, y)] : -1; }
+    bool hasShipAt(int x, int y) const { return inBounds(x, y) && shipCells.test(index(x, y)); }
+
+    CellState cellState(int x, int y) const;
+    void setCellState(int x, int y, CellState state);
+    // Все выстрелы разом (просмотр записи партии)
+    void setShots(const Bitboard &hits, const Bitboard &misses) { hitMask = hits; missMask = misses; }
+
+    bool canShootAt(int x, int y) const;
+    // Возвращает ShotResult; при ShotKill клетки вокруг корабля помечаются промахами
+    int receiveShot(int x, int y, int *hitSlot = nullptr);
+
+    bool isAllDestroyed() const;
+
+    const Bitboard &shipsMask() const { return shipCells; }
+    const Bitboard &hits() const { return hitMask; }
+    const Bitboard &misses() const { return missMask; }
+    Bitboard shots() const { return hitMask | missMask; }
+    Bitboard shipMaskOf(int slot) const { return ships[slot].mask; }
+
+private:
+    struct ShipSlot {
+        int size = 0;
+        Bitboard mask;
+        Bitboard halo;
+    };
+
+    ShipSlot ships[MAX_SHIPS];
+    int shipsTotal = 0;
+
+    Bitboard shipCells;
+    // Клетка -> слот корабля (-1 — пусто); ведется вместе с shipCells в placeShip/removeShip
+    std::int8_t cellShip[CELLS];
+    Bitboard hitMask;
+    Bitboard missMask;
+
+    void markAroundDestroyed(int slot);
+};
+
+#endif // BOARDMODEL_H
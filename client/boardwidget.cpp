@@ -5,7 +5,7 @@
 #include <QMimeData>
 #include <QRandomGenerator>
 #include <algorithm>
-#include <QTimer>
+#include "animationclock.h"
 
 BoardWidget::BoardWidget(QWidget *parent)
     : QWidget(parent), isEditable(false), showShips(true)
@@ -13,9 +13,6 @@ BoardWidget::BoardWidget(QWidget *parent)
     setAcceptDrops(true);
     setMouseTracking(true);
     clearBoard();
-
-    animTimer = new QTimer(this);
-    connect(animTimer, &QTimer::timeout, this, &BoardWidget::updateAnimation);
 }
 
 QSize BoardWidget::sizeHint() const { return QSize(330, 330); }
@@ -23,29 +20,33 @@ int BoardWidget::heightForWidth(int w) const { return w; }
 void BoardWidget::setupSizePolicy() { setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding); }
 
 void BoardWidget::clearBoard() {
-    for(int i=0; i<10; ++i)
-        for(int j=0; j<10; ++j)
-            grid[i][j] = Empty;
-    update();
+    boardModel.clear();
+    invalidateLayer();
 }
 
 // --- ВАЖНЫЙ МЕТОД ДЛЯ МУЛЬТИПЛЕЕРА ---
 void BoardWidget::setCellState(int x, int y, CellState state) {
     if (x >= 0 && x < 10 && y >= 0 && y < 10) {
-        grid[x][y] = state;
-        update();
+        boardModel.setCellState(x, y, state);
+        invalidateLayer(cellRect(x, y));
     }
 }
 // -------------------------------------
 
+void BoardWidget::setShots(const Bitboard &hits, const Bitboard &misses) {
+    boardModel.setShots(hits, misses);
+    invalidateLayer();
+}
+
 void BoardWidget::setFog(bool active) {
     isFoggy = active;
     update();
 }
 
 void BoardWidget::setHighlight(QPoint pos) {
+    update(cellRect(highlightPos.x(), highlightPos.y()));
     highlightPos = pos;
-    update();
+    update(cellRect(highlightPos.x(), highlightPos.y()));
 }
 
 QPoint BoardWidget::getGridCoord(QPoint pos) {
@@ -67,13 +68,15 @@ QPoint BoardWidget::getGridCoord(QPoint pos) {
     return QPoint(x, y);
 }
 
-void BoardWidget::leaveEvent(QEvent *) { hoverX = -1; hoverY = -1; update(); }
+void BoardWidget::leaveEvent(QEvent *) { update(cellRect(hoverX, hoverY)); hoverX = -1; hoverY = -1; }
 
 void BoardWidget::mouseMoveEvent(QMouseEvent *event) {
     if (isEditable || isActive) {
         QPoint p = getGridCoord(event->pos());
         if (p.x() != hoverX || p.y() != hoverY) {
-            hoverX = p.x(); hoverY = p.y(); update();
+            update(cellRect(hoverX, hoverY));
+            hoverX = p.x(); hoverY = p.y();
+            update(cellRect(hoverX, hoverY));
         }
     }
     QWidget::mouseMoveEvent(event);
@@ -83,47 +86,38 @@ void BoardWidget::setEditable(bool editable) {
     isEditable = editable; setAcceptDrops(editable);
     setCursor(isEditable ? Qt::OpenHandCursor : Qt::ArrowCursor);
 }
-void BoardWidget::setShips(const QVector<Ship *> &ships) { myShips = ships; }
-void BoardWidget::setShowShips(bool show) { showShips = show; update(); }
+void BoardWidget::setShips(Ship *ships, int count) {
+    myShips = ships;
+    myShipCount = std::min(count, int(BoardModel::MAX_SHIPS));
+    int sizes[BoardModel::MAX_SHIPS];
+    for (int i = 0; i < myShipCount; ++i) sizes[i] = myShips[i].size;
+    boardModel.setFleet(sizes, myShipCount);
+    for (int i = 0; i < myShipCount; ++i) placeShipCells(&myShips[i]);
+    invalidateLayer();
+}
+
+int BoardWidget::slotOf(const Ship *ship) const {
+    // Корабли лежат подряд — слот считается по адресу, без поиска
+    return (ship && ship >= myShips && ship < myShips + myShipCount) ? int(ship - myShips) : -1;
+}
+void BoardWidget::setShowShips(bool show) { showShips = show; invalidateLayer(); }
 
 bool BoardWidget::canPlace(int x, int y, int size, Orientation orient, Ship* ignoreShip) {
-    int dx = (orient == Orientation::Horizontal) ? 1 : 0;
-    int dy = (orient == Orientation::Vertical) ? 1 : 0;
-    if (x < 0 || y < 0 || x >= 10 || y >= 10) return false;
-    if (orient == Orientation::Horizontal && (x + size) > 10) return false;
-    if (orient == Orientation::Vertical && (y + size) > 10) return false;
-    for (int i = 0; i < size; ++i) {
-        int currentX = x + i * dx; int currentY = y + i * dy;
-        for (int checkX = currentX - 1; checkX <= currentX + 1; ++checkX) {
-            for (int checkY = currentY - 1; checkY <= currentY + 1; ++checkY) {
-                if (checkX < 0 || checkX >= 10 || checkY < 0 || checkY >= 10) continue;
-                Ship* neighbor = getShipAt(checkX, checkY);
-                if (neighbor && neighbor != ignoreShip) return false;
-            }
-        }
-    }
-    return true;
+    return boardModel.canPlace(x, y, size, orient, slotOf(ignoreShip));
 }
 
 bool BoardWidget::placeShip(Ship* ship, int x, int y, Orientation orient) {
     if (canPlace(x, y, ship->size, orient, ship)) {
         if (ship->isPlaced()) removeShipCells(ship);
         ship->topLeft = QPoint(x, y); ship->orientation = orient;
-        placeShipCells(ship); update(); return true;
+        placeShipCells(ship); invalidateLayer(); return true;
     }
     return false;
 }
 
 Ship* BoardWidget::getShipAt(int x, int y) {
-    for (Ship* s : myShips) {
-        if (!s->isPlaced()) continue;
-        if (s->orientation == Orientation::Horizontal) {
-            if (y == s->topLeft.y() && x >= s->topLeft.x() && x < s->topLeft.x() + s->size) return s;
-        } else {
-            if (x == s->topLeft.x() && y >= s->topLeft.y() && y < s->topLeft.y() + s->size) return s;
-        }
-    }
-    return nullptr;
+    int slot = boardModel.shipAt(x, y);
+    return (slot >= 0) ? &myShips[slot] : nullptr;
 }
 
 void BoardWidget::drawShipShape(QPainter &p, int size, Orientation orient, QRect rect, bool isEnemy, bool isDestroyed)
@@ -184,82 +178,127 @@ void BoardWidget::drawShipShape(QPainter &p, int size, Orientation orient, QRect
     p.restore();
 }
 
-bool BoardWidget::hasShipAt(int x, int y) { return getShipAt(x, y) != nullptr; }
-
-bool BoardWidget::canShootAt(int x, int y) {
-    if (x < 0 || x >= 10 || y < 0 || y >= 10) return false;
-    return (grid[x][y] == Empty || grid[x][y] == ShipCell);
+QPixmap BoardWidget::shipSprite(int size, Orientation orient, bool isEnemy, bool isDestroyed, int cellSize, qreal dpr)
+{
+    quint64 key = quint64(size & 0xF)
+                  | quint64(orient == Orientation::Vertical) << 4
+                  | quint64(isEnemy) << 5
+                  | quint64(isDestroyed) << 6
+                  | quint64(cellSize & 0xFFFF) << 8
+                  | quint64(qRound(dpr * 100) & 0xFFFF) << 24;
+    auto it = shipSprites.constFind(key);
+    if (it != shipSprites.constEnd()) return it.value();
+
+    QPixmap sprite = renderShipSprite(size, orient, isEnemy, isDestroyed, cellSize, dpr);
+    shipSprites.insert(key, sprite);
+    return sprite;
 }
 
-void BoardWidget::animateShot(int x, int y) {
-    if (x < 0 || x > 9 || y < 0 || y > 9) return;
-    if (currentAnim.state == AnimState::Falling) return;
-
-    int side = std::min(width() - MARGIN, height() - MARGIN);
-    int cellSize = side / 10;
+QPixmap BoardWidget::renderShipSprite(int size, Orientation orient, bool isEnemy, bool isDestroyed, int cellSize, qreal dpr)
+{
+    int w = (orient == Orientation::Horizontal) ? size * cellSize : cellSize;
+    int h = (orient == Orientation::Vertical) ? size * cellSize : cellSize;
+    QPixmap sprite(QSize(w, h) * dpr);
+    sprite.setDevicePixelRatio(dpr);
+    sprite.fill(Qt::transparent);
+    QPainter p(&sprite);
+    drawShipShape(p, size, orient, QRect(0, 0, w, h), isEnemy, isDestroyed);
+    p.end();
+    return sprite;
+}
 
-    currentAnim.state = AnimState::Falling;
-    currentAnim.gridPos = QPoint(x, y);
+bool BoardWidget::hasShipAt(int x, int y) { return boardModel.hasShipAt(x, y); }
 
-    float startX = x * cellSize + cellSize / 2.0;
-    float startY = -40;
+bool BoardWidget::canShootAt(int x, int y) { return boardModel.canShootAt(x, y); }
 
-    currentAnim.targetY = y * cellSize + cellSize / 2.0;
-    currentAnim.currentPos = QPointF(startX, startY);
-    currentAnim.speedY = 15.0;
-    currentAnim.frame = 0;
+void BoardWidget::animateShot(int x, int y, int delayFrames) {
+    if (x < 0 || x > 9 || y < 0 || y > 9) return;
 
     // В мультиплеере мы не знаем, попали или нет, пока не получим ответ.
     // Пока считаем false, реальный эффект (взрыв) будет по приходу пакета fire_result
     // Или, если это локальный бот, проверяем hasShipAt
-    if (!isEnemyBoard) {
-        currentAnim.isHit = hasShipAt(x, y); // В нас стреляют - мы знаем
-    } else {
-        currentAnim.isHit = false; // В врага стреляем - узнаем позже
+    bool isHit = !isEnemyBoard && hasShipAt(x, y);
+
+    MissileAnim *slot = nullptr;
+    for (MissileAnim &m : missiles) {
+        if (m.state == AnimState::Idle) { slot = &m; break; }
     }
+    if (!slot) {
+        // Пул занят: выстрел все равно должен засчитаться, просто без анимации
+        QMetaObject::invokeMethod(this, [this, x, y, isHit]() { emit missileImpact(x, y, isHit); }, Qt::QueuedConnection);
+        return;
+    }
+
+    int cellSize = this->cellSize();
+    slot->state = AnimState::Falling;
+    slot->gridPos = QPoint(x, y);
+    slot->targetY = y * cellSize + cellSize / 2.0;
+    slot->currentPos = QPointF(x * cellSize + cellSize / 2.0, -40);
+    slot->speedY = 15.0;
+    slot->frame = 0;
+    slot->isHit = isHit;
+    slot->delay = delayFrames;
+    slot->drawnRect = missileRect(*slot);
+    update(slot->drawnRect);
+
+    AnimationClock *clock = AnimationClock::instance();
+    if (!clock->isRunning(this)) clock->start(this, AnimationClock::FRAME_MS, [this]() { return updateAnimation(); });
+}
 
-    animTimer->start(16);
+void BoardWidget::animateSalvo(const QVector<QPoint> &cells) {
+    // Старты сдвинуты на пару кадров: ракеты идут волной, весь залп укладывается примерно в полсекунды
+    const int STAGGER_FRAMES = 2;
+    for (int i = 0; i < cells.size(); ++i) animateShot(cells[i].x(), cells[i].y(), i * STAGGER_FRAMES);
 }
 
-void BoardWidget::updateAnimation() {
-    if (currentAnim.state == AnimState::Falling) {
-        currentAnim.currentPos.ry() += currentAnim.speedY;
-        currentAnim.speedY += 1.5;
-        if (currentAnim.currentPos.y() >= currentAnim.targetY) {
-            currentAnim.currentPos.ry() = currentAnim.targetY;
-            currentAnim.state = AnimState::Exploding;
-            currentAnim.frame = 0;
-            emit missileImpact(currentAnim.gridPos.x(), currentAnim.gridPos.y(), currentAnim.isHit);
+bool BoardWidget::updateAnimation() {
+    bool anyActive = false;
+    for (MissileAnim &m : missiles) {
+        if (m.state == AnimState::Idle) continue;
+        if (m.delay > 0) {
+            m.delay--;
         }
-    }
-    else if (currentAnim.state == AnimState::Exploding) {
-        currentAnim.frame++;
-        if (currentAnim.frame > 20) {
-            currentAnim.state = AnimState::Idle;
-            animTimer->stop();
+        else if (m.state == AnimState::Falling) {
+            m.currentPos.ry() += m.speedY;
+            m.speedY += 1.5;
+            if (m.currentPos.y() >= m.targetY) {
+                m.currentPos.ry() = m.targetY;
+                m.state = AnimState::Exploding;
+                m.frame = 0;
+                emit missileImpact(m.gridPos.x(), m.gridPos.y(), m.isHit);
+            }
         }
+        else if (m.state == AnimState::Exploding) {
+            m.frame++;
+            if (m.frame > 20) m.state = AnimState::Idle;
+        }
+        // Перерисовываем только старое и новое положение ракеты/взрыва
+        QRect next = missileRect(m);
+        update(m.drawnRect.united(next));
+        m.drawnRect = next;
+        if (m.state != AnimState::Idle) anyActive = true;
     }
-    update();
+    return anyActive;
 }
 
-void BoardWidget::drawMissile(QPainter &p) {
+void BoardWidget::drawMissile(QPainter &p, const MissileAnim &m) {
     p.save();
-    QPointF pos = currentAnim.currentPos;
+    QPointF pos = m.currentPos;
     int w = 12; int h = 24; QRectF r(pos.x() - w/2, pos.y() - h/2, w, h);
-    if (currentAnim.speedY > 20) {
+    if (m.speedY > 20) {
         p.setPen(Qt::NoPen); QColor smoke(200, 200, 200, 150);
         for(int i=1; i<=3; ++i) { p.setBrush(smoke); p.drawRect(pos.x() - w/2 + 2, pos.y() - h - i*10, w-4, 8); }
     }
-    p.setPen(QPen(Qt::black, 2)); p.setBrush(currentAnim.isHit ? QColor(255, 50, 50) : QColor(200, 200, 200));
+    p.setPen(QPen(Qt::black, 2)); p.setBrush(m.isHit ? QColor(255, 50, 50) : QColor(200, 200, 200));
     p.drawRect(r); p.setBrush(Qt::black); p.drawRect(pos.x() - w/2 + 2, pos.y() + h/2, w - 4, 4);
     p.restore();
 }
 
-void BoardWidget::drawExplosion(QPainter &p) {
+void BoardWidget::drawExplosion(QPainter &p, const MissileAnim &m) {
     p.save();
-    QPointF pos = currentAnim.currentPos; int f = currentAnim.frame;
-    QColor color1 = currentAnim.isHit ? QColor(255, 200, 0) : QColor(100, 200, 255);
-    QColor color2 = currentAnim.isHit ? QColor(255, 50, 0) : QColor(50, 100, 200);
+    QPointF pos = m.currentPos; int f = m.frame;
+    QColor color1 = m.isHit ? QColor(255, 200, 0) : QColor(100, 200, 255);
+    QColor color2 = m.isHit ? QColor(255, 50, 0) : QColor(50, 100, 200);
     int radius = 5 + f * 2;
     p.setPen(Qt::NoPen);
     p.setBrush(color2);
@@ -268,20 +307,69 @@ void BoardWidget::drawExplosion(QPainter &p) {
     p.setBrush(color1);
     p.drawRect(pos.x() - innerR, pos.y() - innerR, innerR*2, innerR*2);
     if (f < 15) {
-        p.setBrush(currentAnim.isHit ? Qt::black : Qt::white); int partDist = radius + 5;
+        p.setBrush(m.isHit ? Qt::black : Qt::white); int partDist = radius + 5;
         p.drawRect(pos.x() - partDist, pos.y() - partDist, 4, 4); p.drawRect(pos.x() + partDist, pos.y() - partDist, 4, 4);
         p.drawRect(pos.x() - partDist, pos.y() + partDist, 4, 4); p.drawRect(pos.x() + partDist, pos.y() + partDist, 4, 4);
     }
     p.restore();
 }
 
-void BoardWidget::paintEvent(QPaintEvent *) {
-    QPainter p(this);
+int BoardWidget::cellSize() const {
+    int side = std::min(width() - MARGIN, height() - MARGIN);
+    return (side > 0) ? side / 10 : 0;
+}
+
+QRect BoardWidget::cellRect(int x, int y) const {
+    if (x < 0 || y < 0) return QRect();
+    int cs = cellSize();
+    return QRect(MARGIN + x * cs, y * cs, cs, cs).adjusted(-2, -2, 2, 2);
+}
+
+QRect BoardWidget::cellsRect(const Bitboard &cells) const {
+    QRect r;
+    Bitboard rest = cells;
+    for (int idx = rest.popFirst(); idx >= 0; idx = rest.popFirst()) r |= cellRect(idx % 10, idx / 10);
+    return r;
+}
+
+QRect BoardWidget::missileRect(const MissileAnim &m) const {
+    if (m.delay > 0) return QRect();
+    QPoint pos = m.currentPos.toPoint() + QPoint(MARGIN, 0);
+    if (m.state == AnimState::Falling) {
+        // Корпус 12x24, стабилизатор снизу и дымный след до трех блоков над ракетой
+        return QRect(pos.x() - 10, pos.y() - 60, 20, 80);
+    }
+    if (m.state == AnimState::Exploding) {
+        int half = 5 + m.frame * 2 + 10;
+        return QRect(pos.x() - half, pos.y() - half, half * 2, half * 2);
+    }
+    return QRect();
+}
+
+void BoardWidget::invalidateLayer(const QRect &area) {
+    staticDirty = true;
+    if (area.isNull()) update();
+    else update(area);
+}
+
+void BoardWidget::resizeEvent(QResizeEvent *event) {
+    staticDirty = true;
+    shipSprites.clear(); // Старый размер клетки больше не нужен, новые спрайты нарисуются при сборке слоя
+    QWidget::resizeEvent(event);
+}
+
+void BoardWidget::rebuildStaticLayer() {
+    qreal dpr = devicePixelRatioF();
+    staticLayer = QPixmap(size() * dpr);
+    staticLayer.setDevicePixelRatio(dpr);
+    staticLayer.fill(Qt::transparent);
+    staticDirty = false;
+
+    QPainter p(&staticLayer);
     p.setRenderHint(QPainter::Antialiasing, false);
     p.fillRect(rect(), QColor(255, 255, 255, 200));
-    int side = std::min(width() - MARGIN, height() - MARGIN);
-    if (side <= 0) return;
-    int cellSize = side / 10;
+    int cellSize = this->cellSize();
+    if (cellSize <= 0) return;
     int boardSize = cellSize * 10;
     p.translate(MARGIN, 0);
 
@@ -305,31 +393,47 @@ void BoardWidget::paintEvent(QPaintEvent *) {
         p.drawLine(0, i * cellSize, boardSize, i * cellSize);
     }
 
-    for (Ship* s : myShips) {
+    for (int i = 0; i < myShipCount; ++i) {
+        const Ship *s = &myShips[i];
         if (!s->isPlaced()) continue;
         // Показываем корабли только если это наши, или они убиты, или включен режим отладки/конца игры
         if (showShips || s->isDestroyed()) {
-            int w = (s->orientation == Orientation::Horizontal) ? s->size * cellSize : cellSize;
-            int h = (s->orientation == Orientation::Vertical) ? s->size * cellSize : cellSize;
-            QRect shipRect(s->topLeft.x() * cellSize, s->topLeft.y() * cellSize, w, h);
-            drawShipShape(p, s->size, s->orientation, shipRect, isEnemyBoard, s->isDestroyed());
+            p.drawPixmap(s->topLeft.x() * cellSize, s->topLeft.y() * cellSize,
+                         shipSprite(s->size, s->orientation, isEnemyBoard, s->isDestroyed(), cellSize, devicePixelRatioF()));
         }
     }
 
-    for(int x=0; x<10; ++x) {
-        for(int y=0; y<10; ++y) {
-            int cx = x * cellSize; int cy = y * cellSize;
-            if (grid[x][y] == Miss) {
-                p.setBrush(Qt::black); p.setPen(Qt::NoPen);
-                p.drawRect(cx + cellSize/2 - 2, cy + cellSize/2 - 2, 4, 4);
-            } else if (grid[x][y] == Hit) {
-                p.setPen(QPen(Qt::red, 3));
-                p.drawLine(cx + 4, cy + 4, cx + cellSize - 4, cy + cellSize - 4);
-                p.drawLine(cx + cellSize - 4, cy + 4, cx + 4, cy + cellSize - 4);
-            }
-        }
+    Bitboard misses = boardModel.misses();
+    p.setBrush(Qt::black); p.setPen(Qt::NoPen);
+    for (int idx = misses.popFirst(); idx >= 0; idx = misses.popFirst()) {
+        int cx = (idx % 10) * cellSize; int cy = (idx / 10) * cellSize;
+        p.drawRect(cx + cellSize/2 - 2, cy + cellSize/2 - 2, 4, 4);
+    }
+    Bitboard hits = boardModel.hits();
+    p.setPen(QPen(Qt::red, 3));
+    for (int idx = hits.popFirst(); idx >= 0; idx = hits.popFirst()) {
+        int cx = (idx % 10) * cellSize; int cy = (idx / 10) * cellSize;
+        p.drawLine(cx + 4, cy + 4, cx + cellSize - 4, cy + cellSize - 4);
+        p.drawLine(cx + cellSize - 4, cy + 4, cx + 4, cy + cellSize - 4);
+    }
+}
+
+void BoardWidget::paintEvent(QPaintEvent *) {
+    if (staticDirty || staticLayer.deviceIndependentSize() != QSizeF(size())
+        || staticLayer.devicePixelRatio() != devicePixelRatioF()) {
+        rebuildStaticLayer();
     }
 
+    // Рисование уже обрезано по грязной области (клетка наведения, след ракеты),
+    // поэтому копируется только ее кусок слоя, а поверх — подвижные элементы
+    QPainter p(this);
+    p.setRenderHint(QPainter::Antialiasing, false);
+    p.drawPixmap(0, 0, staticLayer);
+    int cellSize = this->cellSize();
+    if (cellSize <= 0) return;
+    int boardSize = cellSize * 10;
+    p.translate(MARGIN, 0);
+
     if (highlightPos.x() >= 0 && highlightPos.y() >= 0) {
         int cx = highlightPos.x() * cellSize;
         int cy = highlightPos.y() * cellSize;
@@ -363,47 +467,26 @@ void BoardWidget::paintEvent(QPaintEvent *) {
     p.setPen(QPen(Qt::black, 2)); p.setBrush(Qt::NoBrush);
     p.drawRect(0, 0, boardSize, boardSize);
 
-    if (currentAnim.state != AnimState::Idle) {
-        if (currentAnim.state == AnimState::Falling) drawMissile(p);
-        else if (currentAnim.state == AnimState::Exploding) drawExplosion(p);
+    // Взрывы под летящими ракетами
+    for (const MissileAnim &m : missiles) {
+        if (m.state == AnimState::Exploding) drawExplosion(p, m);
     }
-}
-
-int BoardWidget::receiveShot(int x, int y) {
-    if (x < 0 || x >= 10 || y < 0 || y >= 10) return -1;
-    // Если уже стреляли
-    if (grid[x][y] != Empty && grid[x][y] != ShipCell) return -1;
-
-    Ship* s = getShipAt(x, y);
-    if (s) {
-        grid[x][y] = Hit;
-        s->hits++;
-        if (s->isDestroyed()) {
-            markAroundDestroyed(s);
-            update();
-            return 2; // Убил
-        }
-        update();
-        return 1; // Попал
-    } else {
-        grid[x][y] = Miss;
-        update();
-        return 0; // Мимо
+    for (const MissileAnim &m : missiles) {
+        if (m.state == AnimState::Falling && m.delay == 0) drawMissile(p, m);
     }
 }
 
-void BoardWidget::markAroundDestroyed(Ship *s) {
-    int dx = (s->orientation == Orientation::Horizontal) ? 1 : 0;
-    int dy = (s->orientation == Orientation::Vertical) ? 1 : 0;
-    int x1 = s->topLeft.x(); int y1 = s->topLeft.y();
-    int x2 = x1 + (s->size-1)*dx; int y2 = y1 + (s->size-1)*dy;
-    for (int i = x1 - 1; i <= x2 + 1; ++i) {
-        for (int j = y1 - 1; j <= y2 + 1; ++j) {
-            if (i >= 0 && i < 10 && j >= 0 && j < 10) {
-                if (grid[i][j] == Empty) grid[i][j] = Miss;
-            }
-        }
-    }
+int BoardWidget::receiveShot(int x, int y) {
+    // -1 уже стреляли, 0 мимо, 1 попал, 2 убил (клетки вокруг помечает модель)
+    int slot = -1;
+    Bitboard marked = boardModel.shots();
+    int res = boardModel.receiveShot(x, y, &slot);
+    if (slot >= 0) myShips[slot].hits++;
+    // Клетка выстрела, а при убийстве — корабль (меняет вид) и ореол вокруг
+    Bitboard changed = boardModel.shots() & ~marked;
+    if (res == BoardModel::ShotKill) changed |= boardModel.shipMaskOf(slot);
+    if (res != BoardModel::ShotAlready) invalidateLayer(cellsRect(changed));
+    return res;
 }
 
 void BoardWidget::dragEnterEvent(QDragEnterEvent *event) {
@@ -421,14 +504,14 @@ void BoardWidget::dropEvent(QDropEvent *event) {
     int shipId = parts[0].toInt();
     Orientation orient = Orientation::Horizontal;
     Ship* targetShip = nullptr;
-    for(Ship* s : myShips) { if(s->id == shipId) { targetShip = s; break; } }
+    for (int i = 0; i < myShipCount; ++i) { if (myShips[i].id == shipId) { targetShip = &myShips[i]; break; } }
     if (targetShip) {
         QPoint oldPos = targetShip->topLeft;
         targetShip->topLeft = QPoint(-1, -1);
         if (placeShip(targetShip, gridPos.x(), gridPos.y(), orient)) {
             event->setDropAction(Qt::MoveAction); event->accept(); emit shipPlaced();
         } else {
-            targetShip->topLeft = oldPos; event->ignore();
+            targetShip->topLeft = oldPos; placeShipCells(targetShip); event->ignore();
         }
     }
 }
@@ -446,61 +529,41 @@ void BoardWidget::mousePressEvent(QMouseEvent *event) {
     if(s && event->button() == Qt::LeftButton) {
         QDrag *drag = new QDrag(this); QMimeData *mime = new QMimeData();
         mime->setText(QString("%1:%2").arg(s->id).arg((int)s->orientation)); drag->setMimeData(mime);
-        int cellSize = 30; int w = (s->orientation == Orientation::Horizontal) ? s->size * cellSize : cellSize;
-        int h = (s->orientation == Orientation::Vertical) ? s->size * cellSize : cellSize;
-        QPixmap pixmap(w, h); pixmap.fill(Qt::transparent); QPainter pixPainter(&pixmap);
-        BoardWidget::drawShipShape(pixPainter, s->size, s->orientation, QRect(0,0,w,h), false, false);
-        pixPainter.end(); drag->setPixmap(pixmap); drag->setHotSpot(QPoint(cellSize / 2, cellSize / 2));
+        int cellSize = 30;
+        drag->setPixmap(shipSprite(s->size, s->orientation, false, false, cellSize, devicePixelRatioF()));
+        drag->setHotSpot(QPoint(cellSize / 2, cellSize / 2));
+        // На время перетаскивания корабль снимается с поля (и из таблицы клеток),
+        // при отмене возвращается на прежнее место
         QPoint oldPos = s->topLeft; Orientation oldOrient = s->orientation;
-        s->topLeft = QPoint(-1, -1); update();
+        removeShipCells(s); s->topLeft = QPoint(-1, -1); invalidateLayer();
         if (drag->exec(Qt::MoveAction) != Qt::MoveAction) {
-            s->topLeft = oldPos; s->orientation = oldOrient; update();
+            s->topLeft = oldPos; s->orientation = oldOrient; placeShipCells(s); invalidateLayer();
         }
     } else if (s && event->button() == Qt::RightButton) {
         Orientation newO = (s->orientation == Orientation::Horizontal) ? Orientation::Vertical : Orientation::Horizontal;
         QPoint oldPos = s->topLeft; s->topLeft = QPoint(-1, -1);
-        if (!placeShip(s, oldPos.x(), oldPos.y(), newO)) { s->topLeft = oldPos; } update();
+        if (!placeShip(s, oldPos.x(), oldPos.y(), newO)) { s->topLeft = oldPos; } invalidateLayer();
     }
 }
 
-bool BoardWidget::isAllDestroyed() {
-    for (Ship* s : myShips) { if (!s->isDestroyed()) return false; } return true;
-}
+bool BoardWidget::isAllDestroyed() { return boardModel.isAllDestroyed(); }
 
-bool BoardWidget::autoPlaceShips() {
-    clearBoard();
-    for(auto s : myShips) s->topLeft = QPoint(-1,-1);
-    int loopSafety = 0;
-    for(auto s : myShips) {
-        bool placed = false;
-        while(!placed && loopSafety < 5000) {
-            loopSafety++;
-            int x = QRandomGenerator::global()->bounded(10); int y = QRandomGenerator::global()->bounded(10);
-            Orientation o = (QRandomGenerator::global()->bounded(2) == 0) ? Orientation::Horizontal : Orientation::Vertical;
-            if(placeShip(s, x, y, o)) placed = true;
-        }
+bool BoardWidget::autoPlaceShips(FleetPlacer::Mode mode, QRandomGenerator *rng) {
+    Placement placements[BoardModel::MAX_SHIPS];
+    if (!FleetPlacer::placeFleet(boardModel, rng ? *rng : *QRandomGenerator::global(), mode, placements)) return false;
+    for (int i = 0; i < boardModel.shipCount(); ++i) {
+        myShips[i].topLeft = QPoint(placements[i].x, placements[i].y);
+        myShips[i].orientation = placements[i].orient;
     }
-    return loopSafety < 5000;
+    invalidateLayer();
+    return true;
 }
 
 void BoardWidget::placeShipCells(Ship* ship) {
     if (!ship->isPlaced()) return;
-    int dx = (ship->orientation == Orientation::Horizontal) ? 1 : 0;
-    int dy = (ship->orientation == Orientation::Vertical) ? 1 : 0;
-    for(int i=0; i<ship->size; ++i) {
-        int cellX = ship->topLeft.x() + i * dx; int cellY = ship->topLeft.y() + i * dy;
-        if (cellX >= 0 && cellX < 10 && cellY >= 0 && cellY < 10) grid[cellX][cellY] = ShipCell;
-    }
+    boardModel.placeShip(slotOf(ship), ship->topLeft.x(), ship->topLeft.y(), ship->orientation);
 }
 
 void BoardWidget::removeShipCells(Ship* ship) {
-    if (!ship->isPlaced()) return;
-    int dx = (ship->orientation == Orientation::Horizontal) ? 1 : 0;
-    int dy = (ship->orientation == Orientation::Vertical) ? 1 : 0;
-    for(int i=0; i<ship->size; ++i) {
-        int cellX = ship->topLeft.x() + i * dx; int cellY = ship->topLeft.y() + i * dy;
-        if (cellX >= 0 && cellX < 10 && cellY >= 0 && cellY < 10) {
-            if (grid[cellX][cellY] == ShipCell) grid[cellX][cellY] = Empty;
-        }
-    }
+    boardModel.removeShip(slotOf(ship));
 }
@@ -3,14 +3,14 @@
 
 #include <QWidget>
 #include <QVector>
+#include <QHash>
 #include <QPoint>
 #include <QPainter>
-#include <QTimer>
 #include "ship.h"
+#include "boardmodel.h"
+#include "fleetplacer.h"
 #include <algorithm>
 
-enum CellState { Empty, ShipCell, Miss, Hit };
-
 enum class AnimState { Idle, Falling, Exploding };
 
 struct MissileAnim {
@@ -21,6 +21,8 @@ struct MissileAnim {
     float speedY;
     int frame;
     bool isHit;
+    int delay = 0;   // Кадров до старта (залп запускается лесенкой)
+    QRect drawnRect; // Где ракета/взрыв нарисованы сейчас (для частичной перерисовки)
 };
 
 class BoardWidget : public QWidget
@@ -31,25 +33,36 @@ public:
     explicit BoardWidget(QWidget *parent = nullptr);
 
     static const int MARGIN = 30;
+    // Ракет и взрывов одновременно (залп кластера — 9)
+    static const int MAX_MISSILES = 16;
 
     static void drawShipShape(QPainter &p, int size, Orientation orient, QRect rect, bool isEnemy, bool isDestroyed);
+    // Спрайт корабля (size клеток по cellSize), нарисованный через drawShipShape. Не кэшируется —
+    // кэш держит владелец: поле (shipSprite) или метка панели расстановки.
+    static QPixmap renderShipSprite(int size, Orientation orient, bool isEnemy, bool isDestroyed, int cellSize, qreal dpr);
 
     QSize sizeHint() const override;
     int heightForWidth(int w) const override;
     void setupSizePolicy();
 
     void setEditable(bool editable);
-    void setShips(const QVector<Ship*>& ships);
+    // ships — массив count кораблей (флот партии), живет дольше поля; поле хранит только указатель
+    void setShips(Ship *ships, int count);
     void setShowShips(bool show);
-    void setActive(bool active) { isActive = active; update(); }
+    void setActive(bool active) { isActive = active; invalidateLayer(); }
     void setEnemy(bool enemy) { isEnemyBoard = enemy; }
 
     // --- НОВЫЕ МЕТОДЫ ДЛЯ МУЛЬТИПЛЕЕРА ---
     // Позволяет принудительно установить статус клетки (ответ от сервера)
     void setCellState(int x, int y, CellState state);
+    // Заменить все отметки выстрелов (перемотка записи партии)
+    void setShots(const Bitboard &hits, const Bitboard &misses);
 
     // Получить состояние клетки (нужно для радара и проверок)
-    CellState getCellState(int x, int y) { return grid[x][y]; }
+    CellState getCellState(int x, int y) { return boardModel.cellState(x, y); }
+
+    // Правила и состояние поля без отрисовки
+    const BoardModel &model() const { return boardModel; }
 
     // Методы способностей
     void setFog(bool active);
@@ -57,10 +70,13 @@ public:
 
     // Основная логика
     bool placeShip(Ship* ship, int x, int y, Orientation orient);
-    bool autoPlaceShips();
+    // rng — генератор партии (nullptr — общий)
+    bool autoPlaceShips(FleetPlacer::Mode mode = FleetPlacer::Uniform, QRandomGenerator *rng = nullptr);
     void clearBoard();
 
-    void animateShot(int x, int y);
+    void animateShot(int x, int y, int delayFrames = 0);
+    // Все выстрелы залпа летят одновременно, missileImpact приходит по каждому
+    void animateSalvo(const QVector<QPoint> &cells);
     int receiveShot(int x, int y); // Локальный расчет (когда стреляют в нас)
 
     bool canShootAt(int x, int y);
@@ -75,28 +91,27 @@ signals:
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void dragEnterEvent(QDragEnterEvent *event) override;
     void dropEvent(QDropEvent *event) override;
     void leaveEvent(QEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
 
-private slots:
-    void updateAnimation();
-
 private:
     bool isEditable;
     bool showShips;
     bool isEnemyBoard = false;
-    CellState grid[10][10];
-    QVector<Ship*> myShips;
+    BoardModel boardModel;
+    Ship *myShips = nullptr; // Корабль слота i — myShips[i]
+    int myShipCount = 0;
 
     bool isFoggy = false;
     QPoint highlightPos = QPoint(-1, -1);
 
     bool canPlace(int x, int y, int size, Orientation orient, Ship* ignoreShip);
     Ship* getShipAt(int x, int y);
-    void markAroundDestroyed(Ship *s);
+    int slotOf(const Ship *ship) const; // -1 — не корабль этого поля
     void placeShipCells(Ship* ship);
     void removeShipCells(Ship* ship);
 
@@ -104,11 +119,29 @@ private:
     int hoverX = -1;
     int hoverY = -1;
 
-    QTimer *animTimer;
-    MissileAnim currentAnim;
-
-    void drawMissile(QPainter &p);
-    void drawExplosion(QPainter &p);
+    // Пул анимаций на общих часах (AnimationClock): слот в состоянии Idle свободен
+    MissileAnim missiles[MAX_MISSILES];
+    bool updateAnimation(); // Кадр пула; false — все слоты свободны
+
+    // Кэш статичного слоя: фон, подписи, сетка, корабли, отметки выстрелов.
+    // Пересобирается только при изменении состояния или размера, кадры анимации его лишь копируют.
+    QPixmap staticLayer;
+    bool staticDirty = true;
+    void rebuildStaticLayer();
+    // Спрайты кораблей этого поля по ключу (размер, ориентация, чей, потоплен, размер клетки, DPR).
+    // Живут вместе с виджетом; при изменении размера поля сбрасываются.
+    QHash<quint64, QPixmap> shipSprites;
+    QPixmap shipSprite(int size, Orientation orient, bool isEnemy, bool isDestroyed, int cellSize, qreal dpr);
+    // Состояние поля изменилось: слой пересобрать, перерисовать area (пустой — весь виджет)
+    void invalidateLayer(const QRect &area = QRect());
+
+    int cellSize() const;
+    QRect cellRect(int x, int y) const;          // Клетка в координатах виджета (с запасом на толстые линии)
+    QRect cellsRect(const Bitboard &cells) const; // Общий прямоугольник набора клеток
+    QRect missileRect(const MissileAnim &m) const;
+
+    void drawMissile(QPainter &p, const MissileAnim &m);
+    void drawExplosion(QPainter &p, const MissileAnim &m);
 };
 
 #endif // BOARDWIDGET_H
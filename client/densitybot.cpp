@@ -0,0 +1,200 @@
+#include "densitybot.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DENSITY_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DENSITY_SSE2
+#endif
+
+namespace {
+
+// dst += src * k по всем дорожкам
+inline void mulAdd(std::int16_t *dst, const std::int16_t *src, std::int16_t k) {
+#if defined(DENSITY_AVX2)
+    __m256i vk = _mm256_set1_epi16(k);
+    for (int i = 0; i < DensityBot::LANES; i += 16) {
+        __m256i d = _mm256_load_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_add_epi16(d, _mm256_mullo_epi16(s, vk)));
+    }
+#elif defined(DENSITY_SSE2)
+    __m128i vk = _mm_set1_epi16(k);
+    for (int i = 0; i < DensityBot::LANES; i += 8) {
+        __m128i d = _mm_load_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_store_si128(reinterpret_cast<__m128i *>(dst + i), _mm_add_epi16(d, _mm_mullo_epi16(s, vk)));
+    }
+#else
+    for (int i = 0; i < DensityBot::LANES; ++i) dst[i] = std::int16_t(dst[i] + src[i] * k);
+#endif
+}
+
+}
+
+DensityBot::DensityBot() {
+    int none[1] = {0};
+    reset(none, 0);
+}
+
+void DensityBot::reset(const int *fleetSizes, int count) {
+    shots = Bitboard();
+    blocked = Bitboard();
+    openHits = Bitboard();
+    std::fill(std::begin(remaining), std::end(remaining), 0);
+    for (int i = 0; i < count; ++i) {
+        if (fleetSizes[i] >= 1 && fleetSizes[i] <= FleetPlacer::MAX_SIZE) remaining[fleetSizes[i]]++;
+    }
+
+    std::memset(countsBySize, 0, sizeof(countsBySize));
+    std::memset(target, 0, sizeof(target));
+    std::memset(combined, 0, sizeof(combined));
+    for (int size = 1; size <= FleetPlacer::MAX_SIZE; ++size) {
+        alive[size].assign(FleetPlacer::placementCount(size), 1);
+        for (int i = 0; i < FleetPlacer::placementCount(size); ++i) {
+            Bitboard m = FleetPlacer::placement(size, i).mask;
+            for (int idx = m.popFirst(); idx >= 0; idx = m.popFirst()) countsBySize[size][idx]++;
+        }
+    }
+}
+
+// Клетки, где кораблей быть не может: гасим все позиции через них и вычитаем их вклад
+void DensityBot::block(const Bitboard &cells) {
+    Bitboard fresh = cells & ~blocked;
+    blocked |= fresh;
+    for (int idx = fresh.popFirst(); idx >= 0; idx = fresh.popFirst()) {
+        for (int size = 1; size <= FleetPlacer::MAX_SIZE; ++size) {
+            for (std::int16_t p : FleetPlacer::placementsAt(size, idx)) {
+                if (!alive[size][p]) continue;
+                alive[size][p] = 0;
+                Bitboard m = FleetPlacer::placement(size, p).mask;
+                for (int c = m.popFirst(); c >= 0; c = m.popFirst()) countsBySize[size][c]--;
+            }
+        }
+    }
+}
+
+void DensityBot::onShotResult(int x, int y, int result) {
+    if (!BoardModel::inBounds(x, y) || result < 0) return;
+    int idx = BoardModel::index(x, y);
+    shots.set(idx);
+
+    if (result == BoardModel::ShotMiss) {
+        block(Bitboard::cell(idx));
+        return;
+    }
+
+    openHits.set(idx);
+    if (result != BoardModel::ShotKill) return;
+
+    // Корабли не касаются друг друга: потопленный — это связная группа попаданий с этой клеткой
+    Bitboard ship = BoardModel::component(openHits, idx);
+
+    int size = ship.count();
+    if (size >= 1 && size <= FleetPlacer::MAX_SIZE && remaining[size] > 0) remaining[size]--;
+    openHits &= ~ship;
+    block(BoardModel::halo(ship));
+}
+
+// Режим добивания: позиции, накрывающие открытые попадания и не касающиеся чужих
+bool DensityBot::buildTargetDensity() {
+    std::memset(target, 0, sizeof(target));
+    if (openHits.none()) return false;
+
+    bool any = false;
+    Bitboard hits = openHits;
+    for (int idx = hits.popFirst(); idx >= 0; idx = hits.popFirst()) {
+        for (int size = 1; size <= FleetPlacer::MAX_SIZE; ++size) {
+            if (!remaining[size]) continue;
+            for (std::int16_t p : FleetPlacer::placementsAt(size, idx)) {
+                if (!alive[size][p]) continue;
+                const Placement &pl = FleetPlacer::placement(size, p);
+                Bitboard covered = pl.mask & openHits;
+                // Каждую позицию считаем один раз — от младшего накрытого попадания
+                if (covered.first() != idx) continue;
+                if ((pl.halo & ~pl.mask).intersects(openHits)) continue;
+                int k = covered.count();
+                std::int16_t w = std::int16_t(remaining[size] * k * k);
+                Bitboard m = pl.mask;
+                for (int c = m.popFirst(); c >= 0; c = m.popFirst()) target[c] += w;
+                any = true;
+            }
+        }
+    }
+    return any;
+}
+
+void DensityBot::combineHuntDensity() {
+    std::memset(combined, 0, sizeof(combined));
+    for (int size = 1; size <= FleetPlacer::MAX_SIZE; ++size) {
+        if (remaining[size]) mulAdd(combined, countsBySize[size], std::int16_t(remaining[size]));
+    }
+}
+
+// Максимум по разрешенным клеткам, равные — случайно. Значения сдвинуты на +1, запрещенные обнулены.
+int DensityBot::pickMax(const Bitboard &allowed, const std::int16_t *values, QRandomGenerator &rng) const {
+    alignas(32) std::int16_t masked[LANES] = {};
+    for (int i = 0; i < BoardModel::CELLS; ++i) {
+        masked[i] = allowed.test(i) ? std::int16_t(values[i] + 1) : std::int16_t(0);
+    }
+
+    std::int16_t best = 0;
+    int ties[BoardModel::CELLS];
+    int tieCount = 0;
+#if defined(DENSITY_AVX2)
+    __m256i vmax = _mm256_setzero_si256();
+    for (int i = 0; i < LANES; i += 16)
+        vmax = _mm256_max_epi16(vmax, _mm256_load_si256(reinterpret_cast<const __m256i *>(masked + i)));
+    alignas(32) std::int16_t lanes[16];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), vmax);
+    best = *std::max_element(lanes, lanes + 16);
+    if (best == 0) return -1;
+    __m256i vbest = _mm256_set1_epi16(best);
+    for (int i = 0; i < LANES; i += 16) {
+        unsigned bits = unsigned(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi16(_mm256_load_si256(reinterpret_cast<const __m256i *>(masked + i)), vbest)));
+        for (int j = 0; j < 16; ++j)
+            if (bits & (1u << (2 * j))) ties[tieCount++] = i + j;
+    }
+#elif defined(DENSITY_SSE2)
+    __m128i vmax = _mm_setzero_si128();
+    for (int i = 0; i < LANES; i += 8)
+        vmax = _mm_max_epi16(vmax, _mm_load_si128(reinterpret_cast<const __m128i *>(masked + i)));
+    alignas(16) std::int16_t lanes[8];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), vmax);
+    best = *std::max_element(lanes, lanes + 8);
+    if (best == 0) return -1;
+    __m128i vbest = _mm_set1_epi16(best);
+    for (int i = 0; i < LANES; i += 8) {
+        unsigned bits = unsigned(_mm_movemask_epi8(
+            _mm_cmpeq_epi16(_mm_load_si128(reinterpret_cast<const __m128i *>(masked + i)), vbest)));
+        for (int j = 0; j < 8; ++j)
+            if (bits & (1u << (2 * j))) ties[tieCount++] = i + j;
+    }
+#else
+    best = *std::max_element(masked, masked + BoardModel::CELLS);
+    if (best == 0) return -1;
+    for (int i = 0; i < BoardModel::CELLS; ++i)
+        if (masked[i] == best) ties[tieCount++] = i;
+#endif
+    return ties[rng.bounded(tieCount)];
+}
+
+int DensityBot::nextShot(QRandomGenerator &rng) {
+    Bitboard allowed = ~(shots | blocked);
+    if (allowed.none()) return -1;
+
+    if (buildTargetDensity()) {
+        // Добиваем, только если есть плотность по разрешенным клеткам
+        Bitboard positive;
+        for (int i = 0; i < BoardModel::CELLS; ++i)
+            if (target[i] > 0 && allowed.test(i)) positive.set(i);
+        if (positive.any()) return pickMax(positive, target, rng);
+    }
+
+    combineHuntDensity();
+    return pickMax(allowed, combined, rng);
+}
@@ -0,0 +1,54 @@
+#ifndef DENSITYBOT_H
+#define DENSITYBOT_H
+
+#include <QRandomGenerator>
+#include <cstdint>
+#include <vector>
+#include "boardmodel.h"
+#include "fleetplacer.h"
+#include "shooter.h"
+
+// "Сложный" бот: карта плотности всех позиций оставшихся кораблей,
+// совместимых с известными попаданиями, промахами и ореолами потопленных.
+// Стреляет в максимум. Карта обновляется инкрементально после каждого результата.
+class DensityBot : public Shooter
+{
+public:
+    // 100 клеток, выровненные до кратного 16 (ширина AVX2 для int16)
+    static const int LANES = 112;
+
+    DensityBot();
+
+    const char *name() const override { return "density"; }
+    void reset(const int *fleetSizes, int count) override;
+    int nextShot(QRandomGenerator &rng) override;
+    void onShotResult(int x, int y, int result) override;
+
+    // Текущая карта плотности (для отладки и инструментов)
+    const std::int16_t *density() const { return combined; }
+
+    // Накопленные наблюдения (их же использует MonteCarloBot)
+    const Bitboard &shotMask() const { return shots; }
+    const Bitboard &blockedMask() const { return blocked; }
+    const Bitboard &openHitMask() const { return openHits; }
+    int remainingShips(int size) const { return remaining[size]; }
+
+private:
+    Bitboard shots;     // Куда уже стреляли
+    Bitboard blocked;   // Где точно нет живых кораблей: промахи, потопленные и их ореолы
+    Bitboard openHits;  // Попадания по еще не потопленным кораблям
+    int remaining[FleetPlacer::MAX_SIZE + 1];
+
+    // Живость каждой позиции и вклад живых позиций по размерам
+    std::vector<std::uint8_t> alive[FleetPlacer::MAX_SIZE + 1];
+    alignas(32) std::int16_t countsBySize[FleetPlacer::MAX_SIZE + 1][LANES];
+    alignas(32) std::int16_t target[LANES];
+    alignas(32) std::int16_t combined[LANES];
+
+    void block(const Bitboard &cells);
+    bool buildTargetDensity();
+    void combineHuntDensity();
+    int pickMax(const Bitboard &allowed, const std::int16_t *values, QRandomGenerator &rng) const;
+};
+
+#endif // DENSITYBOT_H
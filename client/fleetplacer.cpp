@@ -0,0 +1,158 @@
+#include "fleetplacer.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Равномерная выборка: попыток до отката на перебор (успешна примерно одна из 4000)
+const int UNIFORM_ATTEMPTS = 200000;
+// Перебор: лимит узлов на один запуск и число перезапусков со свежим порядком
+const int SEARCH_NODE_BUDGET = 20000;
+const int SEARCH_RESTARTS = 8;
+
+struct PlacementTable {
+    std::vector<Placement> bySize[FleetPlacer::MAX_SIZE + 1];
+    std::vector<std::int16_t> byCell[FleetPlacer::MAX_SIZE + 1][BoardModel::CELLS];
+    PlacementTable() {
+        for (int size = 1; size <= FleetPlacer::MAX_SIZE; ++size) {
+            for (int o = 0; o < 2; ++o) {
+                Orientation orient = (o == 0) ? Orientation::Horizontal : Orientation::Vertical;
+                if (size == 1 && orient == Orientation::Vertical) continue;
+                for (int y = 0; y < BoardModel::SIZE; ++y) {
+                    for (int x = 0; x < BoardModel::SIZE; ++x) {
+                        Bitboard mask = BoardModel::shipMask(x, y, size, orient);
+                        if (mask.none()) continue;
+                        bySize[size].push_back({mask, BoardModel::halo(mask), x, y, orient});
+                    }
+                }
+            }
+            for (int i = 0; i < (int)bySize[size].size(); ++i) {
+                Bitboard m = bySize[size][i].mask;
+                for (int idx = m.popFirst(); idx >= 0; idx = m.popFirst()) byCell[size][idx].push_back(std::int16_t(i));
+            }
+        }
+    }
+};
+
+const PlacementTable &table() {
+    static const PlacementTable t;
+    return t;
+}
+
+// Состояние перебора с возвратом
+struct Search {
+    const int *sizes;   // Размеры в порядке расстановки (по убыванию)
+    int count;
+    QRandomGenerator *rng;
+    const Placement **result;
+    long nodes;
+    long budget;        // <= 0 — без лимита
+
+    // Сколько позиций каждого размера еще свободно при данном blocked
+    bool feasible(int from, const Bitboard &blocked) const {
+        int need[FleetPlacer::MAX_SIZE + 1] = {};
+        for (int i = from; i < count; ++i) need[sizes[i]]++;
+        for (int size = 1; size <= FleetPlacer::MAX_SIZE; ++size) {
+            if (!need[size]) continue;
+            int free = 0;
+            for (const Placement &p : table().bySize[size]) {
+                if (!p.mask.intersects(blocked) && ++free >= need[size]) break;
+            }
+            if (free < need[size]) return false;
+        }
+        return true;
+    }
+
+    bool run(int depth, const Bitboard &blocked) {
+        if (depth == count) return true;
+        if (budget > 0 && ++nodes > budget) return false;
+
+        const std::vector<Placement> &all = table().bySize[sizes[depth]];
+        std::vector<int> candidates;
+        candidates.reserve(all.size());
+        for (int i = 0; i < (int)all.size(); ++i) {
+            if (!all[i].mask.intersects(blocked)) candidates.push_back(i);
+        }
+        std::shuffle(candidates.begin(), candidates.end(), *rng);
+
+        for (int i : candidates) {
+            Bitboard next = blocked | all[i].halo;
+            if (!feasible(depth + 1, next)) continue;
+            result[depth] = &all[i];
+            if (run(depth + 1, next)) return true;
+            if (budget > 0 && nodes > budget) return false;
+        }
+        return false;
+    }
+};
+
+}
+
+int FleetPlacer::placementCount(int size) {
+    if (size < 1 || size > MAX_SIZE) return 0;
+    return (int)table().bySize[size].size();
+}
+
+const Placement &FleetPlacer::placement(int size, int i) {
+    return table().bySize[size][i];
+}
+
+const std::vector<std::int16_t> &FleetPlacer::placementsAt(int size, int idx) {
+    return table().byCell[size][idx];
+}
+
+// Корабли расставляются независимо и равномерно; при любом пересечении вся попытка отбрасывается.
+// Каждой расстановке флота соответствует одинаковое число упорядоченных наборов, поэтому итог равномерен.
+bool FleetPlacer::sampleUniform(const int *sizes, int count, QRandomGenerator &rng, const Placement **result) {
+    for (int attempt = 0; attempt < UNIFORM_ATTEMPTS; ++attempt) {
+        Bitboard blocked;
+        int i = 0;
+        for (; i < count; ++i) {
+            const std::vector<Placement> &all = table().bySize[sizes[i]];
+            const Placement &p = all[rng.bounded((int)all.size())];
+            if (p.mask.intersects(blocked)) break;
+            blocked |= p.halo;
+            result[i] = &p;
+        }
+        if (i == count) return true;
+    }
+    return false;
+}
+
+bool FleetPlacer::sampleBacktracking(const int *sizes, int count, QRandomGenerator &rng, const Placement **result) {
+    Search search{sizes, count, &rng, result, 0, SEARCH_NODE_BUDGET};
+    for (int restart = 0; restart < SEARCH_RESTARTS; ++restart) {
+        search.nodes = 0;
+        if (search.run(0, Bitboard())) return true;
+    }
+    // Последняя попытка — полный перебор без лимита
+    search.budget = 0;
+    return search.run(0, Bitboard());
+}
+
+bool FleetPlacer::placeFleet(BoardModel &model, QRandomGenerator &rng, Mode mode, Placement *out) {
+    int count = model.shipCount();
+
+    // Крупные корабли первыми: меньше ветвление при переборе
+    int order[BoardModel::MAX_SHIPS];
+    int sizes[BoardModel::MAX_SHIPS];
+    for (int i = 0; i < count; ++i) order[i] = i;
+    std::stable_sort(order, order + count, [&](int a, int b) { return model.shipSize(a) > model.shipSize(b); });
+    for (int i = 0; i < count; ++i) {
+        sizes[i] = model.shipSize(order[i]);
+        if (sizes[i] < 1 || sizes[i] > MAX_SIZE) return false;
+    }
+
+    const Placement *result[BoardModel::MAX_SHIPS];
+    bool ok = (mode == Uniform && sampleUniform(sizes, count, rng, result))
+              || sampleBacktracking(sizes, count, rng, result);
+    if (!ok) return false;
+
+    model.clear();
+    for (int i = 0; i < count; ++i) {
+        const Placement &p = *result[i];
+        model.placeShip(order[i], p.x, p.y, p.orient);
+        if (out) out[order[i]] = p;
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef FLEETPLACER_H
+#define FLEETPLACER_H
+
+#include <QRandomGenerator>
+#include <cstdint>
+#include <vector>
+#include "boardmodel.h"
+
+// Одна допустимая позиция корабля на пустом поле
+struct Placement {
+    Bitboard mask;  // Клетки корабля
+    Bitboard halo;  // Клетки корабля + соседи (туда нельзя ставить другие)
+    int x;
+    int y;
+    Orientation orient;
+};
+
+// Расстановка флота по предрасчитанным маскам всех позиций каждого размера.
+class FleetPlacer
+{
+public:
+    static const int MAX_SIZE = 4;
+
+    enum Mode {
+        Backtracking, // Перебор с возвратом и отсечением: всегда находит расстановку, если она существует
+        Uniform       // Равномерно по всем допустимым расстановкам (с откатом на Backtracking по лимиту)
+    };
+
+    // Все позиции корабля размера size (1..MAX_SIZE). Однопалубные — только горизонтальные.
+    static int placementCount(int size);
+    static const Placement &placement(int size, int i);
+    // Номера позиций размера size, накрывающих клетку idx
+    static const std::vector<std::int16_t> &placementsAt(int size, int idx);
+
+    // Расставляет все корабли модели (размеры из model.shipSize), старая расстановка и выстрелы сбрасываются.
+    // В out (если задан) пишутся позиции по слотам.
+    static bool placeFleet(BoardModel &model, QRandomGenerator &rng, Mode mode = Uniform, Placement *out = nullptr);
+
+private:
+    static bool sampleUniform(const int *sizes, int count, QRandomGenerator &rng, const Placement **result);
+    static bool sampleBacktracking(const int *sizes, int count, QRandomGenerator &rng, const Placement **result);
+};
+
+#endif // FLEETPLACER_H
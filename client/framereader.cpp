@@ -0,0 +1,107 @@
+#include "framereader.h"
+#include "wireprotocol.h"
+#include <algorithm>
+#include <cstring>
+
+FrameReader::FrameReader(int capacity) : ring(capacity), head(0), count(0), scanned(0) {}
+
+void FrameReader::clear() {
+    head = 0;
+    count = 0;
+    scanned = 0;
+}
+
+char *FrameReader::writeSpace(int wanted, int *space) {
+    int capacity = int(ring.size());
+    if (capacity - count < wanted && capacity < MAX_CAPACITY) {
+        int target = capacity;
+        while (target - count < wanted && target < MAX_CAPACITY) target *= 2;
+        grow(target);
+        capacity = target;
+    }
+    if (count == 0) head = 0;
+    if (count == capacity) {
+        *space = 0;
+        return nullptr;
+    }
+    int tail = (head + count) & mask();
+    *space = tail >= head ? capacity - tail : head - tail;
+    return ring.data() + tail;
+}
+
+void FrameReader::commit(int n) {
+    count += n;
+}
+
+void FrameReader::grow(int capacity) {
+    std::vector<char> bigger(capacity);
+    int first = std::min(count, int(ring.size()) - head);
+    std::memcpy(bigger.data(), ring.data() + head, first);
+    std::memcpy(bigger.data() + first, ring.data(), count - first);
+    ring.swap(bigger);
+    head = 0;
+}
+
+// Первые n байт одним куском: прямо из кольца или склеенные во временный буфер
+const char *FrameReader::peek(int n) {
+    if (head + n <= int(ring.size())) return ring.data() + head;
+    scratch.resize(n);
+    int first = int(ring.size()) - head;
+    std::memcpy(scratch.data(), ring.data() + head, first);
+    std::memcpy(scratch.data() + first, ring.data(), n - first);
+    return scratch.data();
+}
+
+void FrameReader::consume(int n) {
+    head = (head + n) & mask();
+    count -= n;
+    scanned = 0;
+}
+
+bool FrameReader::nextLine(const char **line, int *len) {
+    while (count > 0) {
+        // Ищем '\n' в непроверенной части (максимум два непрерывных участка)
+        int end = -1;
+        while (scanned < count) {
+            int pos = (head + scanned) & mask();
+            int chunk = std::min(count - scanned, int(ring.size()) - pos);
+            const void *found = std::memchr(ring.data() + pos, '\n', chunk);
+            if (found) {
+                end = scanned + int(static_cast<const char *>(found) - (ring.data() + pos));
+                break;
+            }
+            scanned += chunk;
+        }
+        if (end < 0) return false;
+
+        const char *data = peek(end);
+        int begin = 0;
+        int stop = end;
+        while (begin < stop && (data[begin] == ' ' || data[begin] == '\t' || data[begin] == '\r')) ++begin;
+        while (stop > begin && (data[stop - 1] == ' ' || data[stop - 1] == '\t' || data[stop - 1] == '\r')) --stop;
+        consume(end + 1);
+        if (stop == begin) continue;
+
+        *line = data + begin;
+        *len = stop - begin;
+        return true;
+    }
+    return false;
+}
+
+int FrameReader::nextFrame(std::uint8_t *op, const std::uint8_t **payload, int *size) {
+    if (count == 0) return 0;
+    int header = std::min(count, WireProtocol::MAX_VARINT);
+    std::uint32_t length = 0;
+    int varint = WireProtocol::getVarint(reinterpret_cast<const std::uint8_t *>(peek(header)), header, &length);
+    if (varint <= 0) return varint;
+    if (length == 0 || length > std::uint32_t(WireProtocol::MAX_FRAME)) return -1;
+    int total = varint + int(length);
+    if (count < total) return 0;
+
+    const std::uint8_t *data = reinterpret_cast<const std::uint8_t *>(peek(total));
+    int parsed = WireProtocol::parseFrame(data, total, op, payload, size);
+    if (parsed <= 0) return -1;
+    consume(total);
+    return 1;
+}
@@ -0,0 +1,48 @@
+#ifndef FRAMEREADER_H
+#define FRAMEREADER_H
+
+#include <cstdint>
+#include <vector>
+
+// Кольцевой буфер входящих данных сокета: строки JSON и бинарные кадры достаются
+// указателями прямо в буфер, без копии на каждое сообщение. Копируется только
+// сообщение, перешедшее через конец кольца (во временный буфер).
+// Без Qt: тот же код использует сервер.
+class FrameReader
+{
+public:
+    static const int INITIAL_CAPACITY = 4096;
+    static const int MAX_CAPACITY = 1 << 20; // Недочитанное сообщение больше — поток испорчен
+
+    explicit FrameReader(int capacity = INITIAL_CAPACITY); // capacity — степень двойки
+
+    void clear();
+    int size() const { return count; }
+
+    // Непрерывное свободное место под запись (в *space), буфер растет до wanted байт свободного места.
+    // nullptr — буфер уже максимального размера и заполнен.
+    char *writeSpace(int wanted, int *space);
+    // Подтверждает n байт, записанных в writeSpace
+    void commit(int n);
+
+    // Очередная строка без перевода строки и пробелов по краям, пустые пропускаются.
+    // Указатель действителен до следующего writeSpace/nextLine/nextFrame.
+    bool nextLine(const char **line, int *len);
+    // Очередной бинарный кадр: 1 — есть, 0 — ждем данных, -1 — поток испорчен.
+    // payload действителен до следующего writeSpace/nextLine/nextFrame.
+    int nextFrame(std::uint8_t *op, const std::uint8_t **payload, int *size);
+
+private:
+    std::vector<char> ring;    // Размер — степень двойки
+    std::vector<char> scratch; // Для сообщений через конец кольца
+    int head;                  // Начало непрочитанных данных
+    int count;                 // Сколько непрочитанных
+    int scanned;               // Сколько из них уже проверено на '\n'
+
+    int mask() const { return int(ring.size()) - 1; }
+    const char *peek(int n);
+    void consume(int n);
+    void grow(int capacity);
+};
+
+#endif // FRAMEREADER_H
@@ -10,6 +10,7 @@
 #include <QPainter>
 #include <QCursor>
 #include <QRegion>
+#include "animationclock.h"
 
 // --- Реализация AvatarWidget ---
 AvatarWidget::AvatarWidget(bool isPlayer, QWidget *parent)
@@ -84,22 +85,18 @@ void MessageBubble::hideMessage() {
 ManaBar::ManaBar(QWidget *parent) : QWidget(parent), currentMana(0) {
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     setMinimumHeight(30);
-
-    // Таймер для тряски при 100% маны
-    shakeTimer = new QTimer(this);
-    shakeTimer->setInterval(30); // 30 мс интервал
-    connect(shakeTimer, &QTimer::timeout, this, &ManaBar::updateShake);
 }
 
 void ManaBar::setMana(int mana) {
     currentMana = std::clamp(mana, 0, 100);
 
     // Если мана полная - включаем тряску, если нет - выключаем
+    // Тряска при 100% маны идет от общих часов анимаций
     if (currentMana >= 100) {
-        if (!shakeTimer->isActive()) shakeTimer->start();
+        if (!AnimationClock::instance()->isRunning(this)) AnimationClock::instance()->repeat(this, AnimationClock::SHAKE_MS, [this]() { updateShake(); });
     } else {
-        if (shakeTimer->isActive()) {
-            shakeTimer->stop();
+        if (AnimationClock::instance()->isRunning(this)) {
+            AnimationClock::instance()->stop(this);
             shakeOffset = QPoint(0, 0);
         }
     }
@@ -196,10 +193,6 @@ AbilityWidget::AbilityWidget(int type, int cost, const QString &iconPath, QWidge
     if (!iconPath.isEmpty()) {
         iconPixmap.load(iconPath);
     }
-
-    shakeTimer = new QTimer(this);
-    shakeTimer->setInterval(30);
-    connect(shakeTimer, &QTimer::timeout, this, &AbilityWidget::updateShake);
 }
 
 void AbilityWidget::setAvailable(bool available) {
@@ -208,11 +201,11 @@ void AbilityWidget::setAvailable(bool available) {
         setCursor(isAvailable ? Qt::PointingHandCursor : Qt::ArrowCursor);
 
         if (!isAvailable) {
-            shakeTimer->stop();
+            AnimationClock::instance()->stop(this);
             shakeOffset = QPoint(0, 0);
         } else {
             if (underMouse()) {
-                shakeTimer->start();
+                AnimationClock::instance()->repeat(this, AnimationClock::SHAKE_MS, [this]() { updateShake(); });
             }
         }
         update();
@@ -221,13 +214,13 @@ void AbilityWidget::setAvailable(bool available) {
 
 void AbilityWidget::enterEvent(QEnterEvent *event) {
     if (isAvailable) {
-        shakeTimer->start();
+        AnimationClock::instance()->repeat(this, AnimationClock::SHAKE_MS, [this]() { updateShake(); });
     }
     QWidget::enterEvent(event);
 }
 
 void AbilityWidget::leaveEvent(QEvent *event) {
-    shakeTimer->stop();
+    AnimationClock::instance()->stop(this);
     shakeOffset = QPoint(0, 0);
     update();
     QWidget::leaveEvent(event);
@@ -327,9 +320,7 @@ public:
 protected:
     void paintEvent(QPaintEvent *) override {
         QPainter p(this);
-        p.setRenderHint(QPainter::Antialiasing);
-        QRect shipRect(5, 5, size * 30, 30);
-        BoardWidget::drawShipShape(p, size, Orientation::Horizontal, shipRect, false, false);
+        p.drawPixmap(5, 5, shipSprite());
     }
     void mousePressEvent(QMouseEvent *event) override {
         if (event->button() == Qt::LeftButton) {
@@ -338,17 +329,19 @@ protected:
             mimeData->setText(QString("%1:%2").arg(shipId).arg(0));
             drag->setMimeData(mimeData);
 
-            QPixmap pixmap(size * 30, 30);
-            pixmap.fill(Qt::transparent);
-            QPainter p(&pixmap);
-            BoardWidget::drawShipShape(p, size, Orientation::Horizontal, QRect(0,0,size*30,30), false, false);
-            p.end();
-
-            drag->setPixmap(pixmap);
+            drag->setPixmap(shipSprite());
             drag->setHotSpot(QPoint(15, 15));
             if (drag->exec(Qt::MoveAction) == Qt::MoveAction) this->hide();
         }
     }
+private:
+    QPixmap sprite; // Рисуется один раз (и заново при смене DPR экрана)
+    QPixmap shipSprite() {
+        if (sprite.isNull() || sprite.devicePixelRatio() != devicePixelRatioF()) {
+            sprite = BoardWidget::renderShipSprite(size, Orientation::Horizontal, false, false, 30, devicePixelRatioF());
+        }
+        return sprite;
+    }
 };
 
 // --- GameWindow ---
@@ -361,11 +354,9 @@ GameWindow::GameWindow(const QString &playerAvatarPath, QWidget *parent)
     setMouseTracking(true);
     this->installEventFilter(this);
 
-    shakeTimer = new QTimer(this);
-    shakeTimer->setInterval(30);
-    connect(shakeTimer, &QTimer::timeout, this, &GameWindow::updateShake);
-
-    initShips();
+    // Ход бота-эксперта считается в пуле потоков, в GUI-поток приходит через очередь событий
+    mcBot = new MonteCarloBot(this);
+    connect(mcBot, &MonteCarloBot::moveReady, this, &GameWindow::onBotMoveReady, Qt::QueuedConnection);
 
     hitPhrases << "БАБАХ!" << "ПОЛУЧИ!" << "В ЯБЛОЧКО!" << "ЕСТЬ ПРОБИТИЕ!" << "ХА-ХА!";
     killPhrases << "НА ДНО!" << "БУЛЬ-БУЛЬ!" << "КОРМ ДЛЯ РЫБ!" << "МИНУС ОДИН!" << "ПРОЩАЙ!";
@@ -379,8 +370,8 @@ GameWindow::GameWindow(const QString &playerAvatarPath, QWidget *parent)
 }
 
 GameWindow::~GameWindow() {
-    qDeleteAll(playerShips);
-    qDeleteAll(enemyShips);
+    mcBot->cancel();
+    delete recorder;
 }
 
 QString GameWindow::getRandomPhrase(const QStringList &list) {
@@ -445,64 +436,6 @@ void GameWindow::paintEvent(QPaintEvent *)
     }
 }
 
-void GameWindow::initShips() {
-    int id = 0;
-    auto createFleet = [&](QVector<Ship*>& fleet) {
-        fleet.push_back(new Ship(id++, 4));
-        fleet.push_back(new Ship(id++, 3));
-        fleet.push_back(new Ship(id++, 3));
-        fleet.push_back(new Ship(id++, 2));
-        fleet.push_back(new Ship(id++, 2));
-        fleet.push_back(new Ship(id++, 2));
-        fleet.push_back(new Ship(id++, 1));
-        fleet.push_back(new Ship(id++, 1));
-        fleet.push_back(new Ship(id++, 1));
-        fleet.push_back(new Ship(id++, 1));
-    };
-    createFleet(playerShips);
-    createFleet(enemyShips);
-}
-
-void GameWindow::addInitialTargets(int x, int y) {
-    int dx[] = {-1, 1, 0, 0};
-    int dy[] = {0, 0, -1, 1};
-    for(int i=0; i<4; ++i) {
-        int nx = x + dx[i];
-        int ny = y + dy[i];
-        if (nx >= 0 && nx < 10 && ny >= 0 && ny < 10) enemyTargetQueue.append(QPoint(nx, ny));
-    }
-}
-
-void GameWindow::determineNextTargetLine() {
-    if (shipHitPoints.size() < 2) return;
-    QPoint p1 = shipHitPoints.first();
-    QPoint p2 = shipHitPoints.last();
-    bool isHorizontal = (p1.y() == p2.y());
-    bool isVertical = (p1.x() == p2.x());
-
-    if (isHorizontal) {
-        int y = p1.y();
-        int minX = 10, maxX = -1;
-        for(const auto& p : shipHitPoints) {
-            if (p.x() < minX) minX = p.x();
-            if (p.x() > maxX) maxX = p.x();
-        }
-        enemyTargetQueue.clear();
-        enemyTargetQueue.append(QPoint(minX - 1, y));
-        enemyTargetQueue.append(QPoint(maxX + 1, y));
-    } else if (isVertical) {
-        int x = p1.x();
-        int minY = 10, maxY = -1;
-        for(const auto& p : shipHitPoints) {
-            if (p.y() < minY) minY = p.y();
-            if (p.y() > maxY) maxY = p.y();
-        }
-        enemyTargetQueue.clear();
-        enemyTargetQueue.append(QPoint(x, minY - 1));
-        enemyTargetQueue.append(QPoint(x, maxY + 1));
-    }
-}
-
 void GameWindow::setupUI() {
     QVBoxLayout *globalLayout = new QVBoxLayout(this);
     globalLayout->setContentsMargins(0, 0, 0, 0);
@@ -554,7 +487,7 @@ void GameWindow::setupUI() {
     playerTitle->setStyleSheet("font-weight: bold; color: #333; font-size: 18px; margin-bottom: 5px;");
 
     playerBoard = new BoardWidget(this);
-    playerBoard->setShips(playerShips);
+    playerBoard->setShips(fleets.player(), FLEET_SHIP_COUNT);
     playerBoard->setEditable(true);
     playerBoard->setShowShips(true);
     playerBoard->setupSizePolicy();
@@ -594,8 +527,9 @@ void GameWindow::setupUI() {
     shipsSetupPanel = new QWidget();
     QVBoxLayout *shipsLayout = new QVBoxLayout(shipsSetupPanel);
     shipsLayout->setSpacing(5);
-    for (Ship* s : playerShips) {
-        DraggableShipLabel *shipLabel = new DraggableShipLabel(s->id, s->size);
+    for (int i = 0; i < FLEET_SHIP_COUNT; ++i) {
+        const Ship &s = fleets.player()[i];
+        DraggableShipLabel *shipLabel = new DraggableShipLabel(s.id, s.size);
         shipsLayout->addWidget(shipLabel, 0, Qt::AlignCenter);
     }
 
@@ -608,6 +542,15 @@ void GameWindow::setupUI() {
         );
     connect(randomPlaceBtn, &QPushButton::clicked, this, &GameWindow::onRandomPlaceClicked);
 
+    difficultyBtn = new QPushButton("БОТ: ОБЫЧНЫЙ");
+    difficultyBtn->setMinimumHeight(40);
+    difficultyBtn->setCursor(Qt::PointingHandCursor);
+    difficultyBtn->setStyleSheet(
+        "QPushButton { background-color: #8e44ad; color: white; font-size: 16px; font-weight: bold; border: 2px solid #6c3483; }"
+        "QPushButton:hover { background-color: #a569bd; }"
+        );
+    connect(difficultyBtn, &QPushButton::clicked, this, &GameWindow::onDifficultyClicked);
+
     startBattleBtn = new QPushButton("В БОЙ!");
     startBattleBtn->setMinimumHeight(50);
     startBattleBtn->setCursor(Qt::PointingHandCursor);
@@ -659,6 +602,7 @@ void GameWindow::setupUI() {
     centerLayout->addWidget(infoLabel);
     centerLayout->addWidget(shipsSetupPanel);
     centerLayout->addWidget(randomPlaceBtn);
+    centerLayout->addWidget(difficultyBtn);
     centerLayout->addWidget(startBattleBtn);
     centerLayout->addWidget(battlePanel);
     centerLayout->addStretch();
@@ -680,7 +624,7 @@ void GameWindow::setupUI() {
     enemyTitle->setStyleSheet("font-weight: bold; color: #333; font-size: 18px; margin-bottom: 5px;");
 
     enemyBoard = new BoardWidget(this);
-    enemyBoard->setShips(enemyShips);
+    enemyBoard->setShips(fleets.enemy(), FLEET_SHIP_COUNT);
     enemyBoard->setEnemy(true);
     enemyBoard->setEditable(false);
     enemyBoard->setShowShips(false);
@@ -716,6 +660,13 @@ void GameWindow::onRandomPlaceClicked() {
     }
 }
 
+void GameWindow::onDifficultyClicked() {
+    botLevel = BotLevel((botLevel + 1) % 3);
+    if (botLevel == BotNormal) difficultyBtn->setText("БОТ: ОБЫЧНЫЙ");
+    else if (botLevel == BotHard) difficultyBtn->setText("БОТ: СЛОЖНЫЙ");
+    else difficultyBtn->setText("БОТ: ЭКСПЕРТ");
+}
+
 void GameWindow::onExitToMenuClicked()
 {
     emit backToMenu();
@@ -724,6 +675,7 @@ void GameWindow::onExitToMenuClicked()
 
 void GameWindow::updateTurnVisuals() {
     if (isGameOver) return;
+    if (recorder && isBattleStarted) recorder->turn(isPlayerTurn ? 1 : 2);
     if (isPlayerTurn) {
         playerAvatar->setStyleSheet("border: 2px solid yellow;");
         enemyAvatar->setStyleSheet("border: none;");
@@ -740,14 +692,25 @@ void GameWindow::updateTurnVisuals() {
 }
 
 void GameWindow::onStartBattleClicked() {
-    for(auto s : playerShips) {
-        if(!s->isPlaced()) {
+    for (int i = 0; i < FLEET_SHIP_COUNT; ++i) {
+        if (!fleets.player()[i].isPlaced()) {
             QMessageBox::warning(this, "Внимание", "Расставьте флот!");
             return;
         }
     }
 
-    if(!enemyBoard->autoPlaceShips()) enemyBoard->autoPlaceShips();
+    quint32 seed = QRandomGenerator::global()->generate();
+    matchRng.seed(seed);
+    enemyBoard->autoPlaceShips(FleetPlacer::Uniform, &matchRng);
+
+    delete recorder;
+    recorder = new MatchRecorder(MatchLog::ModeSingle, seed);
+    recorder->fleet(1, playerBoard->model());
+    recorder->fleet(2, enemyBoard->model());
+
+    queueBot.reset(FLEET_SIZES, FLEET_SHIP_COUNT);
+    densityBot.reset(FLEET_SIZES, FLEET_SHIP_COUNT);
+    mcBot->reset(FLEET_SIZES, FLEET_SHIP_COUNT);
 
     centerWidget->setVisible(false);
 
@@ -763,6 +726,7 @@ void GameWindow::startGameAfterRPS(bool playerFirst) {
     shipsSetupPanel->hide();
     startBattleBtn->hide();
     randomPlaceBtn->hide();
+    difficultyBtn->hide();
     battlePanel->show();
 
     resetMana();
@@ -803,23 +767,22 @@ void GameWindow::activateFog() {
     addMana(-60);
     playerBoard->setFog(true); // Визуальный туман на поле игрока
     playerMessage->showMessage("ТУМАН!");
+    if (recorder) recorder->ability(1, 1);
 }
 
 void GameWindow::activateRadar() {
-    // Ищем живой корабль врага
+    // Ищем живой корабль врага: клетки с кораблем, которые еще не подбиты
+    const BoardModel &enemyModel = enemyBoard->model();
+    Bitboard alive = enemyModel.shipsMask() & ~enemyModel.hits();
     QVector<QPoint> possibleCells;
-    for(int x=0; x<10; ++x) {
-        for(int y=0; y<10; ++y) {
-            // Клетка с кораблем, которая еще не подбита (не Hit)
-            if (enemyBoard->hasShipAt(x, y) && enemyBoard->getCellState(x, y) != Hit) {
-                possibleCells.append(QPoint(x, y));
-            }
-        }
+    for (int idx = alive.popFirst(); idx >= 0; idx = alive.popFirst()) {
+        possibleCells.append(QPoint(idx % 10, idx / 10));
     }
 
     if (!possibleCells.isEmpty()) {
-        int idx = QRandomGenerator::global()->bounded(possibleCells.size());
+        int idx = matchRng.bounded(int(possibleCells.size()));
         radarCell = possibleCells[idx];
+        if (recorder) recorder->ability(1, 2, radarCell);
 
         isRadarActive = true;
         addMana(-80);
@@ -853,11 +816,12 @@ void GameWindow::onPlayerBoardClick(int x, int y) {
         // Запуск серии ударов
         isClusterMode = false; // Режим одноразовый
         isClusterExecuting = true;
-        clusterQueue.clear();
         clusterHitsCount = 0;
+        if (recorder) recorder->ability(1, 3, QPoint(x, y));
 
         // Центр
-        clusterQueue.append(QPoint(x, y));
+        QVector<QPoint> salvo;
+        salvo.append(QPoint(x, y));
         // Вокруг (8 клеток)
         int dx[] = {-1, 0, 1, -1, 1, -1, 0, 1};
         int dy[] = {-1, -1, -1, 0, 0, 1, 1, 1};
@@ -868,13 +832,15 @@ void GameWindow::onPlayerBoardClick(int x, int y) {
             // Добавляем, даже если там уже стреляли (для красоты анимации),
             // но важно проверять границы
             if (nx >= 0 && nx < 10 && ny >= 0 && ny < 10) {
-                clusterQueue.append(QPoint(nx, ny));
+                salvo.append(QPoint(nx, ny));
             }
         }
 
+        // Весь залп летит одновременно, итог — когда долетит последняя ракета
         isAnimating = true;
         enemyBoard->setActive(false);
-        processClusterShot();
+        clusterPending = salvo.size();
+        enemyBoard->animateSalvo(salvo);
     } else {
         // Обычный выстрел
         isAnimating = true;
@@ -883,32 +849,24 @@ void GameWindow::onPlayerBoardClick(int x, int y) {
     }
 }
 
-void GameWindow::processClusterShot() {
-    if (clusterQueue.isEmpty()) {
-        // Серия закончена
-        isClusterExecuting = false;
-        isAnimating = false;
+void GameWindow::finishClusterStrike() {
+    // Серия закончена
+    isClusterExecuting = false;
+    isAnimating = false;
 
-        // Если было хотя бы одно попадание - продолжаем ход
-        if (clusterHitsCount > 0) {
-            playerMessage->showMessage("СЕРИЯ: УСПЕХ!");
-            enemyBoard->setActive(true);
-            checkGameStatus();
-        } else {
-            // Иначе промах
-            playerMessage->showMessage(getRandomPhrase(missPhrases));
-            addMana(20);
-            isPlayerTurn = false;
-            updateTurnVisuals();
-            QTimer::singleShot(800, this, &GameWindow::enemyTurn);
-        }
-        return;
+    // Если было хотя бы одно попадание - продолжаем ход
+    if (clusterHitsCount > 0) {
+        playerMessage->showMessage("СЕРИЯ: УСПЕХ!");
+        enemyBoard->setActive(true);
+        checkGameStatus();
+    } else {
+        // Иначе промах
+        playerMessage->showMessage(getRandomPhrase(missPhrases));
+        addMana(20);
+        isPlayerTurn = false;
+        updateTurnVisuals();
+        QTimer::singleShot(800, this, &GameWindow::enemyTurn);
     }
-
-    QPoint target = clusterQueue.takeFirst();
-    // Запускаем анимацию следующего выстрела
-    // Даже если там уже стреляли, animateShot отработает, а receiveShot вернет -1
-    enemyBoard->animateShot(target.x(), target.y());
 }
 
 void GameWindow::onMissileImpact(int x, int y, bool isHit) {
@@ -917,6 +875,7 @@ void GameWindow::onMissileImpact(int x, int y, bool isHit) {
 
     int res = targetBoard->receiveShot(x, y);
     // res: -1 (already), 0 (miss), 1 (hit), 2 (kill)
+    if (recorder) recorder->shot(targetBoard == enemyBoard ? 1 : 2, x, y, res);
 
     if (res > 0) shakeScreen();
 
@@ -924,9 +883,9 @@ void GameWindow::onMissileImpact(int x, int y, bool isHit) {
     if (targetBoard == enemyBoard) {
 
         if (isClusterExecuting) {
+            // Даже если там уже стреляли, ракета долетает, а receiveShot вернет -1
             if (res > 0) clusterHitsCount++;
-            // Рекурсивный вызов следующего выстрела с небольшой задержкой
-            QTimer::singleShot(150, this, &GameWindow::processClusterShot);
+            if (--clusterPending == 0) finishClusterStrike();
             return;
         }
 
@@ -952,6 +911,10 @@ void GameWindow::onMissileImpact(int x, int y, bool isHit) {
     }
     // --- ЛОГИКА БОТА ---
     else if (targetBoard == playerBoard) {
+        queueBot.onShotResult(x, y, res);
+        densityBot.onShotResult(x, y, res);
+        mcBot->onShotResult(x, y, res);
+
         if (res == 0 || res == -1) { // Промах (или удар в уже битую клетку из-за тумана)
             enemyMessage->showMessage(getRandomPhrase(missPhrases));
 
@@ -966,17 +929,7 @@ void GameWindow::onMissileImpact(int x, int y, bool isHit) {
             updateTurnVisuals();
         } else if (res > 0) { // Попал
             if (res == 1) enemyMessage->showMessage(getRandomPhrase(hitPhrases));
-            if (res == 2) {
-                enemyMessage->showMessage(getRandomPhrase(killPhrases));
-                enemyTargetQueue.clear();
-                shipHitPoints.clear();
-            } else {
-                if (res == 1) {
-                    shipHitPoints.append(QPoint(x, y));
-                    if (shipHitPoints.size() == 1) addInitialTargets(x, y);
-                    else determineNextTargetLine();
-                }
-            }
+            if (res == 2) enemyMessage->showMessage(getRandomPhrase(killPhrases));
             checkGameStatus();
             if(!isGameOver) QTimer::singleShot(1500, this, &GameWindow::enemyTurn);
         }
@@ -1007,37 +960,29 @@ void GameWindow::enemyTurn() {
 
     int x, y;
     bool valid = false;
-    int attempts = 0;
 
     // --- ЛОГИКА ТУМАНА ---
     if (isFogActive) {
         // Бот стреляет абсолютно случайно, может попасть в уже битую клетку
         // Он "забыл" карту
-        x = QRandomGenerator::global()->bounded(10);
-        y = QRandomGenerator::global()->bounded(10);
+        x = matchRng.bounded(10);
+        y = matchRng.bounded(10);
         // Мы НЕ проверяем canShootAt, так как он не видит старых выстрелов
         valid = true;
     }
-    // --- ОБЫЧНАЯ ЛОГИКА ---
+    // --- ЭКСПЕРТ: расчет в пуле потоков, выстрел придет в onBotMoveReady ---
+    else if (botLevel == BotExpert) {
+        mcBot->requestMove();
+        return;
+    }
+    // --- ОБЫЧНЫЙ (очередь добивания) или СЛОЖНЫЙ (карта плотности) ---
     else {
-        while (!valid && attempts < 100) {
-            attempts++;
-            if (!enemyTargetQueue.isEmpty()) {
-                QPoint target = enemyTargetQueue.first();
-                x = target.x(); y = target.y();
-                if (x < 0 || x > 9 || y < 0 || y > 9 || !playerBoard->canShootAt(x, y)) {
-                    enemyTargetQueue.removeFirst();
-                    continue;
-                }
-            } else {
-                x = QRandomGenerator::global()->bounded(10);
-                y = QRandomGenerator::global()->bounded(10);
-            }
-
-            if (playerBoard->canShootAt(x, y)) {
-                valid = true;
-                if (!enemyTargetQueue.isEmpty()) enemyTargetQueue.removeFirst();
-            }
+        Shooter *bot = (botLevel == BotHard) ? static_cast<Shooter *>(&densityBot) : &queueBot;
+        int cell = bot->nextShot(matchRng);
+        if (cell >= 0) {
+            x = cell % 10;
+            y = cell / 10;
+            valid = true;
         }
     }
 
@@ -1050,11 +995,21 @@ void GameWindow::enemyTurn() {
     }
 }
 
+void GameWindow::onBotMoveReady(int x, int y) {
+    // Пока считали, игра могла закончиться или ход смениться
+    if (isPlayerTurn || !isBattleStarted || isGameOver) return;
+    if (!playerBoard->canShootAt(x, y)) {
+        mcBot->requestMove();
+        return;
+    }
+    playerBoard->animateShot(x, y);
+}
+
 void GameWindow::shakeScreen() {
     if (shakeFrames > 0) return;
     originalPos = this->pos();
     shakeFrames = 10;
-    shakeTimer->start();
+    AnimationClock::instance()->repeat(this, AnimationClock::SHAKE_MS, [this]() { updateShake(); });
 }
 
 void GameWindow::updateShake() {
@@ -1065,7 +1020,7 @@ void GameWindow::updateShake() {
         shakeFrames--;
     } else {
         this->move(originalPos);
-        shakeTimer->stop();
+        AnimationClock::instance()->stop(this);
     }
 }
 
@@ -1077,6 +1032,8 @@ void GameWindow::checkGameStatus() {
 void GameWindow::endGame(bool playerWon) {
     isGameOver = true;
     isBattleStarted = false;
+    mcBot->cancel();
+    if (recorder) recorder->end(playerWon ? 1 : 2);
     enemyBoard->setShowShips(true);
     enemyBoard->update();
     enemyBoard->setEnabled(false);
@@ -1085,6 +1042,7 @@ void GameWindow::endGame(bool playerWon) {
     shipsSetupPanel->hide();
     startBattleBtn->hide();
     randomPlaceBtn->hide();
+    difficultyBtn->hide();
     battlePanel->hide();
 
     infoLabel->show();
@@ -8,7 +8,12 @@
 #include <QPoint>
 #include <QTimer>
 #include <QPixmap>
+#include <QRandomGenerator>
 #include "boardwidget.h"
+#include "queuebot.h"
+#include "densitybot.h"
+#include "montecarlobot.h"
+#include "matchrecorder.h"
 #include "RPSWidget.h"
 
 // Классы-помощники
@@ -35,7 +40,7 @@ private slots:
 protected:
     QSize sizeHint() const override { return QSize(160, 60); }
 private:
-    QTimer *hideTimer;
+    QTimer *hideTimer; // Разовая задержка скрытия: кадры AnimationClock тут не нужны
 };
 
 // Шкала маны
@@ -55,7 +60,6 @@ private slots:
 
 private:
     int currentMana;
-    QTimer *shakeTimer;
     QPoint shakeOffset;
 };
 
@@ -90,7 +94,6 @@ private:
 
     // Новые поля для иконки и анимации
     QPixmap iconPixmap;
-    QTimer *shakeTimer;
     QPoint shakeOffset;
 };
 
@@ -115,6 +118,7 @@ private slots:
     void startGameAfterRPS(bool playerFirst);
 
     void onRandomPlaceClicked();
+    void onDifficultyClicked();
     void onPlayerBoardClick(int x, int y);
     void onMissileImpact(int x, int y, bool isHit);
 
@@ -124,10 +128,11 @@ private slots:
     void activateRadar();
     void activateCluster();
 
-    // Обработка очереди выстрелов для кластера
-    void processClusterShot();
+    // Итог залпа кластера (после попадания последней ракеты)
+    void finishClusterStrike();
 
     void enemyTurn();
+    void onBotMoveReady(int x, int y);
     void onFinishGameClicked();
     void onExitToMenuClicked();
     void updateShake();
@@ -143,6 +148,7 @@ private:
     QWidget *shipsSetupPanel;
     QPushButton *startBattleBtn;
     QPushButton *randomPlaceBtn;
+    QPushButton *difficultyBtn;
 
     // Панель боя
     QWidget *battlePanel;
@@ -160,8 +166,7 @@ private:
 
     QPushButton *exitToMenuBtn;
 
-    QVector<Ship*> playerShips;
-    QVector<Ship*> enemyShips;
+    MatchFleets fleets; // Корабли обеих сторон одним массивом прямо в окне (окно — одна партия)
     bool isPlayerTurn;
     bool isBattleStarted;
     bool isGameOver;
@@ -181,12 +186,20 @@ private:
 
     bool isClusterMode = false;
     bool isClusterExecuting = false;
-    QList<QPoint> clusterQueue;
+    int clusterPending = 0;   // Ракет залпа, еще не долетевших
     int clusterHitsCount = 0; // Для подсчета попаданий в серии
     // ----------------------------
 
-    QList<QPoint> enemyTargetQueue;
-    QList<QPoint> shipHitPoints;
+    // Уровень бота: обычный (очередь целей), сложный (карта плотности), эксперт (Монте-Карло)
+    enum BotLevel { BotNormal, BotHard, BotExpert };
+    BotLevel botLevel = BotNormal;
+    QueueBot queueBot;
+    DensityBot densityBot;
+    MonteCarloBot *mcBot;
+
+    // Случайность партии (расстановка бота, его выстрелы, радар) — от seed, который попадает в запись
+    QRandomGenerator matchRng;
+    MatchRecorder *recorder = nullptr;
 
     QPoint mousePos;
 
@@ -195,16 +208,11 @@ private:
     QStringList missPhrases;
 
     // Тряска экрана
-    QTimer *shakeTimer;
     QPoint originalPos;
     int shakeFrames = 0;
     void shakeScreen();
 
-    void addInitialTargets(int x, int y);
-    void determineNextTargetLine();
-
     void setupUI();
-    void initShips();
     void checkGameStatus();
     void endGame(bool playerWon);
     void updateTurnVisuals();
@@ -0,0 +1,211 @@
+#include "headlessplayer.h"
+#include "fleetplacer.h"
+#include <QTimer>
+
+HeadlessPlayer::HeadlessPlayer(NetworkClient *client, std::unique_ptr<Shooter> shooter, quint64 seed, QObject *parent)
+    : QObject(parent), client(client), shooter(std::move(shooter)), rng(seed)
+{
+    board.setFleet(FLEET_SIZES, FLEET_SHIP_COUNT);
+    clock.start();
+
+    connect(client, &NetworkClient::connected, this, [this]() { sendPendingAction(); });
+    connect(client, &NetworkClient::lobbyCreated, this, [this](const QString &gameId) {
+        emit actionTimed(ActionLobby, (clock.nsecsElapsed() - lobbySentNs) / 1000);
+        emit gameCreated(gameId);
+    });
+    connect(client, &NetworkClient::playerJoined, this, [this]() { startGame(); });
+    connect(client, &NetworkClient::joinedLobby, this, [this]() {
+        emit actionTimed(ActionLobby, (clock.nsecsElapsed() - lobbySentNs) / 1000);
+        startGame();
+    });
+    connect(client, &NetworkClient::opponentReady, this, &HeadlessPlayer::onOpponentReady);
+    connect(client, &NetworkClient::opponentRPS, this, &HeadlessPlayer::onOpponentRps);
+    connect(client, &NetworkClient::turnChanged, this, &HeadlessPlayer::onTurnChanged);
+    connect(client, &NetworkClient::fireResultReceived, this, &HeadlessPlayer::onFireResult);
+    connect(client, &NetworkClient::opponentFired, this, &HeadlessPlayer::onOpponentFired);
+    connect(client, &NetworkClient::opponentShotResolved, this, &HeadlessPlayer::onOpponentShotResolved);
+    connect(client, &NetworkClient::opponentFiredBatch, this, &HeadlessPlayer::onOpponentFiredBatch);
+    connect(client, &NetworkClient::gameError, this, [this](const QString &message) { fail(message); });
+    connect(client, &NetworkClient::errorOccurred, this, [this](const QString &message) { fail(message); });
+    connect(client, &NetworkClient::disconnected, this, [this]() { fail("Соединение закрыто"); });
+}
+
+void HeadlessPlayer::setThinkTime(int minMs, int maxMs) {
+    thinkMinMs = qMax(0, minMs);
+    thinkMaxMs = qMax(thinkMinMs, maxMs);
+}
+
+void HeadlessPlayer::host(const QString &gameName) {
+    isHost = true;
+    pendingAction = "create";
+    pendingArgument = gameName;
+    if (client->isConnected()) sendPendingAction();
+}
+
+void HeadlessPlayer::join(const QString &gameId) {
+    isHost = false;
+    pendingAction = "join";
+    pendingArgument = gameId;
+    if (client->isConnected()) sendPendingAction();
+}
+
+void HeadlessPlayer::sendPendingAction() {
+    lobbySentNs = clock.nsecsElapsed();
+    if (pendingAction == "create") client->createLobby(pendingArgument);
+    else if (pendingAction == "join") client->joinLobby(pendingArgument);
+    pendingAction.clear();
+}
+
+// Без паузы действие выполняется сразу, и ход партии тот же, что до появления пауз
+void HeadlessPlayer::think(const std::function<void()> &action) {
+    if (thinkMaxMs <= 0) {
+        action();
+        return;
+    }
+    QTimer::singleShot(thinkMinMs + int(rng.bounded(thinkMaxMs - thinkMinMs + 1)), this, action);
+}
+
+void HeadlessPlayer::startGame() {
+    if (gameStarted) return;
+    gameStarted = true;
+    think([this]() { sendReady(); });
+}
+
+// Соперник на месте: расстановка и ready, как по кнопке "Готов"
+void HeadlessPlayer::sendReady() {
+    if (finished) return;
+    FleetPlacer::placeFleet(board, rng);
+    shooter->reset(FLEET_SIZES, FLEET_SHIP_COUNT);
+    enemyCellsLeft = 0;
+    for (int size : FLEET_SIZES) enemyCellsLeft += size;
+
+    QVector<NetworkClient::FleetShip> fleet;
+    for (int slot = 0; slot < board.shipCount(); ++slot) {
+        Bitboard mask = board.shipMaskOf(slot);
+        int bow = mask.first();
+        int size = mask.count();
+        fleet.append({bow % 10, bow / 10, size, size > 1 && mask.test(bow + 10)});
+    }
+    iAmReady = true;
+    client->sendReady(fleet);
+    if (opponentReady) playRps();
+}
+
+void HeadlessPlayer::onOpponentReady() {
+    opponentReady = true;
+    if (iAmReady) playRps();
+}
+
+void HeadlessPlayer::playRps() {
+    think([this]() {
+        if (finished) return;
+        myRps = 1 + int(rng.bounded(3));
+        rpsRounds++;
+        client->sendRPS(myRps);
+        if (opponentRps) onOpponentRps(opponentRps);
+    });
+}
+
+void HeadlessPlayer::onOpponentRps(int shape) {
+    opponentRps = shape;
+    if (!myRps) return;
+    // Ход назначит сервер сообщением turn_change; при ничьей обе стороны переигрывают раунд
+    bool tie = myRps == opponentRps;
+    myRps = 0;
+    opponentRps = 0;
+    if (tie) playRps();
+}
+
+void HeadlessPlayer::onTurnChanged(const QString &who) {
+    myTurn = (isHost && who == "Player1") || (!isHost && who == "Player2");
+    if (myTurn && !awaitingResult) scheduleFire();
+}
+
+void HeadlessPlayer::scheduleFire() {
+    awaitingResult = true;
+    think([this]() { fire(); });
+}
+
+void HeadlessPlayer::fire() {
+    if (finished) return;
+    int idx = shooter->nextShot(rng);
+    if (idx < 0) {
+        fail("Некуда стрелять");
+        return;
+    }
+    shots++;
+    if (chatInterval && shots % chatInterval == 0) {
+        chats++;
+        client->sendChatMessage(QString("Выстрел %1").arg(shots));
+    }
+    fireSentNs = clock.nsecsElapsed();
+    client->sendFire(idx % 10, idx / 10);
+}
+
+void HeadlessPlayer::onFireResult(int x, int y, int status) {
+    awaitingResult = false;
+    emit actionTimed(ActionFire, (clock.nsecsElapsed() - fireSentNs) / 1000);
+    shooter->onShotResult(x, y, status);
+    if (status == BoardModel::ShotHit || status == BoardModel::ShotKill) {
+        if (--enemyCellsLeft == 0) {
+            finish(true);
+            return;
+        }
+        scheduleFire(); // Попадание — стреляем еще
+        return;
+    }
+    myTurn = false; // Промах: ход перейдет сопернику сообщением turn_change
+}
+
+int HeadlessPlayer::takeShot(int x, int y) {
+    int result = board.receiveShot(x, y);
+    return result < 0 ? int(BoardModel::ShotMiss) : result;
+}
+
+void HeadlessPlayer::onOpponentFired(int x, int y) {
+    int result = takeShot(x, y);
+    client->sendFireResult(x, y, result);
+    if (board.isAllDestroyed()) finish(false);
+}
+
+void HeadlessPlayer::onOpponentShotResolved(int x, int y, int status) {
+    Q_UNUSED(status)
+    takeShot(x, y);
+    if (board.isAllDestroyed()) finish(false);
+}
+
+// Способности у ботов нет, но на залп соперника-человека отвечаем, как окно
+void HeadlessPlayer::onOpponentFiredBatch(int mode, const QVector<QPoint> &cells) {
+    if (mode == WireProtocol::BatchFog) return;
+    QVector<int> results(cells.size(), 0);
+    if (mode == WireProtocol::BatchFire) {
+        for (int i = 0; i < cells.size(); ++i) {
+            int result = board.receiveShot(cells[i].x(), cells[i].y());
+            results[i] = result < 0 ? -1 : result;
+        }
+    } else {
+        Bitboard alive = board.shipsMask() & ~board.hits();
+        for (int i = 0; i < cells.size(); ++i) {
+            if (alive.test(BoardModel::index(cells[i].x(), cells[i].y()))) {
+                results[i] = 1;
+                break;
+            }
+        }
+    }
+    client->sendFireBatchResult(mode, cells, results);
+    if (board.isAllDestroyed()) finish(false);
+}
+
+void HeadlessPlayer::finish(bool playerWon) {
+    if (finished) return;
+    finished = true;
+    won = playerWon;
+    client->endMatch();
+    emit matchFinished(won);
+}
+
+void HeadlessPlayer::fail(const QString &reason) {
+    if (finished) return;
+    finished = true;
+    emit matchFailed(reason);
+}
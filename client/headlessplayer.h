@@ -0,0 +1,101 @@
+#ifndef HEADLESSPLAYER_H
+#define HEADLESSPLAYER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <functional>
+#include <memory>
+#include "boardmodel.h"
+#include "networkclient.h"
+#include "shooter.h"
+
+// Игрок без окна: ведет NetworkClient через всю партию по тому же протоколу, что MultiplayerGameWindow —
+// лобби, расстановка и ready, К-Н-Б до победителя, выстрелы по ходу от сервера, ответы на выстрелы
+// соперника. Клетки выбирает Shooter (бот или ScriptedShooter), все случайное — от seed.
+// Работает поверх любого канала: LoopbackServer внутри процесса или настоящий сервер.
+// По умолчанию ходит сразу; для нагрузки на сервер — с паузой "на подумать" и чатом, как человек.
+class HeadlessPlayer : public QObject
+{
+    Q_OBJECT
+public:
+    HeadlessPlayer(NetworkClient *client, std::unique_ptr<Shooter> shooter, quint64 seed, QObject *parent = nullptr);
+
+    // Создать игру или войти в нее. Можно до подключения: запрос уйдет, как только оно состоится.
+    void host(const QString &gameName);
+    void join(const QString &gameId);
+
+    // Пауза перед своими действиями (ready, К-Н-Б, выстрел) — случайная в [minMs, maxMs], 0 — без паузы
+    void setThinkTime(int minMs, int maxMs);
+    // Сообщение в чат после каждого shots-го своего выстрела, 0 — молчать
+    void setChatInterval(int shots) { chatInterval = qMax(0, shots); }
+
+    // Действия с ответом сервера, время которых сообщает actionTimed
+    enum Action {
+        ActionLobby, // create_game/join_game -> game_created/game_joined
+        ActionFire   // fire -> fire_result
+    };
+
+    bool isFinished() const { return finished; }
+    bool hasWon() const { return won; }
+    int getShots() const { return shots; }
+    int getRpsRounds() const { return rpsRounds; }
+    int getChats() const { return chats; }
+
+signals:
+    void gameCreated(const QString &gameId); // Хозяину: можно звать второго игрока
+    void matchFinished(bool won);
+    void matchFailed(const QString &reason);
+    void actionTimed(HeadlessPlayer::Action action, qint64 us);
+
+private:
+    NetworkClient *client;
+    std::unique_ptr<Shooter> shooter;
+    QRandomGenerator rng;
+    BoardModel board;
+
+    QElapsedTimer clock;
+    int thinkMinMs = 0;
+    int thinkMaxMs = 0;
+    int chatInterval = 0;
+
+    bool isHost = false;
+    QString pendingAction;   // create/join до подключения
+    QString pendingArgument;
+    qint64 lobbySentNs = 0;
+    bool gameStarted = false; // ready уже отправлен или ждет паузы
+    bool iAmReady = false;
+    bool opponentReady = false;
+    int myRps = 0;
+    int opponentRps = 0;
+    bool myTurn = false;
+    bool awaitingResult = false; // Выстрел отправлен или ждет паузы
+    qint64 fireSentNs = 0;
+    int enemyCellsLeft = 0;
+    int shots = 0;
+    int rpsRounds = 0;
+    int chats = 0;
+    bool finished = false;
+    bool won = false;
+
+    void sendPendingAction();
+    void think(const std::function<void()> &action);
+    void startGame();
+    void sendReady();
+    void playRps();
+    void scheduleFire();
+    void fire();
+    int takeShot(int x, int y);
+    void finish(bool playerWon);
+    void fail(const QString &reason);
+
+    void onOpponentReady();
+    void onOpponentRps(int shape);
+    void onTurnChanged(const QString &who);
+    void onFireResult(int x, int y, int status);
+    void onOpponentFired(int x, int y);
+    void onOpponentShotResolved(int x, int y, int status);
+    void onOpponentFiredBatch(int mode, const QVector<QPoint> &cells);
+};
+
+#endif // HEADLESSPLAYER_H
@@ -0,0 +1,120 @@
+#include "latencystats.h"
+
+#include <algorithm>
+#include <cstring>
+
+void LatencyStats::clear()
+{
+    ringPos = 0;
+    ringCount = 0;
+    std::memset(histogram, 0, sizeof(histogram));
+    samples = 0;
+    lost = 0;
+    last = 0;
+    maxRtt = 0;
+    jitter = 0;
+    hasLast = false;
+}
+
+int LatencyStats::bucketOf(std::uint32_t us)
+{
+    if (us < 16) return int(us);
+    int exponent = 31;
+    while (!(us >> exponent)) --exponent;
+    // Старший бит задает степень двойки, следующие три — ячейку внутри нее
+    return 16 + (exponent - 4) * 8 + int((us >> (exponent - 3)) & 7);
+}
+
+std::uint32_t LatencyStats::bucketValue(int bucket)
+{
+    if (bucket < 16) return std::uint32_t(bucket);
+    int exponent = (bucket - 16) / 8 + 4;
+    std::uint32_t step = 1u << (exponent - 3);
+    return (1u << exponent) + std::uint32_t((bucket - 16) % 8) * step + step / 2;
+}
+
+void LatencyStats::addSample(std::uint32_t rttUs)
+{
+    if (rttUs == LOST) --rttUs;
+    ring[ringPos] = rttUs;
+    ringPos = (ringPos + 1) % WINDOW;
+    ringCount = std::min(ringCount + 1, int(WINDOW));
+
+    histogram[bucketOf(rttUs)]++;
+    ++samples;
+    maxRtt = std::max(maxRtt, rttUs);
+    if (hasLast) {
+        std::uint32_t delta = rttUs > last ? rttUs - last : last - rttUs;
+        jitter = std::uint32_t(std::int64_t(jitter) + (std::int64_t(delta) - std::int64_t(jitter)) / 16);
+    }
+    last = rttUs;
+    hasLast = true;
+}
+
+void LatencyStats::addLoss()
+{
+    ring[ringPos] = LOST;
+    ringPos = (ringPos + 1) % WINDOW;
+    ringCount = std::min(ringCount + 1, int(WINDOW));
+    ++lost;
+}
+
+std::uint32_t LatencyStats::percentile(const std::uint32_t *counts, int total, int percent)
+{
+    if (total == 0) return 0;
+    // Ранг по ближайшему сверху: p50 из двух замеров — первый
+    std::int64_t rank = (std::int64_t(total) * percent + 99) / 100;
+    std::int64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) return bucketValue(i);
+    }
+    return bucketValue(BUCKETS - 1);
+}
+
+LatencyStats::Summary LatencyStats::window() const
+{
+    // Окно маленькое: его гистограмма строится заново на каждый запрос
+    std::uint32_t counts[BUCKETS] = {};
+    Summary s;
+    for (int i = 0; i < ringCount; ++i) {
+        std::uint32_t v = ring[i];
+        if (v == LOST) {
+            ++s.lost;
+            continue;
+        }
+        counts[bucketOf(v)]++;
+        ++s.samples;
+        s.maxUs = std::max(s.maxUs, v);
+    }
+    s.lastUs = last;
+    s.jitterUs = jitter;
+    s.p50Us = std::min(percentile(counts, s.samples, 50), s.maxUs);
+    s.p95Us = std::min(percentile(counts, s.samples, 95), s.maxUs);
+    s.p99Us = std::min(percentile(counts, s.samples, 99), s.maxUs);
+    return s;
+}
+
+LatencyStats::Summary LatencyStats::total() const
+{
+    Summary s;
+    s.samples = samples;
+    s.lost = lost;
+    s.lastUs = last;
+    s.maxUs = maxRtt;
+    s.jitterUs = jitter;
+    // Середина ячейки может оказаться больше самого долгого замера
+    s.p50Us = std::min(percentile(histogram, samples, 50), maxRtt);
+    s.p95Us = std::min(percentile(histogram, samples, 95), maxRtt);
+    s.p99Us = std::min(percentile(histogram, samples, 99), maxRtt);
+    return s;
+}
+
+void LatencyStats::merge(const LatencyStats &other)
+{
+    for (int i = 0; i < BUCKETS; ++i) histogram[i] += other.histogram[i];
+    samples += other.samples;
+    lost += other.lost;
+    maxRtt = std::max(maxRtt, other.maxRtt);
+    jitter = std::max(jitter, other.jitter);
+}
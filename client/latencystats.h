@@ -0,0 +1,62 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <cstdint>
+
+// Задержка соединения по ответам на ping: RTT, джиттер, потери.
+// Два среза: скользящее окно последних WINDOW пингов (для индикатора) и гистограмма за весь
+// матч (для перцентилей в лог). Гистограмма логарифмическая: 8 ячеек на каждую степень двойки,
+// погрешность перцентиля не больше 1/16, память постоянная при любом числе замеров.
+// Без Qt: тот же код использует нагрузочный клиент.
+class LatencyStats
+{
+public:
+    static const int WINDOW = 64;
+    static const int BUCKETS = 16 + (32 - 4) * 8;
+
+    struct Summary {
+        int samples = 0;     // Пришедших ответов
+        int lost = 0;        // Не дождались
+        std::uint32_t lastUs = 0;
+        std::uint32_t p50Us = 0;
+        std::uint32_t p95Us = 0;
+        std::uint32_t p99Us = 0;
+        std::uint32_t maxUs = 0;
+        std::uint32_t jitterUs = 0;
+        int lossPercent() const { return samples + lost ? lost * 100 / (samples + lost) : 0; }
+    };
+
+    LatencyStats() { clear(); }
+    void clear();
+
+    void addSample(std::uint32_t rttUs);
+    void addLoss();
+
+    Summary window() const; // Последние WINDOW пингов
+    Summary total() const;  // С последнего clear()
+
+    // Для сложения гистограмм нескольких соединений
+    void merge(const LatencyStats &other);
+
+    static int bucketOf(std::uint32_t us);
+    static std::uint32_t bucketValue(int bucket); // Середина ячейки
+
+private:
+    static const std::uint32_t LOST = 0xFFFFFFFFu;
+
+    std::uint32_t ring[WINDOW]; // RTT или LOST
+    int ringPos;
+    int ringCount;
+
+    std::uint32_t histogram[BUCKETS];
+    int samples;
+    int lost;
+    std::uint32_t last;
+    std::uint32_t maxRtt;
+    std::uint32_t jitter;       // Сглаженный, как в RTP: j += (|D| - j) / 16
+    bool hasLast;
+
+    static std::uint32_t percentile(const std::uint32_t *counts, int total, int percent);
+};
+
+#endif // LATENCYSTATS_H
@@ -0,0 +1,490 @@
+#include "loopbackserver.h"
+
+namespace {
+
+bool inBoard(int x, int y) {
+    return x >= 0 && x < 10 && y >= 0 && y < 10;
+}
+
+// Камень (1) бьет ножницы (3), ножницы — бумагу (2), бумага — камень
+bool rpsBeats(int a, int b) {
+    return (a == 1 && b == 3) || (a == 3 && b == 2) || (a == 2 && b == 1);
+}
+
+QByteArray rawString(const WireProtocol::JsonValue &value) {
+    return QByteArray(value.data, value.size);
+}
+
+int intField(const char *json, int size, const char *key, int fallback = 0) {
+    WireProtocol::JsonValue value;
+    return WireProtocol::findField(json, size, key, &value) ? WireProtocol::toInt(value, fallback) : fallback;
+}
+
+}
+
+LoopbackServer::LoopbackServer(QObject *parent) : QObject(parent)
+{
+}
+
+LoopbackServer::~LoopbackServer()
+{
+    qDeleteAll(rooms);
+    qDeleteAll(peers);
+}
+
+LoopbackTransport *LoopbackServer::createClientTransport()
+{
+    Peer *peer = new Peer;
+    peer->transport = new LoopbackTransport(this);
+    peer->id = "loop-" + QByteArray::number(++nextId);
+    peers.append(peer);
+
+    LoopbackTransport *client = new LoopbackTransport;
+    client->setPeer(peer->transport);
+    connect(peer->transport, &Transport::readyRead, this, [this, peer]() { onReadyRead(peer); });
+    connect(peer->transport, &Transport::disconnected, this, [this, peer]() { onClosed(peer); });
+    // Клиентский конец удален вместе со своим NetworkClient — серверный больше не понадобится
+    connect(client, &QObject::destroyed, this, [this, peer]() { removePeer(peer); });
+    return client;
+}
+
+void LoopbackServer::removePeer(Peer *peer)
+{
+    if (peer->room) closeRoom(peer->room);
+    peers.removeOne(peer);
+    peer->transport->disconnect(this); // В очереди могут остаться его события, а Peer удаляется сейчас
+    peer->transport->deleteLater();
+    delete peer;
+}
+
+void LoopbackServer::onReadyRead(Peer *peer)
+{
+    while (peer->transport->bytesAvailable() > 0) {
+        int space = 0;
+        char *dst = peer->reader.writeSpace(int(qMin<qint64>(peer->transport->bytesAvailable(), FrameReader::MAX_CAPACITY)),
+                                            &space);
+        if (!dst) {
+            peer->transport->abort();
+            return;
+        }
+        qint64 n = peer->transport->read(dst, space);
+        if (n <= 0) break;
+        peer->reader.commit(int(n));
+        stats.bytesIn += n;
+    }
+
+    // Как у сервера: до hello_ack строки, после согласования бинарного протокола — кадры
+    for (;;) {
+        if (!peer->binary) {
+            const char *line = nullptr;
+            int len = 0;
+            if (!peer->reader.nextLine(&line, &len)) break;
+            stats.messagesIn++;
+            handleJson(peer, line, len);
+        } else {
+            quint8 op = 0;
+            const quint8 *payload = nullptr;
+            int size = 0;
+            int result = peer->reader.nextFrame(&op, &payload, &size);
+            if (result == 0) break;
+            if (result < 0) {
+                peer->transport->abort();
+                return;
+            }
+            stats.messagesIn++;
+            handleFrame(peer, op, payload, size);
+        }
+    }
+}
+
+void LoopbackServer::onClosed(Peer *peer)
+{
+    peer->reader.clear();
+    peer->binary = false;
+    peer->lobbyWatcher = false;
+    if (peer->room) closeRoom(peer->room);
+}
+
+void LoopbackServer::handleJson(Peer *peer, const char *json, int size)
+{
+    WireProtocol::JsonValue action;
+    if (!WireProtocol::findField(json, size, "action", &action) || !action.isString) {
+        sendError(peer, "Ошибка обработки сообщения");
+        return;
+    }
+    WireProtocol::JsonValue value;
+    switch (WireProtocol::messageKey(action.data, action.size)) {
+    case WireProtocol::KeyHello: {
+        bool binary = WireProtocol::findField(json, size, "protocol", &value) && rawString(value) == "binary";
+        sendLine(peer, QByteArray("{\"action\":\"hello_ack\",\"protocol\":\"") + (binary ? "binary" : "json")
+                           + "\",\"version\":" + QByteArray::number(WireProtocol::VERSION) + "}");
+        peer->binary = binary; // Ответ ушел строкой, дальше — кадры
+        break;
+    }
+    case WireProtocol::KeyCreateGame:
+        WireProtocol::findField(json, size, "data", &value);
+        createGame(peer, rawString(value));
+        break;
+    case WireProtocol::KeyJoinGame:
+        WireProtocol::findField(json, size, "gameId", &value);
+        joinGame(peer, rawString(value));
+        break;
+    case WireProtocol::KeyGetGames:
+    case WireProtocol::KeySubscribeLobby: {
+        bool subscribe = WireProtocol::messageKey(action.data, action.size) == WireProtocol::KeySubscribeLobby;
+        if (subscribe) {
+            peer->lobbyWatcher = !peer->room;
+            qint64 version = intField(json, size, "version");
+            if (!peer->lobbyWatcher || (version && version == lobbyVersion)) break; // Клиент и так в курсе
+        }
+        QByteArray list = subscribe ? "{\"action\":\"lobby_snapshot\",\"version\":" + QByteArray::number(lobbyVersion)
+                                        + ",\"games\":["
+                                    : QByteArray("{\"action\":\"games_list\",\"games\":[");
+        bool first = true;
+        for (Room *room : rooms) {
+            if (room->players[1]) continue;
+            if (!first) list += ',';
+            first = false;
+            list += gameJson(room);
+        }
+        sendLine(peer, list + "]}");
+        break;
+    }
+    case WireProtocol::KeyUnsubscribeLobby:
+        peer->lobbyWatcher = false;
+        break;
+    case WireProtocol::KeyPing: {
+        QByteArray pong = "{\"action\":\"pong\"";
+        if (WireProtocol::findField(json, size, "id", &value)) pong += ",\"id\":" + QByteArray::number(WireProtocol::toInt(value));
+        sendLine(peer, pong + "}");
+        break;
+    }
+    case WireProtocol::KeyAck:
+        break; // Сессий нет — нечего подтверждать
+    case WireProtocol::KeyGameEvent: {
+        if (!WireProtocol::findField(json, size, "type", &value) || !value.isString) {
+            sendError(peer, "Ошибка обработки сообщения");
+            break;
+        }
+        WireProtocol::MessageKey type = WireProtocol::messageKey(value.data, value.size);
+        if (type == WireProtocol::KeyFireBatch || type == WireProtocol::KeyBatchResult) {
+            quint8 payload[WireProtocol::batchPayloadSize(WireProtocol::MAX_BATCH, true)];
+            int bytes = WireProtocol::batchFromJson(json, size, payload);
+            if (bytes < 0) sendError(peer, "Некорректный залп");
+            else handleBatch(peer, type == WireProtocol::KeyBatchResult, payload, bytes);
+            break;
+        }
+        int shape = intField(json, size, "value");
+        if (type == WireProtocol::KeyRps && WireProtocol::findField(json, size, "choice", &value))
+            shape = WireProtocol::toInt(value);
+        handleGameEvent(peer, type, intField(json, size, "x", -1), intField(json, size, "y", -1),
+                        type == WireProtocol::KeyRps ? shape : intField(json, size, "value", -1), json, size);
+        break;
+    }
+    default:
+        sendError(peer, "Неизвестное действие");
+        break;
+    }
+}
+
+void LoopbackServer::handleFrame(Peer *peer, quint8 op, const quint8 *payload, int size)
+{
+    switch (op) {
+    case WireProtocol::OpReady:
+        // Расстановку не храним: выстрелы разрешают клиенты
+        handleGameEvent(peer, WireProtocol::KeyReady, 0, 0, 0, nullptr, 0);
+        break;
+    case WireProtocol::OpRps:
+        handleGameEvent(peer, WireProtocol::KeyRps, 0, 0, payload[0], nullptr, 0);
+        break;
+    case WireProtocol::OpFire:
+        handleGameEvent(peer, WireProtocol::KeyFire, payload[0] % 10, payload[0] / 10, 0, nullptr, 0);
+        break;
+    case WireProtocol::OpFireResult:
+        handleGameEvent(peer, WireProtocol::KeyFireResult, payload[0] % 10, payload[0] / 10, payload[1], nullptr, 0);
+        break;
+    case WireProtocol::OpFireBatch:
+    case WireProtocol::OpBatchResult:
+        handleBatch(peer, op == WireProtocol::OpBatchResult, payload, size);
+        break;
+    case WireProtocol::OpPing:
+        sendFrame(peer, WireProtocol::OpPong, payload, size);
+        break;
+    case WireProtocol::OpJson:
+        handleJson(peer, reinterpret_cast<const char *>(payload), size);
+        break;
+    default: // OpAck и смена хода от клиента не нужны
+        break;
+    }
+}
+
+LoopbackServer::Peer *LoopbackServer::opponentOf(Peer *peer, bool report)
+{
+    if (!peer->room) {
+        if (report) sendError(peer, "Вы не в игре");
+        return nullptr;
+    }
+    Peer *other = peer->room->players[1 - peer->seat];
+    if (!other && report) sendError(peer, "Соперник еще не подключился");
+    return other;
+}
+
+// Аргументы: x, y — клетка (fire, fire_result), value — фигура К-Н-Б или результат выстрела
+void LoopbackServer::handleGameEvent(Peer *peer, WireProtocol::MessageKey type, int x, int y, int value,
+                                     const char *json, int size)
+{
+    Peer *other = opponentOf(peer, true);
+    if (!other) return;
+    Room *room = peer->room;
+
+    switch (type) {
+    case WireProtocol::KeyReady:
+        sendEvent(other, WireProtocol::OpReady);
+        break;
+    case WireProtocol::KeyRps:
+        if (value < 1 || value > 3) return;
+        room->rps[peer->seat] = value;
+        sendEvent(other, WireProtocol::OpRps, value);
+        if (room->rps[0] && room->rps[1]) {
+            // Ничья — клиенты переигрывают раунд, победитель ходит первым
+            if (room->rps[0] != room->rps[1]) {
+                room->turn = rpsBeats(room->rps[0], room->rps[1]) ? 1 : 2;
+                sendTurn(room);
+            }
+            room->rps[0] = room->rps[1] = 0;
+        }
+        break;
+    case WireProtocol::KeyFire:
+        if (!inBoard(x, y)) return;
+        if (room->turn != peer->seat + 1) {
+            sendError(peer, "Сейчас не ваш ход");
+            return;
+        }
+        sendEvent(other, WireProtocol::OpFire, x, y, -1);
+        break;
+    case WireProtocol::KeyFireResult:
+        if (!inBoard(x, y) || value < 0 || value > 2) return;
+        sendEvent(other, WireProtocol::OpFireResult, x, y, value);
+        // Промах — ход переходит к тому, по кому стреляли
+        if (value == 0) {
+            room->turn = peer->seat + 1;
+            sendTurn(room);
+        }
+        break;
+    case WireProtocol::KeyTurnChange:
+        break; // Ход считает сервер
+    default:
+        // chat и незнакомые типы — как пришли
+        if (json) sendLine(other, QByteArray(json, size));
+        break;
+    }
+}
+
+void LoopbackServer::handleBatch(Peer *peer, bool isResult, const quint8 *payload, int size)
+{
+    WireProtocol::Batch batch;
+    if (!WireProtocol::decodeBatch(payload, size, &batch) || batch.hasResults != isResult) {
+        sendError(peer, "Некорректный залп");
+        return;
+    }
+    Peer *other = opponentOf(peer, true);
+    if (!other) return;
+    Room *room = peer->room;
+
+    if (isResult) {
+        if (batch.mode == WireProtocol::BatchFog) return;
+        sendBatch(other, WireProtocol::OpBatchResult, payload, size);
+        if (batch.mode != WireProtocol::BatchFire) return;
+        // Ни одного попадания — ход переходит к тому, по кому стреляли
+        for (int i = 0; i < batch.count; ++i) {
+            int status = WireProtocol::batchResult(batch, i);
+            if (status == WireProtocol::BatchHit || status == WireProtocol::BatchKill) return;
+        }
+        room->turn = peer->seat + 1;
+        sendTurn(room);
+        return;
+    }
+
+    if (room->turn != peer->seat + 1) {
+        sendError(peer, "Сейчас не ваш ход");
+        return;
+    }
+    sendBatch(other, WireProtocol::OpFireBatch, payload, size);
+}
+
+void LoopbackServer::createGame(Peer *peer, const QByteArray &name)
+{
+    if (peer->room) {
+        sendError(peer, "Не удалось создать игру");
+        return;
+    }
+    Room *room = new Room;
+    room->id = "room-" + QByteArray::number(++nextId);
+    room->name = name;
+    room->players[0] = peer;
+    peer->room = room;
+    peer->seat = 0;
+    peer->lobbyWatcher = false;
+    rooms.insert(room->id, room);
+    sendLine(peer, "{\"action\":\"game_created\",\"gameId\":\"" + room->id + "\",\"gameName\":\"" + room->name + "\"}");
+    publishLobby(room, true);
+}
+
+void LoopbackServer::joinGame(Peer *peer, const QByteArray &roomId)
+{
+    Room *room = rooms.value(roomId);
+    if (peer->room || !room || room->players[1]) {
+        sendError(peer, "Не удалось присоединиться к игре");
+        return;
+    }
+    Peer *host = room->players[0];
+    room->players[1] = peer;
+    peer->room = room;
+    peer->seat = 1;
+    peer->lobbyWatcher = false;
+    stats.matches++;
+    publishLobby(room, false);
+    sendLine(host, "{\"action\":\"player_joined\",\"opponentId\":\"" + peer->id + "\",\"gameId\":\"" + roomId + "\"}");
+    sendLine(peer, "{\"action\":\"game_joined\",\"opponentId\":\"" + host->id + "\",\"gameId\":\"" + roomId
+                       + "\",\"yourTurn\":false}");
+}
+
+// Игрок ушел: комната закрывается, оставшийся узнает об этом ошибкой
+void LoopbackServer::closeRoom(Room *room)
+{
+    if (!room->players[1]) publishLobby(room, false);
+    for (int seat = 0; seat < 2; ++seat) {
+        Peer *player = room->players[seat];
+        if (!player) continue;
+        if (player->transport->isOpen()) sendError(player, "Соперник отключился");
+        player->room = nullptr;
+        player->seat = -1;
+    }
+    rooms.remove(room->id);
+    delete room;
+}
+
+// Строка собирается один раз и уходит всем подписчикам
+void LoopbackServer::publishLobby(Room *room, bool added)
+{
+    QByteArray line = "{\"action\":\"lobby_update\",\"version\":" + QByteArray::number(++lobbyVersion);
+    if (added) line += ",\"change\":\"added\",\"game\":" + gameJson(room) + "}";
+    else line += ",\"change\":\"removed\",\"gameId\":\"" + room->id + "\"}";
+    for (Peer *peer : peers) {
+        if (peer->lobbyWatcher && !peer->room) sendLine(peer, line);
+    }
+}
+
+QByteArray LoopbackServer::gameJson(Room *room)
+{
+    return "{\"Id\":\"" + room->id + "\",\"Name\":\"" + room->name + "\",\"Player1Id\":\"" + room->players[0]->id
+           + "\",\"Status\":0}";
+}
+
+// --- Отправка ---
+
+void LoopbackServer::sendLine(Peer *peer, const QByteArray &json)
+{
+    if (peer->binary) {
+        sendFrame(peer, WireProtocol::OpJson, reinterpret_cast<const quint8 *>(json.constData()), json.size());
+        return;
+    }
+    stats.messagesOut++;
+    stats.bytesOut += json.size() + 1;
+    peer->transport->write(json + '\n');
+}
+
+void LoopbackServer::sendFrame(Peer *peer, WireProtocol::Opcode op, const quint8 *payload, int size)
+{
+    QByteArray frame(WireProtocol::MAX_VARINT + 1 + size, Qt::Uninitialized);
+    frame.truncate(WireProtocol::encodeFrame(op, payload, size, reinterpret_cast<quint8 *>(frame.data())));
+    stats.messagesOut++;
+    stats.bytesOut += frame.size();
+    peer->transport->write(frame);
+}
+
+// OpFire: c — результат, если выстрел уже разрешен, иначе -1
+void LoopbackServer::sendEvent(Peer *peer, WireProtocol::Opcode op, int a, int b, int c)
+{
+    if (peer->binary) {
+        quint8 payload[2] = {};
+        int size = 0;
+        switch (op) {
+        case WireProtocol::OpRps: payload[0] = quint8(a); size = 1; break;
+        case WireProtocol::OpFire:
+            payload[0] = quint8(b * 10 + a);
+            payload[1] = quint8(c);
+            size = c >= 0 ? 2 : 1;
+            break;
+        case WireProtocol::OpFireResult: payload[0] = quint8(b * 10 + a); payload[1] = quint8(c); size = 2; break;
+        case WireProtocol::OpTurnChange: payload[0] = quint8(a); size = 1; break;
+        default: break;
+        }
+        sendFrame(peer, op, payload, size);
+        return;
+    }
+
+    QByteArray line = "{\"action\":\"game_event\",\"type\":\"";
+    switch (op) {
+    case WireProtocol::OpReady:
+        line += "ready\"";
+        break;
+    case WireProtocol::OpRps:
+        line += "rps\",\"value\":" + QByteArray::number(a);
+        break;
+    case WireProtocol::OpFire:
+        line += "fire\",\"x\":" + QByteArray::number(a) + ",\"y\":" + QByteArray::number(b);
+        if (c >= 0) line += ",\"value\":" + QByteArray::number(c);
+        break;
+    case WireProtocol::OpFireResult:
+        line += "fire_result\",\"x\":" + QByteArray::number(a) + ",\"y\":" + QByteArray::number(b)
+                + ",\"value\":" + QByteArray::number(c);
+        break;
+    case WireProtocol::OpTurnChange:
+        line += QByteArray("turn_change\",\"currentTurn\":\"") + (a == 1 ? "Player1" : "Player2") + "\"";
+        break;
+    default:
+        return;
+    }
+    sendLine(peer, line + "}");
+}
+
+void LoopbackServer::sendBatch(Peer *peer, WireProtocol::Opcode op, const quint8 *payload, int size)
+{
+    if (peer->binary) {
+        sendFrame(peer, op, payload, size);
+        return;
+    }
+    WireProtocol::Batch batch;
+    WireProtocol::decodeBatch(payload, size, &batch);
+    QByteArray line = QByteArray("{\"action\":\"game_event\",\"type\":\"")
+                      + (op == WireProtocol::OpFireBatch ? "fire_batch" : "fire_batch_result")
+                      + "\",\"mode\":" + QByteArray::number(batch.mode) + ",\"cells\":[";
+    for (int i = 0; i < batch.count; ++i) {
+        if (i) line += ',';
+        line += QByteArray::number(batch.cells[i]);
+    }
+    line += ']';
+    if (batch.hasResults) {
+        line += ",\"results\":[";
+        for (int i = 0; i < batch.count; ++i) {
+            int status = WireProtocol::batchResult(batch, i);
+            if (i) line += ',';
+            line += status == WireProtocol::BatchRepeat ? QByteArray("-1") : QByteArray::number(status);
+        }
+        line += ']';
+    }
+    sendLine(peer, line + "}");
+}
+
+void LoopbackServer::sendTurn(Room *room)
+{
+    for (Peer *player : room->players) {
+        if (player) sendEvent(player, WireProtocol::OpTurnChange, room->turn);
+    }
+}
+
+void LoopbackServer::sendError(Peer *peer, const char *message)
+{
+    sendLine(peer, QByteArray("{\"action\":\"error\",\"message\":\"") + message + "\"}");
+}
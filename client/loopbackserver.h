@@ -0,0 +1,83 @@
+#ifndef LOOPBACKSERVER_H
+#define LOOPBACKSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include "framereader.h"
+#include "transport.h"
+#include "wireprotocol.h"
+
+// Сервер матчей внутри процесса поверх LoopbackTransport: лобби, пересылка игровых событий,
+// К-Н-Б и смена хода — по тем же правилам и в том же формате, что у morskoy_relay, но без сокетов.
+// Выстрелы разрешают сами клиенты ("resolve" в hello_ack нет), сессий и возобновления нет,
+// у подписки на лобби нет истории изменений: отставшему подписчику всегда уходит снимок, зрителей нет.
+// Для партий без сети: бенчмарки протокола и хода игры, проверка NetworkClient без сервера.
+class LoopbackServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LoopbackServer(QObject *parent = nullptr);
+    ~LoopbackServer();
+
+    // Клиентский конец нового канала (передается в NetworkClient), серверный остается здесь
+    LoopbackTransport *createClientTransport();
+
+    struct Stats {
+        qint64 messagesIn = 0;
+        qint64 messagesOut = 0;
+        qint64 bytesIn = 0;
+        qint64 bytesOut = 0;
+        int matches = 0; // Комнат, в которые зашел второй игрок
+    };
+    const Stats &getStats() const { return stats; }
+
+private:
+    struct Room;
+    struct Peer {
+        LoopbackTransport *transport = nullptr;
+        FrameReader reader;
+        bool binary = false;
+        Room *room = nullptr;
+        int seat = -1;
+        QByteArray id;
+        bool lobbyWatcher = false; // subscribe_lobby
+    };
+    struct Room {
+        QByteArray id;
+        QByteArray name;
+        Peer *players[2] = {nullptr, nullptr};
+        int rps[2] = {0, 0};
+        int turn = 0; // 0 — бой не начался, 1/2 — ходит Player1/Player2
+    };
+
+    QList<Peer *> peers;
+    QHash<QByteArray, Room *> rooms;
+    int nextId = 0;
+    qint64 lobbyVersion = 0;
+    Stats stats;
+
+    void onReadyRead(Peer *peer);
+    void onClosed(Peer *peer);
+    void removePeer(Peer *peer);
+    void handleJson(Peer *peer, const char *json, int size);
+    void handleFrame(Peer *peer, quint8 op, const quint8 *payload, int size);
+    void handleGameEvent(Peer *peer, WireProtocol::MessageKey type, int x, int y, int value, const char *json, int size);
+    void handleBatch(Peer *peer, bool isResult, const quint8 *payload, int size);
+    void createGame(Peer *peer, const QByteArray &name);
+    void joinGame(Peer *peer, const QByteArray &roomId);
+    void closeRoom(Room *room);
+    void publishLobby(Room *room, bool added); // lobby_update подписчикам
+    static QByteArray gameJson(Room *room);
+    Peer *opponentOf(Peer *peer, bool report);
+
+    void sendLine(Peer *peer, const QByteArray &json); // Строкой или кадром OpJson, по протоколу клиента
+    void sendFrame(Peer *peer, WireProtocol::Opcode op, const quint8 *payload, int size);
+    void sendEvent(Peer *peer, WireProtocol::Opcode op, int a = 0, int b = 0, int c = 0);
+    void sendBatch(Peer *peer, WireProtocol::Opcode op, const quint8 *payload, int size);
+    void sendTurn(Room *room);
+    void sendError(Peer *peer, const char *message);
+};
+
+#endif // LOOPBACKSERVER_H
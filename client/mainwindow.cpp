@@ -6,7 +6,12 @@
 #include <cmath>
 #include <QDebug>
 #include <QClipboard>
+#include <QSet>
 #include "multiplayergamewindow.h"
+#include "spectatorwindow.h"
+#include "replaywindow.h"
+#include "matchrecorder.h"
+#include <QFileDialog>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), backgroundOffset(0), backgroundOffsetY(0), isUserRegistered(false), currentPlayerName("Player")
@@ -26,6 +31,7 @@ MainWindow::MainWindow(QWidget *parent)
 
     // Инициализация сети
     netClient = new NetworkClient(this);
+    netClient->startNetworkThread(); // Перерисовка окон не задерживает чтение сокета
     connect(netClient, &NetworkClient::connected, this, &MainWindow::onNetworkConnected);
     connect(netClient, &NetworkClient::errorOccurred, this, &MainWindow::onNetworkError);
     // Подключаем новые сигналы
@@ -33,6 +39,9 @@ MainWindow::MainWindow(QWidget *parent)
     connect(netClient, &NetworkClient::joinedLobby, this, &MainWindow::onJoinedLobby);
     connect(netClient, &NetworkClient::playerJoined, this, &MainWindow::onPlayerJoinedMyLobby);
     connect(netClient, &NetworkClient::gameError, this, &MainWindow::onGameError);
+    connect(netClient, &NetworkClient::lobbySnapshot, this, &MainWindow::onLobbySnapshot);
+    connect(netClient, &NetworkClient::lobbyUpdated, this, &MainWindow::onLobbyUpdated);
+    connect(netClient, &NetworkClient::spectateStarted, this, &MainWindow::onSpectateStarted);
 
     setupUI();
     setWindowTitle("Морской Бой - 8-BIT EDITION");
@@ -165,6 +174,7 @@ void MainWindow::setupMenuContainer() {
     QPushButton *btnSingle = new QPushButton("ОДИНОЧНАЯ ИГРА", menuContainer);
     QPushButton *btnMulti = new QPushButton("МУЛЬТИПЛЕЕР", menuContainer);
     QPushButton *btnSettings = new QPushButton("НАСТРОЙКИ", menuContainer);
+    QPushButton *btnReplays = new QPushButton("ЗАПИСИ ПАРТИЙ", menuContainer);
     QPushButton *btnExit = new QPushButton("ВЫХОД", menuContainer);
 
     layout->addStretch(1);
@@ -173,12 +183,14 @@ void MainWindow::setupMenuContainer() {
     layout->addWidget(btnSingle, 0, Qt::AlignCenter);
     layout->addWidget(btnMulti, 0, Qt::AlignCenter);
     layout->addWidget(btnSettings, 0, Qt::AlignCenter);
+    layout->addWidget(btnReplays, 0, Qt::AlignCenter);
     layout->addWidget(btnExit, 0, Qt::AlignCenter);
     layout->addStretch(1);
 
     connect(btnSingle, &QPushButton::clicked, this, &MainWindow::onSinglePlayerClicked);
     connect(btnMulti, &QPushButton::clicked, this, &MainWindow::onMultiplayerClicked);
     connect(btnSettings, &QPushButton::clicked, this, &MainWindow::onSettingsClicked);
+    connect(btnReplays, &QPushButton::clicked, this, &MainWindow::onReplaysClicked);
     connect(btnExit, &QPushButton::clicked, this, &MainWindow::onExitClicked);
 }
 
@@ -328,12 +340,17 @@ void MainWindow::setupMultiplayerContainer() {
     QPushButton *btnConnect = new QPushButton("ПОДКЛЮЧИТЬСЯ", multiplayerContainer);
     btnConnect->setStyleSheet("background-color: #2980b9; color: white; min-width: 150px;");
 
+    QPushButton *btnSpectate = new QPushButton("СМОТРЕТЬ", multiplayerContainer);
+    btnSpectate->setStyleSheet("background-color: #7f8c8d; color: white; min-width: 150px;");
+
     connect(btnCreate, &QPushButton::clicked, this, &MainWindow::onCreateServerClicked);
     connect(btnConnect, &QPushButton::clicked, this, &MainWindow::onConnectClicked);
+    connect(btnSpectate, &QPushButton::clicked, this, &MainWindow::onSpectateClicked);
 
     actionsLayout->addStretch();
     actionsLayout->addWidget(btnCreate);
     actionsLayout->addWidget(btnConnect);
+    actionsLayout->addWidget(btnSpectate);
     actionsLayout->addStretch();
 
     serverListWidget = new QListWidget(multiplayerContainer);
@@ -348,9 +365,8 @@ void MainWindow::setupMultiplayerContainer() {
         "QListWidget::item:selected { background-color: #3498db; color: white; }"
         );
 
-    serverListWidget->addItem("Сервер не поддерживает список игр.");
-    serverListWidget->addItem("Чтобы играть, создайте игру и");
-    serverListWidget->addItem("передайте ID другу.");
+    connect(serverListWidget, &QListWidget::itemActivated, this, &MainWindow::onServerItemActivated);
+    updateLobbyPlaceholder();
 
     mainLayout->addLayout(topLayout);
     mainLayout->addSpacing(20);
@@ -553,6 +569,9 @@ void MainWindow::onMultiplayerClicked() {
 }
 
 void MainWindow::startMultiplayerAnimation() {
+    lobbyVisible = true;
+    subscribeLobby(); // Без связи — подпишемся в onNetworkConnected
+
     multiplayerContainer->move(0, height());
     multiplayerContainer->show();
 
@@ -589,6 +608,9 @@ void MainWindow::onRegistrationFinished() {
 }
 
 void MainWindow::onBackFromMultiplayerClicked() {
+    lobbyVisible = false;
+    unsubscribeLobby();
+
     animMenu = new QPropertyAnimation(menuContainer, "pos", this);
     animMenu->setDuration(500);
     animMenu->setStartValue(QPoint(0, -height()));
@@ -615,6 +637,10 @@ void MainWindow::onBackFromMultiplayerClicked() {
 void MainWindow::onNetworkConnected() {
     // Тихое успешное подключение
     qDebug() << "Connected to server!";
+    // Новое подключение, а не возврат в матч: сервер мог перезапуститься, и его версии лобби
+    // с прежними не связаны — список берем снимком
+    lobbyVersion = 0;
+    if (lobbyVisible) subscribeLobby();
 }
 
 void MainWindow::onNetworkError(const QString &msg) {
@@ -644,6 +670,7 @@ void MainWindow::onServerCreatedUI(const QString &name, const QString &password)
 }
 
 void MainWindow::onLobbyCreated(const QString &gameId) {
+    lobbySubscribed = false; // Сервер не шлет изменения лобби тем, кто в комнате
     waitingStatusLabel->setText("Комната создана!\nСообщите этот ID другу для подключения:");
     gameIdDisplay->setText(gameId);
 }
@@ -657,6 +684,7 @@ void MainWindow::onPlayerJoinedMyLobby(const QString &playerName) {
     this->hide();
     connect(game, &MultiplayerGameWindow::backToMenu, this, [=]() {
         this->show();
+        if (lobbyVisible) subscribeLobby(); // Догоняем список с той версии, что видели до игры
     });
     game->setAttribute(Qt::WA_DeleteOnClose);
     game->show();
@@ -664,7 +692,13 @@ void MainWindow::onPlayerJoinedMyLobby(const QString &playerName) {
 
 // --- ПОДКЛЮЧЕНИЕ ---
 void MainWindow::onConnectClicked() {
-    // Так как списка игр нет, просим ID
+    // Выбрана игра из списка — входим в нее, иначе просим ID
+    QListWidgetItem *selected = serverListWidget->currentItem();
+    if (selected && !selected->data(Qt::UserRole).toString().isEmpty()) {
+        onServerItemActivated(selected);
+        return;
+    }
+
     bool ok;
     QString gameId = QInputDialog::getText(this, "Подключение",
                                            "Введите ID игры (получите его у создателя):", QLineEdit::Normal,
@@ -676,17 +710,47 @@ void MainWindow::onConnectClicked() {
 
 void MainWindow::onJoinedLobby(const QString &gameId) {
     // Мы подключились к кому-то (мы Гость)
+    lobbySubscribed = false;
 
     // Запускаем мультиплеерное окно как ГОСТЬ
     MultiplayerGameWindow *game = new MultiplayerGameWindow(netClient, false, selectedAvatarPath);
     this->hide();
     connect(game, &MultiplayerGameWindow::backToMenu, this, [=]() {
         this->show();
+        if (lobbyVisible) subscribeLobby();
     });
     game->setAttribute(Qt::WA_DeleteOnClose);
     game->show();
 }
 
+// --- НАБЛЮДЕНИЕ ---
+void MainWindow::onSpectateClicked() {
+    // Идущих игр в списке нет — за ними наблюдают по ID, который сообщил игрок
+    QListWidgetItem *selected = serverListWidget->currentItem();
+    QString gameId = selected ? selected->data(Qt::UserRole).toString() : QString();
+    if (gameId.isEmpty()) {
+        bool ok;
+        gameId = QInputDialog::getText(this, "Наблюдение", "Введите ID игры, за которой хотите наблюдать:",
+                                       QLineEdit::Normal, "", &ok).trimmed();
+        if (!ok || gameId.isEmpty()) return;
+    }
+    netClient->spectateGame(gameId);
+}
+
+void MainWindow::onSpectateStarted(const QString &gameId, const QString &gameName, int turn, const QVector<int> &shots) {
+    Q_UNUSED(gameId)
+    lobbySubscribed = false; // Зрителю сервер изменения лобби не шлет
+
+    SpectatorWindow *spectator = new SpectatorWindow(netClient, gameName, turn, shots);
+    this->hide();
+    connect(spectator, &SpectatorWindow::backToMenu, this, [=]() {
+        this->show();
+        if (lobbyVisible) subscribeLobby();
+    });
+    spectator->setAttribute(Qt::WA_DeleteOnClose);
+    spectator->show();
+}
+
 void MainWindow::onGameError(const QString &msg) {
     QMessageBox::warning(this, "Ошибка сервера", msg);
     // Если ошибка произошла во время ожидания (например, не удалось создать), скрываем лобби
@@ -699,6 +763,87 @@ void MainWindow::onCancelWaiting() {
     waitingLobbyWidget->hide();
 }
 
+// --- СПИСОК ИГР ---
+// Сервер присылает снимок, затем только изменения с номером версии. Строки списка правятся
+// на месте: выделение и прокрутка не сбрасываются, при тысячах игр нет перестройки виджета.
+
+void MainWindow::subscribeLobby() {
+    if (!netClient->isConnected()) return;
+    lobbySubscribed = true;
+    lobbyResyncFrom = -1;
+    netClient->subscribeLobby(lobbyVersion);
+}
+
+void MainWindow::unsubscribeLobby() {
+    if (!lobbySubscribed) return;
+    lobbySubscribed = false;
+    netClient->unsubscribeLobby();
+}
+
+void MainWindow::onLobbySnapshot(qint64 version, const QJsonArray &games) {
+    if (!lobbySubscribed) return;
+    QSet<QString> present;
+    for (const QJsonValue &value : games) {
+        QJsonObject game = value.toObject();
+        QString gameId = game["Id"].toString();
+        present.insert(gameId);
+        setLobbyGame(gameId, game["Name"].toString());
+    }
+    for (auto it = lobbyItems.begin(); it != lobbyItems.end();) {
+        if (present.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        delete it.value(); // Строка уходит из QListWidget вместе с объектом
+        it = lobbyItems.erase(it);
+    }
+    lobbyVersion = version;
+    updateLobbyPlaceholder();
+}
+
+void MainWindow::onLobbyUpdated(qint64 version, const QString &change, const QString &gameId, const QString &gameName) {
+    if (!lobbySubscribed || version <= lobbyVersion) return; // Повтор уже примененного после переподписки
+    if (version != lobbyVersion + 1) {
+        // Изменение пропущено (рассылки сервера обогнали друг друга): просим недостающее один раз
+        if (lobbyResyncFrom != lobbyVersion) {
+            lobbyResyncFrom = lobbyVersion;
+            netClient->subscribeLobby(lobbyVersion);
+        }
+        return;
+    }
+
+    if (change == "removed") delete lobbyItems.take(gameId);
+    else setLobbyGame(gameId, gameName);
+    lobbyVersion = version;
+    updateLobbyPlaceholder();
+}
+
+void MainWindow::setLobbyGame(const QString &gameId, const QString &gameName) {
+    QListWidgetItem *&item = lobbyItems[gameId];
+    if (!item) {
+        item = new QListWidgetItem(serverListWidget);
+        item->setData(Qt::UserRole, gameId);
+        item->setToolTip(gameId);
+    }
+    QString text = QString("%1   [%2]").arg(gameName, gameId.left(8));
+    if (item->text() != text) item->setText(text);
+}
+
+void MainWindow::updateLobbyPlaceholder() {
+    if (lobbyItems.isEmpty() && !lobbyPlaceholder) {
+        lobbyPlaceholder = new QListWidgetItem("Открытых игр нет. Создайте свою или подключитесь по ID.", serverListWidget);
+        lobbyPlaceholder->setFlags(Qt::NoItemFlags);
+    } else if (!lobbyItems.isEmpty() && lobbyPlaceholder) {
+        delete lobbyPlaceholder;
+        lobbyPlaceholder = nullptr;
+    }
+}
+
+void MainWindow::onServerItemActivated(QListWidgetItem *item) {
+    QString gameId = item->data(Qt::UserRole).toString();
+    if (!gameId.isEmpty()) netClient->joinLobby(gameId);
+}
+
 // --- ПРОЧЕЕ ---
 void MainWindow::onChangeAvatarClicked() {
     if (avatarSelectionWidget->isVisible()) {
@@ -736,4 +881,24 @@ void MainWindow::onSinglePlayerClicked()
     game->show();
 }
 
+void MainWindow::onReplaysClicked()
+{
+    QString path = QFileDialog::getOpenFileName(this, "Запись партии", MatchRecorder::replaysDir(),
+                                                QString("Записи партий (*%1)").arg(MatchRecorder::FILE_SUFFIX));
+    if (path.isEmpty()) return;
+
+    ReplayWindow *replay = new ReplayWindow(path);
+    if (!replay->isValid()) {
+        delete replay;
+        QMessageBox::warning(this, "Запись партии", "Файл не является записью партии.");
+        return;
+    }
+    this->hide();
+    connect(replay, &ReplayWindow::backToMenu, this, [=]() {
+        this->show();
+    });
+    replay->setAttribute(Qt::WA_DeleteOnClose);
+    replay->show();
+}
+
 void MainWindow::onExitClicked() { QApplication::quit(); }
@@ -13,6 +13,7 @@
 #include <QScrollArea>
 #include <QGridLayout>
 #include <QListWidget>
+#include <QHash>
 #include <QInputDialog>
 #include "loginwindow.h"
 #include "createserverdialog.h"
@@ -45,6 +46,7 @@ private slots:
     void onSinglePlayerClicked();
     void onMultiplayerClicked();
     void onSettingsClicked();
+    void onReplaysClicked();
     void onExitClicked();
 
     void onBackFromSettingsClicked();
@@ -67,6 +69,11 @@ private slots:
     void onJoinedLobby(const QString &gameId);
     void onPlayerJoinedMyLobby(const QString &playerName);
     void onGameError(const QString &msg);
+    void onLobbySnapshot(qint64 version, const QJsonArray &games);
+    void onLobbyUpdated(qint64 version, const QString &change, const QString &gameId, const QString &gameName);
+    void onServerItemActivated(QListWidgetItem *item);
+    void onSpectateClicked();
+    void onSpectateStarted(const QString &gameId, const QString &gameName, int turn, const QVector<int> &shots);
 
 private:
     void setupUI();
@@ -77,6 +84,12 @@ private:
 
     void startMultiplayerAnimation();
 
+    // Список игр: подписка и правка строк на месте
+    void subscribeLobby();
+    void unsubscribeLobby();
+    void setLobbyGame(const QString &gameId, const QString &gameName);
+    void updateLobbyPlaceholder();
+
     QPoint mousePos;
 
     QWidget *menuContainer;
@@ -93,6 +106,12 @@ private:
     QPushButton *btnChangeAvatar;
     QLabel *currentAvatarPreview;
     QListWidget *serverListWidget;
+    QHash<QString, QListWidgetItem *> lobbyItems; // ID игры -> ее строка в serverListWidget
+    QListWidgetItem *lobbyPlaceholder = nullptr;  // "Открытых игр нет", пока список пуст
+    qint64 lobbyVersion = 0;                      // Последнее примененное изменение лобби
+    qint64 lobbyResyncFrom = -1;                  // С какой версии уже попросили пропущенное
+    bool lobbyVisible = false;                    // Экран мультиплеера открыт
+    bool lobbySubscribed = false;
 
     QString selectedAvatarPath;
     // Сохраняем логин игрока, чтобы отправить его на сервер
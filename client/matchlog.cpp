@@ -0,0 +1,317 @@
+#include "matchlog.h"
+#include "wireprotocol.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[] = "MBREC";
+const int MAGIC_SIZE = 5;
+
+void putU64(std::uint8_t *out, std::uint64_t v) {
+    for (int i = 0; i < 8; ++i) out[i] = std::uint8_t(v >> (8 * i));
+}
+
+std::uint64_t getU64(const std::uint8_t *p) {
+    std::uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= std::uint64_t(p[i]) << (8 * i);
+    return v;
+}
+
+Bitboard getBitboard(const std::uint8_t *p) {
+    Bitboard b;
+    b.lo = getU64(p);
+    b.hi = getU64(p + 8) & Bitboard::full().hi;
+    return b;
+}
+
+} // namespace
+
+// --- MatchLog ---
+
+void MatchLog::apply(State *state, const Event &event) {
+    switch (event.type) {
+    case RecFleet: {
+        Bitboard ships;
+        for (int i = 0; i < event.value; ++i) {
+            int bow = event.fields[2 * i];
+            int size = event.fields[2 * i + 1] & 0x7F;
+            Orientation orient = (event.fields[2 * i + 1] & 0x80) ? Orientation::Vertical : Orientation::Horizontal;
+            ships |= BoardModel::shipMask(bow % 10, bow / 10, size, orient);
+        }
+        state->sides[event.side - 1].ships = ships;
+        break;
+    }
+    case RecShot: {
+        State::Side &target = state->sides[2 - event.side];
+        if (event.value == BoardModel::ShotMiss) {
+            target.misses.set(event.cell);
+        } else if (event.value == BoardModel::ShotHit || event.value == BoardModel::ShotKill) {
+            target.hits.set(event.cell);
+            // Как BoardModel::receiveShot: вокруг убитого корабля — промахи. Корабль — связные попадания
+            // (у соперника по сети флот неизвестен, но соседние корабли не касаются друг друга)
+            if (event.value == BoardModel::ShotKill) {
+                Bitboard ship = BoardModel::component(target.hits, event.cell);
+                target.misses |= BoardModel::halo(ship) & ~(target.hits | target.ships);
+            }
+        }
+        break;
+    }
+    case RecTurn:
+        state->turn = event.side;
+        break;
+    case RecEnd:
+        state->winner = event.side;
+        break;
+    default:
+        break;
+    }
+}
+
+// --- MatchLogWriter ---
+
+MatchLogWriter::MatchLogWriter(MatchLog::Mode mode, std::uint64_t seed, std::uint64_t startMs) {
+    buffer.resize(MatchLog::HEADER_SIZE);
+    std::memcpy(buffer.data(), MAGIC, MAGIC_SIZE);
+    buffer[MAGIC_SIZE] = std::uint8_t(MatchLog::VERSION);
+    buffer[MAGIC_SIZE + 1] = std::uint8_t(mode);
+    putU64(buffer.data() + MAGIC_SIZE + 2, seed);
+    putU64(buffer.data() + MAGIC_SIZE + 10, startMs);
+}
+
+void MatchLogWriter::putVarint(std::uint32_t value) {
+    std::uint8_t tmp[WireProtocol::MAX_VARINT];
+    int n = WireProtocol::putVarint(value, tmp);
+    buffer.insert(buffer.end(), tmp, tmp + n);
+}
+
+void MatchLogWriter::putBitboard(const Bitboard &b) {
+    std::uint8_t tmp[16];
+    putU64(tmp, b.lo);
+    putU64(tmp + 8, b.hi);
+    buffer.insert(buffer.end(), tmp, tmp + 16);
+}
+
+void MatchLogWriter::record(MatchLog::Event &event, const std::uint8_t *fields, int size) {
+    std::uint32_t time = std::max(event.timeMs, lastTime);
+    buffer.push_back(std::uint8_t(event.type));
+    putVarint(time - lastTime);
+    buffer.insert(buffer.end(), fields, fields + size);
+    lastTime = time;
+
+    MatchLog::apply(&state, event);
+    if (++steps % MatchLog::SNAPSHOT_EVERY != 0) return;
+
+    buffer.push_back(MatchLog::RecSnapshot);
+    putVarint(0);
+    putVarint(std::uint32_t(steps));
+    buffer.push_back(std::uint8_t(state.turn));
+    buffer.push_back(std::uint8_t(state.winner));
+    for (const MatchLog::State::Side &side : state.sides) {
+        putBitboard(side.ships);
+        putBitboard(side.hits);
+        putBitboard(side.misses);
+    }
+}
+
+void MatchLogWriter::fleet(std::uint32_t timeMs, int side, const BoardModel &model) {
+    std::uint8_t fields[2 + 2 * BoardModel::MAX_SHIPS];
+    int count = 0;
+    for (int slot = 0; slot < model.shipCount(); ++slot) {
+        Bitboard mask = model.shipMaskOf(slot);
+        if (mask.none()) continue;
+        int bow = mask.first();
+        int size = mask.count();
+        fields[2 + 2 * count] = std::uint8_t(bow);
+        fields[3 + 2 * count] = std::uint8_t(size | (size > 1 && mask.test(bow + 10) ? 0x80 : 0));
+        ++count;
+    }
+    fields[0] = std::uint8_t(side);
+    fields[1] = std::uint8_t(count);
+
+    MatchLog::Event event;
+    event.type = MatchLog::RecFleet;
+    event.side = side;
+    event.value = count;
+    event.timeMs = timeMs;
+    event.fields = fields + 2;
+    record(event, fields, 2 + 2 * count);
+}
+
+void MatchLogWriter::shot(std::uint32_t timeMs, int side, int cell, int result) {
+    if (cell < 0 || cell >= BoardModel::CELLS) return;
+    std::uint8_t fields[3] = {std::uint8_t(side), std::uint8_t(cell), std::uint8_t(result + 1)};
+    MatchLog::Event event;
+    event.type = MatchLog::RecShot;
+    event.side = side;
+    event.cell = cell;
+    event.value = result;
+    event.timeMs = timeMs;
+    record(event, fields, 3);
+}
+
+void MatchLogWriter::ability(std::uint32_t timeMs, int side, int type, int cell) {
+    if (cell < -1 || cell >= BoardModel::CELLS) cell = -1;
+    std::uint8_t fields[3] = {std::uint8_t(side), std::uint8_t(type), std::uint8_t(cell + 1)};
+    MatchLog::Event event;
+    event.type = MatchLog::RecAbility;
+    event.side = side;
+    event.cell = cell;
+    event.value = type;
+    event.timeMs = timeMs;
+    record(event, fields, 3);
+}
+
+void MatchLogWriter::turn(std::uint32_t timeMs, int side) {
+    if (side == state.turn || state.winner != 0) return;
+    std::uint8_t field = std::uint8_t(side);
+    MatchLog::Event event;
+    event.type = MatchLog::RecTurn;
+    event.side = side;
+    event.timeMs = timeMs;
+    record(event, &field, 1);
+}
+
+void MatchLogWriter::end(std::uint32_t timeMs, int winner) {
+    if (state.winner != 0) return;
+    std::uint8_t field = std::uint8_t(winner);
+    MatchLog::Event event;
+    event.type = MatchLog::RecEnd;
+    event.side = winner;
+    event.timeMs = timeMs;
+    record(event, &field, 1);
+}
+
+// --- MatchReplay ---
+
+bool MatchReplay::open(const std::uint8_t *fileData, std::size_t fileSize) {
+    data = nullptr;
+    size = 0;
+    steps.clear();
+    snapshots.clear();
+    if (fileSize < std::size_t(MatchLog::HEADER_SIZE) || std::memcmp(fileData, MAGIC, MAGIC_SIZE) != 0) return false;
+    if (fileData[MAGIC_SIZE] != MatchLog::VERSION) return false;
+
+    data = fileData;
+    size = fileSize;
+    mode = fileData[MAGIC_SIZE + 1] == MatchLog::ModeMultiplayer ? MatchLog::ModeMultiplayer : MatchLog::ModeSingle;
+    seed = getU64(fileData + MAGIC_SIZE + 2);
+    startMs = getU64(fileData + MAGIC_SIZE + 10);
+
+    // Оглавление: где начинается каждый шаг и где лежат снимки
+    std::size_t offset = MatchLog::HEADER_SIZE;
+    std::uint32_t time = 0;
+    MatchLog::Event event;
+    while (std::size_t length = parse(offset, time, &event)) {
+        if (event.type == MatchLog::RecSnapshot) {
+            if (event.value == int(steps.size())) {
+                snapshots.push_back({event.value, std::uint32_t(event.fields - data)});
+            }
+        } else {
+            steps.push_back({std::uint32_t(offset), event.timeMs});
+        }
+        time = event.timeMs;
+        offset += length;
+    }
+    return true;
+}
+
+std::size_t MatchReplay::parse(std::size_t offset, std::uint32_t prevTime, MatchLog::Event *event) const {
+    if (offset >= size) return 0;
+    const std::uint8_t *p = data + offset;
+    const std::uint8_t *end = data + size;
+
+    *event = MatchLog::Event();
+    event->type = *p++;
+    std::uint32_t value = 0;
+    int n = WireProtocol::getVarint(p, int(std::min<std::size_t>(end - p, WireProtocol::MAX_VARINT)), &value);
+    if (n <= 0) return 0;
+    p += n;
+    event->timeMs = prevTime + value;
+
+    auto validSide = [](int side) { return side == 1 || side == 2; };
+    switch (event->type) {
+    case MatchLog::RecFleet:
+        if (end - p < 2) return 0;
+        event->side = p[0];
+        event->value = p[1];
+        p += 2;
+        if (!validSide(event->side) || event->value > BoardModel::MAX_SHIPS || end - p < 2 * event->value) return 0;
+        for (int i = 0; i < event->value; ++i) {
+            if (p[2 * i] >= BoardModel::CELLS) return 0;
+        }
+        event->fields = p;
+        p += 2 * event->value;
+        break;
+    case MatchLog::RecShot:
+    case MatchLog::RecAbility:
+        if (end - p < 3) return 0;
+        event->side = p[0];
+        if (event->type == MatchLog::RecShot) {
+            event->cell = p[1];
+            event->value = p[2] - 1;
+        } else {
+            event->value = p[1];
+            event->cell = p[2] - 1;
+        }
+        p += 3;
+        if (!validSide(event->side) || event->cell >= BoardModel::CELLS) return 0;
+        if (event->type == MatchLog::RecShot && event->cell < 0) return 0;
+        break;
+    case MatchLog::RecTurn:
+    case MatchLog::RecEnd:
+        if (end - p < 1) return 0;
+        event->side = *p++;
+        if (!validSide(event->side)) return 0;
+        break;
+    case MatchLog::RecSnapshot:
+        n = WireProtocol::getVarint(p, int(std::min<std::size_t>(end - p, WireProtocol::MAX_VARINT)), &value);
+        if (n <= 0 || end - p - n < 2 + 6 * 16) return 0;
+        p += n;
+        event->value = int(value);
+        event->fields = p;
+        p += 2 + 6 * 16;
+        break;
+    default:
+        return 0; // Незнакомая запись — дальше читать нельзя
+    }
+    return std::size_t(p - (data + offset));
+}
+
+MatchLog::Event MatchReplay::event(int step) const {
+    MatchLog::Event event;
+    if (step < 0 || step >= stepCount()) return event;
+    parse(steps[step].offset, 0, &event);
+    event.timeMs = steps[step].timeMs;
+    return event;
+}
+
+void MatchReplay::seek(int step, MatchLog::State *state) const {
+    step = std::max(0, std::min(step, stepCount()));
+    *state = MatchLog::State();
+
+    // Последний снимок не позже нужного шага
+    auto it = std::upper_bound(snapshots.begin(), snapshots.end(), step,
+                               [](int s, const SnapshotInfo &snap) { return s < snap.step; });
+    int from = 0;
+    if (it != snapshots.begin()) {
+        const SnapshotInfo &snap = *(it - 1);
+        const std::uint8_t *p = data + snap.offset;
+        state->turn = p[0];
+        state->winner = p[1];
+        p += 2;
+        for (MatchLog::State::Side &side : state->sides) {
+            side.ships = getBitboard(p);
+            side.hits = getBitboard(p + 16);
+            side.misses = getBitboard(p + 32);
+            p += 48;
+        }
+        from = snap.step;
+    }
+
+    MatchLog::Event event;
+    for (int i = from; i < step; ++i) {
+        parse(steps[i].offset, 0, &event);
+        MatchLog::apply(state, event);
+    }
+}
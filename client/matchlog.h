@@ -0,0 +1,133 @@
+#ifndef MATCHLOG_H
+#define MATCHLOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "boardmodel.h"
+
+// Запись партии: журнал событий, который только дописывается.
+// Заголовок: "MBREC", u8 версия, u8 режим, seed и время начала (мс с эпохи) — по 8 байт little-endian.
+// Дальше записи: u8 тип, varint мс от предыдущей записи, поля типа. Varint — как в WireProtocol.
+// Стороны: 1 — владелец записи, 2 — соперник; выстрел стороны by ложится на поле стороны 3 - by.
+// Каждая запись, кроме снимка, — шаг партии. Раз в SNAPSHOT_EVERY шагов пишется снимок обоих полей:
+// перемотка идет от ближайшего снимка, а не с начала. Оглавления в конце нет (файл может оборваться
+// на любой записи) — его строит MatchReplay за один проход при открытии.
+// Файлов не касается — буфер и отображенная память; из Qt нужен только QPoint (через boardmodel.h).
+// Пишет MatchRecorder, читает ReplayWindow.
+class MatchLog
+{
+public:
+    static const int VERSION = 1;
+    static const int HEADER_SIZE = 5 + 2 + 16;
+    static const int SNAPSHOT_EVERY = 16;
+
+    enum Mode { ModeSingle = 1, ModeMultiplayer = 2 };
+
+    enum RecordType : std::uint8_t {
+        RecFleet    = 1, // u8 сторона, u8 число кораблей, по кораблю u8 клетка носа, u8 размер | 0x80 (как в OpReady)
+        RecShot     = 2, // u8 сторона, u8 клетка, u8 результат (BoardModel::ShotResult + 1)
+        RecAbility  = 3, // u8 сторона, u8 способность (1 туман, 2 радар, 3 кластер), u8 клетка + 1 (0 — без клетки)
+        RecTurn     = 4, // u8 чей ход
+        RecEnd      = 5, // u8 победившая сторона
+        RecSnapshot = 6  // varint номер шага, u8 ход, u8 победитель, по полю 1 и 2: корабли, попадания, промахи (по 16 байт)
+    };
+
+    // Поля обеих сторон на каком-то шаге партии
+    struct State {
+        struct Side {
+            Bitboard ships;  // Флот соперника по сети неизвестен — пусто
+            Bitboard hits;
+            Bitboard misses;
+        };
+        Side sides[2];
+        int turn = 0;   // 0 — бой не начался
+        int winner = 0; // 0 — партия не закончена
+    };
+
+    // Разобранный шаг (для списка событий в окне просмотра)
+    struct Event {
+        int type = 0;
+        int side = 0;
+        int cell = -1;
+        int value = 0;             // Результат выстрела, номер способности или число кораблей флота
+        std::uint32_t timeMs = 0;  // От начала записи
+        const std::uint8_t *fields = nullptr; // RecFleet: value пар (клетка носа, размер | 0x80); RecSnapshot: поля после номера шага
+    };
+
+    // Применить шаг к состоянию — общий код записи (снимки) и просмотра (перемотка)
+    static void apply(State *state, const Event &event);
+};
+
+// Пишет журнал в память: вызывающий забирает накопленное через pending() и дописывает в файл.
+// Состояние полей ведет сам — из него берутся снимки.
+class MatchLogWriter
+{
+public:
+    MatchLogWriter(MatchLog::Mode mode, std::uint64_t seed, std::uint64_t startMs);
+
+    // timeMs — от начала записи
+    void fleet(std::uint32_t timeMs, int side, const BoardModel &model);
+    void shot(std::uint32_t timeMs, int side, int cell, int result);
+    void ability(std::uint32_t timeMs, int side, int type, int cell = -1);
+    void turn(std::uint32_t timeMs, int side); // Пишется, только если ход сменился
+    void end(std::uint32_t timeMs, int winner);
+
+    const std::vector<std::uint8_t> &pending() const { return buffer; }
+    void clearPending() { buffer.clear(); }
+    int getSteps() const { return steps; }
+    bool isFinished() const { return state.winner != 0; }
+
+private:
+    std::vector<std::uint8_t> buffer;
+    MatchLog::State state;
+    std::uint32_t lastTime = 0;
+    int steps = 0;
+
+    void record(MatchLog::Event &event, const std::uint8_t *fields, int size);
+    void putVarint(std::uint32_t value);
+    void putBitboard(const Bitboard &b);
+};
+
+// Чтение записи прямо из памяти (файл отображается целиком, без копии): один проход строит
+// оглавление шагов и снимков, перемотка на любой шаг — не больше SNAPSHOT_EVERY записей от снимка.
+// Данные должны жить, пока жив MatchReplay.
+class MatchReplay
+{
+public:
+    // false — не запись партии; оборванный хвост просто отбрасывается
+    bool open(const std::uint8_t *data, std::size_t size);
+
+    MatchLog::Mode getMode() const { return mode; }
+    std::uint64_t getSeed() const { return seed; }
+    std::uint64_t getStartMs() const { return startMs; }
+    int stepCount() const { return int(steps.size()); }
+
+    // Шаг step (0..stepCount() - 1)
+    MatchLog::Event event(int step) const;
+    // Состояние после первых step шагов (0 — до первого)
+    void seek(int step, MatchLog::State *state) const;
+
+private:
+    struct StepInfo {
+        std::uint32_t offset; // Начало записи
+        std::uint32_t timeMs;
+    };
+    struct SnapshotInfo {
+        int step;              // Снимок сделан после стольких шагов
+        std::uint32_t offset;  // Начало полей снимка после номера шага
+    };
+
+    const std::uint8_t *data = nullptr;
+    std::size_t size = 0;
+    MatchLog::Mode mode = MatchLog::ModeSingle;
+    std::uint64_t seed = 0;
+    std::uint64_t startMs = 0;
+    std::vector<StepInfo> steps;
+    std::vector<SnapshotInfo> snapshots;
+
+    // Разбор записи с offset: длина записи, 0 — запись оборвана или испорчена
+    std::size_t parse(std::size_t offset, std::uint32_t prevTime, MatchLog::Event *event) const;
+};
+
+#endif // MATCHLOG_H
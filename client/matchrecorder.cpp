@@ -0,0 +1,66 @@
+#include "matchrecorder.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QStandardPaths>
+
+const char *const MatchRecorder::FILE_SUFFIX = ".mbrec";
+
+QString MatchRecorder::replaysDir() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/replays";
+}
+
+MatchRecorder::MatchRecorder(MatchLog::Mode mode, quint64 seed)
+    : writer(mode, seed, quint64(QDateTime::currentMSecsSinceEpoch()))
+{
+    clock.start();
+    QDir().mkpath(replaysDir());
+    // Имя до миллисекунд; файл только новый — чужую запись не дописываем, при совпадении берем номер
+    QString base = replaysDir() + "/" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz")
+                   + (mode == MatchLog::ModeSingle ? "-bot" : "-net");
+    for (int attempt = 0; attempt < MAX_NAME_ATTEMPTS; ++attempt) {
+        file.setFileName(base + (attempt > 0 ? QString("-%1").arg(attempt) : QString()) + FILE_SUFFIX);
+        if (file.open(QIODevice::WriteOnly | QIODevice::NewOnly)) break;
+    }
+    if (!file.isOpen()) {
+        qDebug() << "Match recording disabled:" << file.fileName() << file.errorString();
+    }
+    flush(); // Заголовок
+}
+
+MatchRecorder::~MatchRecorder() {
+    flush();
+}
+
+void MatchRecorder::flush() {
+    const std::vector<std::uint8_t> &bytes = writer.pending();
+    if (file.isOpen() && !bytes.empty()) {
+        file.write(reinterpret_cast<const char *>(bytes.data()), qint64(bytes.size()));
+        file.flush();
+    }
+    writer.clearPending();
+}
+
+void MatchRecorder::fleet(int side, const BoardModel &model) {
+    writer.fleet(now(), side, model);
+}
+
+void MatchRecorder::shot(int side, int x, int y, int result) {
+    if (!BoardModel::inBounds(x, y)) return;
+    writer.shot(now(), side, BoardModel::index(x, y), result);
+}
+
+void MatchRecorder::ability(int side, int type, QPoint cell) {
+    int idx = BoardModel::inBounds(cell.x(), cell.y()) ? BoardModel::index(cell.x(), cell.y()) : -1;
+    writer.ability(now(), side, type, idx);
+}
+
+void MatchRecorder::turn(int side) {
+    writer.turn(now(), side);
+    flush();
+}
+
+void MatchRecorder::end(int winner) {
+    writer.end(now(), winner);
+    flush();
+}
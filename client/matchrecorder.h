@@ -0,0 +1,41 @@
+#ifndef MATCHRECORDER_H
+#define MATCHRECORDER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QPoint>
+#include <QString>
+#include "matchlog.h"
+
+// Запись текущей партии в файл (формат — MatchLog). Файл только дописывается: накопленное
+// уходит на диск при смене хода и в конце партии, так что после сбоя теряется не больше хода.
+// Стороны: 1 — игрок, 2 — соперник (бот или игрок по сети).
+class MatchRecorder
+{
+public:
+    static const char *const FILE_SUFFIX; // ".mbrec"
+    static const int MAX_NAME_ATTEMPTS = 100; // Записей, начатых в одну миллисекунду
+
+    MatchRecorder(MatchLog::Mode mode, quint64 seed);
+    ~MatchRecorder(); // Дописывает остаток
+
+    // Каталог записей (создается при первой записи)
+    static QString replaysDir();
+    QString getPath() const { return file.fileName(); }
+
+    void fleet(int side, const BoardModel &model);
+    void shot(int side, int x, int y, int result);
+    void ability(int side, int type, QPoint cell = QPoint(-1, -1));
+    void turn(int side);
+    void end(int winner);
+
+private:
+    QFile file;
+    QElapsedTimer clock;
+    MatchLogWriter writer;
+
+    std::uint32_t now() const { return std::uint32_t(clock.elapsed()); }
+    void flush();
+};
+
+#endif // MATCHRECORDER_H
@@ -0,0 +1,176 @@
+#include "montecarlobot.h"
+#include <QtConcurrent>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <algorithm>
+
+namespace {
+
+// Попыток поставить очередной свободный корабль в одной выборке
+const int FREE_SHIP_ATTEMPTS = 64;
+
+// Одна расстановка оставшихся кораблей, совместимая со снимком. false — выборка не удалась.
+bool sampleLayout(const MonteCarloBot::Snapshot &snap, QRandomGenerator &rng, Bitboard &cells) {
+    int rem[FleetPlacer::MAX_SIZE + 1];
+    std::copy(std::begin(snap.remaining), std::end(snap.remaining), rem);
+    Bitboard occupied = snap.blocked; // Куда новый корабль ставить нельзя
+    cells = Bitboard();
+
+    // Сначала накрываем открытые попадания: младшее ненакрытое + случайная позиция через него
+    Bitboard uncovered = snap.openHits;
+    while (uncovered.any()) {
+        int h = uncovered.first();
+        const Placement *options[FleetPlacer::MAX_SIZE * 2 * FleetPlacer::MAX_SIZE];
+        int optionSizes[FleetPlacer::MAX_SIZE * 2 * FleetPlacer::MAX_SIZE];
+        int optionCount = 0;
+        for (int size = 1; size <= FleetPlacer::MAX_SIZE; ++size) {
+            if (!rem[size]) continue;
+            for (std::int16_t i : FleetPlacer::placementsAt(size, h)) {
+                const Placement &p = FleetPlacer::placement(size, i);
+                if (p.mask.intersects(occupied)) continue;
+                // Корабль не может касаться чужих попаданий
+                if ((p.halo & ~p.mask).intersects(snap.openHits)) continue;
+                optionSizes[optionCount] = size;
+                options[optionCount++] = &p;
+            }
+        }
+        if (optionCount == 0) return false;
+        int pick = rng.bounded(optionCount);
+        const Placement &p = *options[pick];
+        rem[optionSizes[pick]]--;
+        occupied |= p.halo;
+        cells |= p.mask;
+        uncovered &= ~p.mask;
+    }
+
+    // Остальные корабли — случайно, крупные первыми
+    for (int size = FleetPlacer::MAX_SIZE; size >= 1; --size) {
+        for (; rem[size] > 0; --rem[size]) {
+            int n = FleetPlacer::placementCount(size);
+            int attempt = 0;
+            for (; attempt < FREE_SHIP_ATTEMPTS; ++attempt) {
+                const Placement &p = FleetPlacer::placement(size, rng.bounded(n));
+                if (p.mask.intersects(occupied)) continue;
+                occupied |= p.halo;
+                cells |= p.mask;
+                break;
+            }
+            if (attempt == FREE_SHIP_ATTEMPTS) return false;
+        }
+    }
+    return true;
+}
+
+void mergeCounts(QVector<int> &acc, const QVector<int> &part) {
+    if (acc.isEmpty()) acc.fill(0, BoardModel::CELLS + 1);
+    for (int i = 0; i <= BoardModel::CELLS; ++i) acc[i] += part[i];
+}
+
+}
+
+MonteCarloBot::MonteCarloBot(QObject *parent) : QObject(parent) {}
+
+MonteCarloBot::~MonteCarloBot() {
+    // Рабочие задачи держат только копию снимка и токен — достаточно их остановить
+    cancel();
+}
+
+void MonteCarloBot::reset(const int *fleetSizes, int count) {
+    cancel();
+    tracker.reset(fleetSizes, count);
+}
+
+void MonteCarloBot::onShotResult(int x, int y, int result) {
+    tracker.onShotResult(x, y, result);
+}
+
+MonteCarloBot::Snapshot MonteCarloBot::snapshotOf(const DensityBot &tracker) {
+    Snapshot snap;
+    snap.shots = tracker.shotMask();
+    snap.blocked = tracker.blockedMask();
+    snap.openHits = tracker.openHitMask();
+    for (int size = 0; size <= FleetPlacer::MAX_SIZE; ++size) snap.remaining[size] = tracker.remainingShips(size);
+    return snap;
+}
+
+QVector<int> MonteCarloBot::sampleCounts(const Snapshot &snap, quint64 seed, int samples,
+                                         QDeadlineTimer deadline, const std::atomic_bool *cancelled) {
+    QVector<int> counts(BoardModel::CELLS + 1, 0);
+    QRandomGenerator rng(seed);
+    Bitboard open = ~snap.shots;
+    for (int i = 0; i < samples; ++i) {
+        if ((cancelled && *cancelled) || deadline.hasExpired()) break;
+        Bitboard cells;
+        if (!sampleLayout(snap, rng, cells)) continue;
+        cells &= open;
+        for (int idx = cells.popFirst(); idx >= 0; idx = cells.popFirst()) counts[idx]++;
+        counts[BoardModel::CELLS]++;
+    }
+    return counts;
+}
+
+int MonteCarloBot::pickCell(const Snapshot &snap, const QVector<int> &counts, QRandomGenerator &rng) {
+    if (counts.size() <= BoardModel::CELLS || counts[BoardModel::CELLS] == 0) return -1;
+    Bitboard allowed = ~(snap.shots | snap.blocked);
+    int best = 0;
+    int ties[BoardModel::CELLS];
+    int tieCount = 0;
+    for (Bitboard rest = allowed; rest.any();) {
+        int idx = rest.popFirst();
+        if (counts[idx] > best) { best = counts[idx]; tieCount = 0; }
+        if (counts[idx] == best && best > 0) ties[tieCount++] = idx;
+    }
+    return tieCount ? ties[rng.bounded(tieCount)] : -1;
+}
+
+void MonteCarloBot::cancel() {
+    if (currentToken) *currentToken = true;
+    currentToken.reset();
+}
+
+void MonteCarloBot::requestMove() {
+    cancel();
+    auto token = std::make_shared<std::atomic_bool>(false);
+    currentToken = token;
+
+    // По одной задаче на поток пула, у каждой свой генератор и доля выборок
+    int workers = std::max(1, QThreadPool::globalInstance()->maxThreadCount());
+    QVector<quint64> seeds;
+    for (int i = 0; i < workers; ++i) seeds.append(QRandomGenerator::global()->generate64());
+
+    Snapshot snap = snapshot();
+    int perWorker = std::max(1, maxSamples / workers);
+    QDeadlineTimer deadline(timeBudgetMs);
+
+    QFuture<QVector<int>> future = QtConcurrent::mappedReduced(
+        seeds,
+        [snap, perWorker, deadline, token](quint64 seed) {
+            return MonteCarloBot::sampleCounts(snap, seed, perWorker, deadline, token.get());
+        },
+        mergeCounts,
+        QtConcurrent::UnorderedReduce);
+
+    auto *watcher = new QFutureWatcher<QVector<int>>(this);
+    connect(watcher, &QFutureWatcher<QVector<int>>::finished, this, [this, watcher, token]() {
+        watcher->deleteLater();
+        if (*token) return; // Отменен или заменен новым запросом
+        currentToken.reset();
+        deliver(watcher->result());
+    });
+    watcher->setFuture(future);
+}
+
+int MonteCarloShooter::nextShot(QRandomGenerator &rng) {
+    MonteCarloBot::Snapshot snap = MonteCarloBot::snapshotOf(tracker);
+    QVector<int> counts = MonteCarloBot::sampleCounts(snap, rng.generate64(), samples,
+                                                      QDeadlineTimer(QDeadlineTimer::Forever), nullptr);
+    int cell = MonteCarloBot::pickCell(snap, counts, rng);
+    return cell >= 0 ? cell : tracker.nextShot(rng);
+}
+
+void MonteCarloBot::deliver(const QVector<int> &counts) {
+    int cell = pickCell(snapshot(), counts, *QRandomGenerator::global());
+    if (cell < 0) cell = tracker.nextShot(*QRandomGenerator::global());
+    if (cell < 0) return;
+    emit moveReady(cell % BoardModel::SIZE, cell / BoardModel::SIZE);
+}
@@ -0,0 +1,78 @@
+#ifndef MONTECARLOBOT_H
+#define MONTECARLOBOT_H
+
+#include <QObject>
+#include <QVector>
+#include <QDeadlineTimer>
+#include <QRandomGenerator>
+#include <atomic>
+#include <memory>
+#include "densitybot.h"
+
+// Бот Монте-Карло: сэмплирует тысячи расстановок флота, совместимых с наблюдениями,
+// параллельно на пуле потоков и стреляет в клетку, где корабль встречается чаще всего.
+// Расчет идет вне GUI-потока, результат приходит сигналом moveReady.
+class MonteCarloBot : public QObject
+{
+    Q_OBJECT
+public:
+    // Снимок наблюдений, который копируется в рабочие потоки
+    struct Snapshot {
+        Bitboard shots;
+        Bitboard blocked;
+        Bitboard openHits;
+        int remaining[FleetPlacer::MAX_SIZE + 1];
+    };
+
+    explicit MonteCarloBot(QObject *parent = nullptr);
+    ~MonteCarloBot();
+
+    void reset(const int *fleetSizes, int count);
+    void onShotResult(int x, int y, int result);
+
+    void setTimeBudget(int ms) { timeBudgetMs = ms; }
+    void setMaxSamples(int samples) { maxSamples = samples; }
+
+    // Запускает расчет хода; предыдущий незавершенный расчет отменяется
+    void requestMove();
+    // Отмена текущего расчета (например, при закрытии окна)
+    void cancel();
+
+    Snapshot snapshot() const { return snapshotOf(tracker); }
+    static Snapshot snapshotOf(const DensityBot &tracker);
+
+    // Ядро (синхронно, для одного потока): counts[0..99] — частоты кораблей, counts[100] — число удачных выборок
+    static QVector<int> sampleCounts(const Snapshot &snap, quint64 seed, int samples,
+                                     QDeadlineTimer deadline, const std::atomic_bool *cancelled);
+    // Лучшая клетка по частотам или -1, если выборок нет
+    static int pickCell(const Snapshot &snap, const QVector<int> &counts, QRandomGenerator &rng);
+
+signals:
+    void moveReady(int x, int y);
+
+private:
+    DensityBot tracker; // Учет наблюдений и запасной ход, если выборок не набралось
+    int timeBudgetMs = 150;
+    int maxSamples = 20000;
+    std::shared_ptr<std::atomic_bool> currentToken;
+
+    void deliver(const QVector<int> &counts);
+};
+
+// Синхронный вариант для одного потока (турнир ботов): фиксированное число выборок на ход
+class MonteCarloShooter : public Shooter
+{
+public:
+    explicit MonteCarloShooter(int samples = 2000) : samples(samples) {}
+
+    const char *name() const override { return "montecarlo"; }
+    void reset(const int *fleetSizes, int count) override { tracker.reset(fleetSizes, count); }
+    int nextShot(QRandomGenerator &rng) override;
+    void onShotResult(int x, int y, int result) override { tracker.onShotResult(x, y, result); }
+
+private:
+    DensityBot tracker;
+    int samples;
+};
+
+#endif // MONTECARLOBOT_H
@@ -1,4 +1,4 @@
-QT       += core gui widgets
+QT       += core gui widgets network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -9,18 +9,56 @@ CONFIG += c++17
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    animationclock.cpp \
+    boardmodel.cpp \
     boardwidget.cpp \
+    createserverdialog.cpp \
+    densitybot.cpp \
+    fleetplacer.cpp \
+    framereader.cpp \
     gamewindow.cpp \
+    latencystats.cpp \
     loginwindow.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    matchlog.cpp \
+    matchrecorder.cpp \
+    montecarlobot.cpp \
+    multiplayergamewindow.cpp \
+    networkclient.cpp \
+    queuebot.cpp \
+    replaywindow.cpp \
+    rpswidget.cpp \
+    spectatorwindow.cpp \
+    transport.cpp \
+    wireprotocol.cpp
 
 HEADERS += \
     Ship.h \
+    animationclock.h \
+    boardmodel.h \
     boardwidget.h \
+    createserverdialog.h \
+    densitybot.h \
+    fleetplacer.h \
+    framereader.h \
     gamewindow.h \
+    latencystats.h \
     loginwindow.h \
-    mainwindow.h
+    mainwindow.h \
+    matchlog.h \
+    matchrecorder.h \
+    montecarlobot.h \
+    multiplayergamewindow.h \
+    networkclient.h \
+    queuebot.h \
+    replaywindow.h \
+    rpswidget.h \
+    shooter.h \
+    spectatorwindow.h \
+    spscqueue.h \
+    transport.h \
+    wireprotocol.h
 
 FORMS += \
     mainwindow.ui
@@ -1,12 +1,13 @@
 #include "multiplayergamewindow.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
-#include <QMessageBox>
 #include <QPainter>
 #include <QRandomGenerator>
 #include <QEvent>
 #include <QMouseEvent>
 #include <QCursor>
+#include <QDebug>
+#include "animationclock.h"
 
 MultiplayerGameWindow::MultiplayerGameWindow(NetworkClient *client, bool isHost, const QString &playerAvatarPath, QWidget *parent)
     : QWidget(parent), netClient(client), isHost(isHost), currentPlayerAvatarPath(playerAvatarPath),
@@ -23,20 +24,23 @@ MultiplayerGameWindow::MultiplayerGameWindow(NetworkClient *client, bool isHost,
     killPhrases << "НА ДНО!" << "УНИЧТОЖЕН!" << "МИНУС ОДИН!";
     missPhrases << "МИМО!" << "В МОЛОКО" << "НЕ ПОПАЛ";
 
-    shakeTimer = new QTimer(this);
-    shakeTimer->setInterval(30);
-    connect(shakeTimer, &QTimer::timeout, this, &MultiplayerGameWindow::updateShake);
 
     // Подключение к сигналам сети
     connect(netClient, &NetworkClient::opponentReady, this, &MultiplayerGameWindow::onOpponentReady);
     connect(netClient, &NetworkClient::opponentRPS, this, &MultiplayerGameWindow::onOpponentRPS);
     connect(netClient, &NetworkClient::opponentFired, this, &MultiplayerGameWindow::onOpponentFired);
+    connect(netClient, &NetworkClient::opponentShotResolved, this, &MultiplayerGameWindow::onOpponentShotResolved);
     connect(netClient, &NetworkClient::fireResultReceived, this, &MultiplayerGameWindow::onFireResultReceived);
+    connect(netClient, &NetworkClient::opponentFiredBatch, this, &MultiplayerGameWindow::onOpponentFiredBatch);
+    connect(netClient, &NetworkClient::opponentBatchResolved, this, &MultiplayerGameWindow::onOpponentBatchResolved);
+    connect(netClient, &NetworkClient::fireBatchResultReceived, this, &MultiplayerGameWindow::onFireBatchResultReceived);
     connect(netClient, &NetworkClient::chatMessageReceived, this, &MultiplayerGameWindow::onChatMessageReceived);
     connect(netClient, &NetworkClient::disconnected, this, &MultiplayerGameWindow::onExitToMenuClicked);
+    connect(netClient, &NetworkClient::reconnecting, this, &MultiplayerGameWindow::onReconnecting);
+    connect(netClient, &NetworkClient::resumed, this, &MultiplayerGameWindow::onResumed);
+    connect(netClient, &NetworkClient::latencyUpdated, this, &MultiplayerGameWindow::onLatencyUpdated);
     connect(netClient, &NetworkClient::turnChanged, this, &MultiplayerGameWindow::onTurnChanged);
 
-    initShips();
     setupUI();
 
     if (!currentPlayerAvatarPath.isEmpty()) {
@@ -45,26 +49,7 @@ MultiplayerGameWindow::MultiplayerGameWindow(NetworkClient *client, bool isHost,
 }
 
 MultiplayerGameWindow::~MultiplayerGameWindow() {
-    qDeleteAll(playerShips);
-    qDeleteAll(enemyShips);
-}
-
-void MultiplayerGameWindow::initShips() {
-    int id = 0;
-    auto createFleet = [&](QVector<Ship*>& fleet) {
-        fleet.push_back(new Ship(id++, 4));
-        fleet.push_back(new Ship(id++, 3));
-        fleet.push_back(new Ship(id++, 3));
-        fleet.push_back(new Ship(id++, 2));
-        fleet.push_back(new Ship(id++, 2));
-        fleet.push_back(new Ship(id++, 2));
-        fleet.push_back(new Ship(id++, 1));
-        fleet.push_back(new Ship(id++, 1));
-        fleet.push_back(new Ship(id++, 1));
-        fleet.push_back(new Ship(id++, 1));
-    };
-    createFleet(playerShips);
-    createFleet(enemyShips);
+    delete recorder;
 }
 
 void MultiplayerGameWindow::setupUI() {
@@ -90,8 +75,14 @@ void MultiplayerGameWindow::setupUI() {
         );
     connect(exitToMenuBtn, &QPushButton::clicked, this, &MultiplayerGameWindow::onExitToMenuClicked);
 
+    // Индикатор связи: обновляется раз в секунду по пингу
+    latencyLabel = new QLabel("ПИНГ —", this);
+    latencyLabel->setStyleSheet("color: #bdc3c7; font-weight: bold; font-size: 14px; font-family: 'Courier New';");
+
     headerLayout->addWidget(gameTitle);
     headerLayout->addStretch();
+    headerLayout->addWidget(latencyLabel);
+    headerLayout->addSpacing(20);
     headerLayout->addWidget(exitToMenuBtn);
     globalLayout->addWidget(headerWidget);
 
@@ -120,7 +111,7 @@ void MultiplayerGameWindow::setupUI() {
     playerTitle->setStyleSheet("font-weight: bold; color: #333; font-size: 18px; margin-bottom: 5px;");
 
     playerBoard = new BoardWidget(this);
-    playerBoard->setShips(playerShips);
+    playerBoard->setShips(fleets.player(), FLEET_SHIP_COUNT);
     playerBoard->setEditable(true);
     playerBoard->setShowShips(true);
     playerBoard->setupSizePolicy();
@@ -199,9 +190,7 @@ void MultiplayerGameWindow::setupUI() {
     connect(ability2, &AbilityWidget::clicked, this, &MultiplayerGameWindow::onAbilityClicked);
     connect(ability3, &AbilityWidget::clicked, this, &MultiplayerGameWindow::onAbilityClicked);
 
-    ability1->setAvailable(true);
-    ability2->setAvailable(true);
-    ability3->setAvailable(true);
+    updateAbilitiesState();
 
     absLayout->addWidget(ability1);
     absLayout->addWidget(ability2);
@@ -240,7 +229,7 @@ void MultiplayerGameWindow::setupUI() {
     enemyTitle->setStyleSheet("font-weight: bold; color: #333; font-size: 18px; margin-bottom: 5px;");
 
     enemyBoard = new BoardWidget(this);
-    enemyBoard->setShips(enemyShips);
+    enemyBoard->setShips(fleets.enemy(), FLEET_SHIP_COUNT);
     enemyBoard->setEnemy(true);
     enemyBoard->setEditable(false);
     enemyBoard->setShowShips(false);
@@ -280,7 +269,22 @@ void MultiplayerGameWindow::onStartBattleClicked() {
     randomPlaceBtn->hide();
     playerBoard->setEditable(false);
 
-    netClient->sendReady();
+    // Расстановка нужна серверу, который сам отвечает на выстрелы (клиент пошлет ее только такому)
+    QVector<NetworkClient::FleetShip> fleet;
+    const BoardModel &model = playerBoard->model();
+    for (int slot = 0; slot < model.shipCount(); ++slot) {
+        Bitboard mask = model.shipMaskOf(slot);
+        int bow = mask.first();
+        int size = mask.count();
+        fleet.append({bow % 10, bow / 10, size, size > 1 && mask.test(bow + 10)});
+    }
+    netClient->sendReady(fleet);
+
+    quint32 seed = QRandomGenerator::global()->generate();
+    matchRng.seed(seed);
+    delete recorder;
+    recorder = new MatchRecorder(MatchLog::ModeMultiplayer, seed);
+    recorder->fleet(1, model);
 
     if (opponentIsReady) {
         startRPS();
@@ -365,6 +369,7 @@ void MultiplayerGameWindow::onTurnChanged(const QString &who) {
     if (!isHost && who == "Player2") isMyTurnNow = true;
 
     isPlayerTurn = isMyTurnNow;
+    if (recorder) recorder->turn(isMyTurnNow ? 1 : 2);
 
     if (isPlayerTurn) {
         infoLabel->setText("ВАШ ХОД!");
@@ -390,38 +395,194 @@ void MultiplayerGameWindow::updateTurnVisuals() {
 
 void MultiplayerGameWindow::onPlayerBoardClick(int x, int y) {
     if (!isBattleStarted || !isPlayerTurn || isGameOver || isAnimating) return;
-    if (!enemyBoard->canShootAt(x, y)) return;
+    if (!enemyBoard->canShootAt(x, y) && !isClusterMode) return;
+
+    if (isRadarActive && QPoint(x, y) == radarCell) {
+        isRadarActive = false;
+        radarCell = QPoint(-1, -1);
+        enemyBoard->setHighlight(radarCell);
+    }
 
     isAnimating = true;
+    if (isClusterMode) {
+        // Весь залп 3x3 — одним сообщением, результаты придут одним ответом
+        isClusterMode = false;
+        if (recorder) recorder->ability(1, 3, QPoint(x, y));
+        QVector<QPoint> salvo;
+        salvo.append(QPoint(x, y));
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int nx = x + dx;
+                int ny = y + dy;
+                if ((dx || dy) && nx >= 0 && nx < 10 && ny >= 0 && ny < 10) salvo.append(QPoint(nx, ny));
+            }
+        }
+        enemyBoard->setActive(false);
+        enemyBoard->animateSalvo(salvo);
+        netClient->sendFireBatch(WireProtocol::BatchFire, salvo);
+        netClient->flushNow();
+        return;
+    }
     enemyBoard->setActive(false);
     enemyBoard->animateShot(x, y);
     netClient->sendFire(x, y);
+    netClient->flushNow();
 }
 
 void MultiplayerGameWindow::onOpponentFired(int x, int y) {
+    int result = takeOpponentShot(x, y);
+    netClient->sendFireResult(x, y, result);
+    netClient->flushNow();
+}
+
+void MultiplayerGameWindow::onOpponentShotResolved(int x, int y, int status) {
+    // Сервер уже ответил стрелявшему — только отражаем выстрел у себя
+    int result = takeOpponentShot(x, y);
+    if (result != status) qDebug() << "Server shot result mismatch at" << x << y << status << result;
+}
+
+void MultiplayerGameWindow::onOpponentFiredBatch(int mode, const QVector<QPoint> &cells) {
+    if (mode == WireProtocol::BatchFog) {
+        isEnemyFogged = true;
+        enemyBoard->setFog(true);
+        enemyMessage->showMessage("ТУМАН!");
+        if (recorder) recorder->ability(2, 1);
+        return;
+    }
+
+    QVector<int> results;
+    if (mode == WireProtocol::BatchFire) {
+        results = takeOpponentSalvo(cells);
+    } else {
+        // Радар: отмечаем одну случайную клетку с целым кораблем среди присланных
+        results.fill(0, cells.size());
+        const BoardModel &model = playerBoard->model();
+        Bitboard alive = model.shipsMask() & ~model.hits();
+        QVector<int> found;
+        for (int i = 0; i < cells.size(); ++i) {
+            if (alive.test(BoardModel::index(cells[i].x(), cells[i].y()))) found.append(i);
+        }
+        int target = found.isEmpty() ? -1 : found[matchRng.bounded(int(found.size()))];
+        if (target >= 0) results[target] = 1;
+        if (recorder) recorder->ability(2, 2, target >= 0 ? cells[target] : QPoint(-1, -1));
+    }
+    netClient->sendFireBatchResult(mode, cells, results);
+    netClient->flushNow();
+}
+
+void MultiplayerGameWindow::onOpponentBatchResolved(int mode, const QVector<QPoint> &cells, const QVector<int> &results) {
+    // Сервер уже ответил стрелявшему (радар до нас не доходит)
+    if (mode != WireProtocol::BatchFire) return;
+    QVector<int> local = takeOpponentSalvo(cells);
+    if (local != results) qDebug() << "Server salvo result mismatch" << results << local;
+}
+
+QVector<int> MultiplayerGameWindow::takeOpponentSalvo(const QVector<QPoint> &cells) {
+    QVector<int> results;
+    int hits = 0;
+    if (recorder && !cells.isEmpty()) recorder->ability(2, 3, cells.first());
+    for (const QPoint &cell : cells) {
+        int result = playerBoard->receiveShot(cell.x(), cell.y());
+        if (recorder) recorder->shot(2, cell.x(), cell.y(), result);
+        if (result > 0) ++hits;
+        results.append(result);
+    }
+    playerBoard->animateSalvo(cells);
+
+    if (hits > 0) {
+        shakeScreen();
+        enemyMessage->showMessage("АВИАУДАР!");
+        checkGameStatus();
+    } else {
+        onOpponentMiss();
+        playerMessage->showMessage(getRandomPhrase(missPhrases));
+    }
+    return results;
+}
+
+void MultiplayerGameWindow::onFireBatchResultReceived(int mode, const QVector<QPoint> &cells, const QVector<int> &results) {
+    isAnimating = false;
+    if (mode == WireProtocol::BatchScan) {
+        int target = results.indexOf(1);
+        if (target >= 0 && target < cells.size()) {
+            radarCell = cells[target];
+            isRadarActive = true;
+            if (recorder) recorder->ability(1, 2, radarCell);
+            addMana(-80);
+            enemyBoard->setHighlight(radarCell);
+            playerMessage->showMessage("РАДАР: ЦЕЛЬ!");
+        } else {
+            playerMessage->showMessage("НЕКОГО ИСКАТЬ!");
+        }
+        if (isPlayerTurn) enemyBoard->setActive(true);
+        return;
+    }
+
+    int hits = 0;
+    for (int i = 0; i < cells.size() && i < results.size(); ++i) {
+        if (recorder) recorder->shot(1, cells[i].x(), cells[i].y(), results[i]);
+        if (results[i] < 0) continue; // Сюда уже стреляли
+        enemyBoard->setCellState(cells[i].x(), cells[i].y(), results[i] == 0 ? CellState::Miss : CellState::Hit);
+        if (results[i] > 0) ++hits;
+    }
+
+    if (hits > 0) {
+        // Было попадание — ход наш (смену хода пришлет сервер только после промаха)
+        resetMana();
+        playerMessage->showMessage("СЕРИЯ: УСПЕХ!");
+        enemyBoard->setActive(true);
+        checkGameStatus();
+    } else {
+        playerMessage->showMessage(getRandomPhrase(missPhrases));
+        onOwnMiss();
+    }
+}
+
+void MultiplayerGameWindow::onOwnMiss() {
+    addMana(20);
+    // Промах снимает туман соперника
+    if (isEnemyFogged) {
+        isEnemyFogged = false;
+        enemyBoard->setFog(false);
+    }
+}
+
+void MultiplayerGameWindow::onOpponentMiss() {
+    if (isFogActive) {
+        isFogActive = false;
+        playerBoard->setFog(false);
+        playerMessage->showMessage("ТУМАН РАССЕЯЛСЯ");
+    }
+}
+
+int MultiplayerGameWindow::takeOpponentShot(int x, int y) {
     int result = playerBoard->receiveShot(x, y);
+    if (recorder) recorder->shot(2, x, y, result);
     if (result > 0) shakeScreen();
     playerBoard->animateShot(x, y);
 
-    netClient->sendFireResult(x, y, result);
-
     if (result == 0) {
         playerMessage->showMessage(getRandomPhrase(missPhrases));
+        onOpponentMiss();
     } else {
         if (result == 1) playerMessage->showMessage("ПОПАДАНИЕ!");
         else playerMessage->showMessage("КОРАБЛЬ УНИЧТОЖЕН!");
         checkGameStatus();
     }
+    return result;
 }
 
 void MultiplayerGameWindow::onFireResultReceived(int x, int y, int status) {
     isAnimating = false;
+    if (recorder) recorder->shot(1, x, y, status);
     CellState st = (status == 0) ? CellState::Miss : CellState::Hit;
     enemyBoard->setCellState(x, y, st);
 
     if (status == 0) {
         playerMessage->showMessage(getRandomPhrase(missPhrases));
+        onOwnMiss();
     } else {
+        resetMana();
         enemyBoard->setActive(true);
         if (status == 2) playerMessage->showMessage(getRandomPhrase(killPhrases));
         else playerMessage->showMessage(getRandomPhrase(hitPhrases));
@@ -437,18 +598,16 @@ void MultiplayerGameWindow::checkGameStatus() {
     if (playerBoard->isAllDestroyed()) {
         endGame(false);
     } else {
-        int hits = 0;
-        for(int x=0; x<10; ++x)
-            for(int y=0; y<10; ++y)
-                if (enemyBoard->getCellState(x, y) == CellState::Hit) hits++;
-
-        if (hits >= 20) endGame(true);
+        // Корабли противника нам неизвестны — считаем подтвержденные попадания
+        if (enemyBoard->model().hits().count() >= 20) endGame(true);
     }
 }
 
 void MultiplayerGameWindow::endGame(bool playerWon) {
     isGameOver = true;
     isBattleStarted = false;
+    isPlayerWinner = playerWon;
+    if (recorder) recorder->end(playerWon ? 1 : 2);
     enemyBoard->setEnabled(false);
     battlePanel->hide();
     finishGameBtn->show();
@@ -465,21 +624,99 @@ void MultiplayerGameWindow::endGame(bool playerWon) {
     }
 }
 
+// --- СПОСОБНОСТИ ---
+// Каждая — одно сообщение fire_batch: туман без ответа, радар и авиаудар — один ответ на весь залп
+
 void MultiplayerGameWindow::onAbilityClicked(int type) {
-    QMessageBox::information(this, "Способности",
-                             "В данной версии сервера способности отключены.\nИграйте в классический режим!");
+    if (!isBattleStarted || !isPlayerTurn || isAnimating || isGameOver) return;
+
+    if (type == 1 && playerMana >= 60) {
+        isFogActive = true;
+        addMana(-60);
+        playerBoard->setFog(true);
+        playerMessage->showMessage("ТУМАН!");
+        if (recorder) recorder->ability(1, 1);
+        netClient->sendFireBatch(WireProtocol::BatchFog, QVector<QPoint>());
+        netClient->flushNow();
+    } else if (type == 2 && playerMana >= 80) {
+        // Соперник (или сервер) выбирает цель среди клеток, куда мы еще не стреляли; мана — по ответу
+        QVector<QPoint> unknown;
+        for (int y = 0; y < 10; ++y) {
+            for (int x = 0; x < 10; ++x) {
+                if (enemyBoard->canShootAt(x, y)) unknown.append(QPoint(x, y));
+            }
+        }
+        isAnimating = true;
+        enemyBoard->setActive(false);
+        netClient->sendFireBatch(WireProtocol::BatchScan, unknown);
+        netClient->flushNow();
+    } else if (type == 3 && playerMana >= 100) {
+        isClusterMode = true;
+        addMana(-100);
+        playerMessage->showMessage("КЛАСТЕРНЫЙ УДАР!");
+        enemyMessage->showMessage("АВИАУДАР ГОТОВ!");
+    }
+}
+
+void MultiplayerGameWindow::addMana(int amount) {
+    playerMana = qBound(0, playerMana + amount, 100);
+    manaBar->setMana(playerMana);
+    updateAbilitiesState();
+}
+
+void MultiplayerGameWindow::resetMana() {
+    playerMana = 0;
+    manaBar->setMana(playerMana);
+    updateAbilitiesState();
+}
+
+void MultiplayerGameWindow::updateAbilitiesState() {
+    ability1->setAvailable(playerMana >= ability1->getCost());
+    ability2->setAvailable(playerMana >= ability2->getCost());
+    ability3->setAvailable(playerMana >= ability3->getCost());
 }
 
 void MultiplayerGameWindow::onExitToMenuClicked() {
+    netClient->endMatch();
     emit backToMenu();
     this->close();
 }
 
 void MultiplayerGameWindow::onFinishGameClicked() {
+    netClient->endMatch();
     emit backToMenu();
     this->close();
 }
 
+// Связь пропала посреди матча. Ходы можно делать и сейчас — клиент дошлет их после возобновления.
+void MultiplayerGameWindow::onReconnecting(int attempt, int delayMs) {
+    Q_UNUSED(delayMs)
+    if (!isReconnecting) {
+        isReconnecting = true;
+        infoBeforeReconnect = infoLabel->text();
+    }
+    infoLabel->setText(QString("НЕТ СВЯЗИ...\nПОПЫТКА %1").arg(attempt));
+}
+
+void MultiplayerGameWindow::onLatencyUpdated(int rttMs, int p95Ms, int jitterMs, int lossPercent) {
+    QString color = "#27ae60";
+    if (rttMs >= 200 || lossPercent >= 10) color = "#e74c3c";
+    else if (rttMs >= 80 || lossPercent > 0) color = "#f1c40f";
+    latencyLabel->setText(QString("ПИНГ %1 мс").arg(rttMs));
+    latencyLabel->setStyleSheet("color: " + color + "; font-weight: bold; font-size: 14px; font-family: 'Courier New';");
+    latencyLabel->setToolTip(QString("95% пингов быстрее %1 мс\nДжиттер %2 мс\nПотери %3%")
+                             .arg(p95Ms).arg(jitterMs).arg(lossPercent));
+}
+
+void MultiplayerGameWindow::onResumed() {
+    if (!isReconnecting) return;
+    isReconnecting = false;
+    // Пока не было связи, могли смениться ход или закончиться игра — табло по текущему состоянию
+    if (isGameOver) infoLabel->setText(isPlayerWinner ? "ПОБЕДА!" : "ПОРАЖЕНИЕ");
+    else if (isBattleStarted) infoLabel->setText(isPlayerTurn ? "ВАШ ХОД!" : "ХОД\nПРОТИВНИКА");
+    else infoLabel->setText(infoBeforeReconnect);
+}
+
 void MultiplayerGameWindow::onChatMessageReceived(const QString &msg) {
     enemyMessage->showMessage(msg);
 }
@@ -508,14 +745,14 @@ void MultiplayerGameWindow::updateShake() {
         shakeFrames--;
     } else {
         this->move(originalPos);
-        shakeTimer->stop();
+        AnimationClock::instance()->stop(this);
     }
 }
 
 void MultiplayerGameWindow::shakeScreen() {
     originalPos = this->pos();
     shakeFrames = 10;
-    shakeTimer->start();
+    AnimationClock::instance()->repeat(this, AnimationClock::SHAKE_MS, [this]() { updateShake(); });
 }
 
 bool MultiplayerGameWindow::eventFilter(QObject *watched, QEvent *event) {
@@ -10,6 +10,7 @@
 #include <QPixmap>
 #include "boardwidget.h"
 #include "networkclient.h"
+#include "matchrecorder.h"
 #include "gamewindow.h" // Для переиспользования классов UI (Avatar, ManaBar и т.д.)
 #include "RPSWidget.h"
 
@@ -44,9 +45,16 @@ private slots:
     void onOpponentReady();
     void onOpponentRPS(int shapeId);
     void onOpponentFired(int x, int y);
+    void onOpponentShotResolved(int x, int y, int status);
     void onFireResultReceived(int x, int y, int status);
+    void onOpponentFiredBatch(int mode, const QVector<QPoint> &cells);
+    void onOpponentBatchResolved(int mode, const QVector<QPoint> &cells, const QVector<int> &results);
+    void onFireBatchResultReceived(int mode, const QVector<QPoint> &cells, const QVector<int> &results);
     void onChatMessageReceived(const QString &msg);
     void onTurnChanged(const QString &who);
+    void onReconnecting(int attempt, int delayMs);
+    void onResumed();
+    void onLatencyUpdated(int rttMs, int p95Ms, int jitterMs, int lossPercent);
 
     // RPS Logic
     void startRPS();
@@ -87,17 +95,38 @@ private:
     MessageBubble *enemyMessage;
 
     // Game State
-    QVector<Ship*> playerShips;
-    QVector<Ship*> enemyShips;
+    MatchFleets fleets; // Флот соперника нужен только для отрисовки поля
 
     bool isPlayerTurn;
     bool isBattleStarted;
     bool isGameOver;
+    bool isPlayerWinner = false;
     bool isAnimating;
 
     bool iAmReady;
     bool opponentIsReady;
 
+    // Мана и способности (залпы идут одним fire_batch)
+    int playerMana = 0;
+    void addMana(int amount);
+    void resetMana();
+    void updateAbilitiesState();
+
+    bool isFogActive = false;   // Наш туман: соперник не видит своих выстрелов до промаха
+    bool isEnemyFogged = false; // Туман соперника: мы стреляем вслепую до промаха
+    bool isRadarActive = false;
+    QPoint radarCell = QPoint(-1, -1);
+    bool isClusterMode = false;
+
+    // Запись партии: свой флот известен, флот соперника — только по результатам выстрелов.
+    // Случайный выбор цели радара соперника — от seed записи.
+    QRandomGenerator matchRng;
+    MatchRecorder *recorder = nullptr;
+
+    bool isReconnecting = false;
+    QString infoBeforeReconnect; // Текст табло в момент обрыва (onReconnecting); onResumed возвращает его только до начала боя
+    QLabel *latencyLabel;
+
     // RPS State
     RPSWidget *rpsOverlay;
     RPSType myRPSShape;
@@ -109,15 +138,17 @@ private:
     QStringList killPhrases;
     QStringList missPhrases;
 
-    QTimer *shakeTimer;
     QPoint originalPos;
     int shakeFrames;
     void shakeScreen();
 
     void setupUI();
-    void initShips();
     void updateTurnVisuals();
     void checkGameStatus();
+    int takeOpponentShot(int x, int y);
+    QVector<int> takeOpponentSalvo(const QVector<QPoint> &cells);
+    void onOwnMiss();
+    void onOpponentMiss();
     void endGame(bool playerWon);
     QString getRandomPhrase(const QStringList &list);
 
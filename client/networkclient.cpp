@@ -1,163 +1,1080 @@
 #include "networkclient.h"
 #include <QDebug>
+#include <QRandomGenerator>
 
 NetworkClient::NetworkClient(QObject *parent) : QObject(parent)
 {
-    socket = new QTcpSocket(this);
+    // Сокет и таймеры висят на отдельном объекте-контексте: его можно целиком перенести в поток сети
+    ioContext = new QObject;
+    transport = new TcpTransport(ioContext);
 
-    connect(socket, &QTcpSocket::connected, this, &NetworkClient::connected);
-    connect(socket, &QTcpSocket::disconnected, this, &NetworkClient::disconnected);
-    connect(socket, &QTcpSocket::readyRead, this, &NetworkClient::onReadyRead);
-    connect(socket, static_cast<void(QTcpSocket::*)(QAbstractSocket::SocketError)>(&QTcpSocket::errorOccurred),
-            this, &NetworkClient::onSocketError);
+    negotiationTimer = new QTimer(ioContext);
+    negotiationTimer->setSingleShot(true);
+    connect(negotiationTimer, &QTimer::timeout, ioContext, [this]() {
+        finishNegotiation(ProtocolJson);
+        if (reconnectingState) failResume(); // Сервер молчит на hello — матч он не вернет
+    });
+
+    flushTimer = new QTimer(ioContext);
+    flushTimer->setSingleShot(true);
+    flushTimer->setTimerType(Qt::PreciseTimer);
+    connect(flushTimer, &QTimer::timeout, ioContext, [this]() { flushOutbound(); });
+
+    reconnectTimer = new QTimer(ioContext);
+    reconnectTimer->setSingleShot(true);
+    connect(reconnectTimer, &QTimer::timeout, ioContext, [this]() {
+        transport->open(host, port);
+    });
+
+    ackTimer = new QTimer(ioContext);
+    ackTimer->setSingleShot(true);
+    connect(ackTimer, &QTimer::timeout, ioContext, [this]() { sendAck(); });
+
+    heartbeatTimer = new QTimer(ioContext);
+    heartbeatTimer->setInterval(PING_INTERVAL_MS);
+    connect(heartbeatTimer, &QTimer::timeout, ioContext, [this]() { onHeartbeat(); });
+    clock.start();
+
+    attachTransport();
 }
 
-void NetworkClient::connectToServer(const QString &ip, int port)
+NetworkClient::NetworkClient(Transport *customTransport, QObject *parent) : NetworkClient(parent)
+{
+    delete transport;
+    transport = customTransport;
+    transport->setParent(ioContext);
+    attachTransport();
+}
+
+void NetworkClient::attachTransport()
+{
+    connect(transport, &Transport::connected, ioContext, [this]() { onConnected(); });
+    connect(transport, &Transport::disconnected, ioContext, [this]() { onDisconnected(); });
+    connect(transport, &Transport::readyRead, ioContext, [this]() { onReadyRead(); });
+    connect(transport, &Transport::errorOccurred, ioContext,
+            [this](const QString &message) { onTransportError(message); });
+}
+
+NetworkClient::~NetworkClient()
 {
-    if (socket->state() != QAbstractSocket::ConnectedState) {
-        socket->abort();
-        socket->connectToHost(ip, port);
+    if (thread) {
+        // Сокет удаляется в своем потоке при его остановке
+        connect(thread, &QThread::finished, ioContext, &QObject::deleteLater);
+        thread->quit();
+        thread->wait();
+        delete thread;
+    } else {
+        delete ioContext;
     }
 }
 
+void NetworkClient::startNetworkThread()
+{
+    if (thread) return;
+    thread = new QThread;
+    thread->setObjectName("NetworkClient");
+    ioContext->moveToThread(thread);
+    thread->start();
+}
+
+void NetworkClient::connectToServer(const QString &ip, int port)
+{
+    auto connectSocket = [this, ip, port]() {
+        if (!transport->isOpen()) {
+            // Новое подключение по просьбе пользователя — прежний матч уже не вернуть
+            reconnectTimer->stop();
+            reconnectingState = false;
+            inMatch = false;
+            sessionToken.clear();
+            unacked.clear();
+            host = ip;
+            this->port = quint16(port);
+            transport->open(ip, quint16(port));
+        }
+    };
+    if (thread) QMetaObject::invokeMethod(ioContext, connectSocket, Qt::QueuedConnection);
+    else connectSocket();
+}
+
 bool NetworkClient::isConnected() const {
-    return socket->state() == QAbstractSocket::ConnectedState;
+    return connectedState;
+}
+
+NetworkClient::WriteStats NetworkClient::getWriteStats() const {
+    if (!thread || QThread::currentThread() == thread) return writeStats;
+    WriteStats copy;
+    QMetaObject::invokeMethod(ioContext, [this, &copy]() { copy = writeStats; }, Qt::BlockingQueuedConnection);
+    return copy;
+}
+
+qint64 NetworkClient::getReceivedMessages() const {
+    if (!thread || QThread::currentThread() == thread) return receivedMessages;
+    qint64 count = 0;
+    QMetaObject::invokeMethod(ioContext, [this, &count]() { count = receivedMessages; }, Qt::BlockingQueuedConnection);
+    return count;
+}
+
+LatencyStats NetworkClient::getLatencyStats() const {
+    if (!thread || QThread::currentThread() == thread) return latency;
+    LatencyStats copy;
+    QMetaObject::invokeMethod(ioContext, [this, &copy]() { copy = latency; }, Qt::BlockingQueuedConnection);
+    return copy;
+}
+
+// --- Outbound commands ---
+
+void NetworkClient::submit(Command cmd) {
+    if (!thread) {
+        execute(cmd);
+        return;
+    }
+    bool queued = false;
+    if (overflowing) {
+        // Список переполнения еще не разобран: новые команды только за ним
+        QMutexLocker lock(&overflowMutex);
+        if (overflowing) {
+            overflow.append(std::move(cmd));
+            queued = true;
+        }
+    }
+    if (!queued && !commands.push(std::move(cmd))) {
+        // Очередь полна (поток сети занят): команда и все следующие — в список после кольца
+        QMutexLocker lock(&overflowMutex);
+        overflowing = true;
+        overflow.append(std::move(cmd));
+    }
+    // Одно событие на пачку команд: поток сети разбирает все, что успело накопиться
+    if (!wakePending.exchange(true)) {
+        QMetaObject::invokeMethod(ioContext, [this]() { drainCommands(); }, Qt::QueuedConnection);
+    }
+}
+
+void NetworkClient::drainCommands() {
+    wakePending = false;
+    Command cmd;
+    while (commands.pop(cmd)) execute(cmd);
+
+    // Отложенные при переполнении — строго после кольца. Пока флаг поднят, в кольцо ничего не добавляется,
+    // так что команды, оставшиеся в кольце на момент взятия списка, поставлены раньше него.
+    for (;;) {
+        QVector<Command> spilled;
+        {
+            QMutexLocker lock(&overflowMutex);
+            if (overflow.isEmpty()) {
+                overflowing = false;
+                break;
+            }
+            spilled.swap(overflow);
+        }
+        while (commands.pop(cmd)) execute(cmd);
+        for (const Command &spilledCmd : spilled) execute(spilledCmd);
+    }
+}
+
+void NetworkClient::endMatch() {
+    Command cmd;
+    cmd.kind = CmdEndMatch;
+    submit(cmd);
+}
+
+void NetworkClient::execute(const Command &cmd) {
+    if (cmd.kind == CmdEndMatch) {
+        if (inMatch) logMatchLatency();
+        inMatch = false;
+        unacked.clear();
+        if (reconnectingState) {
+            reconnectingState = false;
+            reconnectTimer->stop();
+            transport->abort();
+        }
+        return;
+    }
+    if (isGameCommand(cmd.kind) && inMatch && !sessionToken.isEmpty()) {
+        // Игровое сообщение получает номер и ждет подтверждения: после обрыва его дошлем заново.
+        // Пока связи нет, только копим — уйдут при возобновлении.
+        Command numbered = cmd;
+        numbered.seq = ++sentSeq;
+        unacked.append(numbered);
+        if (unacked.size() > REPLAY_LIMIT) unacked.removeFirst();
+        if (!reconnectingState) encode(numbered);
+        return;
+    }
+    encode(cmd);
+}
+
+void NetworkClient::encode(const Command &cmd) {
+    QJsonObject json;
+    if (cmd.seq) json["seq"] = qint64(cmd.seq); // В кадрах номер не пишется: сервер считает их по порядку
+    switch (cmd.kind) {
+    case CmdCreateLobby:
+        json["action"] = "create_game";
+        json["data"] = cmd.text;
+        sendJson(json);
+        break;
+    case CmdJoinLobby:
+        json["action"] = "join_game";
+        json["gameId"] = cmd.text;
+        sendJson(json);
+        break;
+    case CmdReady: {
+        // Расстановку отдаем только серверу, который сам разрешает выстрелы
+        QByteArray fleet = serverResolves && resolveEnabled ? cmd.payload : QByteArray();
+        if (protocol == ProtocolBinary) {
+            sendFrame(WireProtocol::OpReady, reinterpret_cast<const quint8 *>(fleet.constData()), fleet.size());
+            break;
+        }
+        json["action"] = "game_event";
+        json["type"] = "ready";
+        if (!fleet.isEmpty()) {
+            QJsonArray ships;
+            for (int i = 0; i + 1 < fleet.size(); i += 2) {
+                int cell = quint8(fleet[i]);
+                int info = quint8(fleet[i + 1]);
+                ships.append(QJsonArray{cell % 10, cell / 10, info & 0x7F, (info & 0x80) ? 1 : 0});
+            }
+            json["fleet"] = ships;
+        }
+        sendJson(json);
+        break;
+    }
+    case CmdRps:
+        if (protocol == ProtocolBinary) {
+            quint8 payload[1] = { quint8(cmd.a) };
+            sendFrame(WireProtocol::OpRps, payload, 1);
+            break;
+        }
+        json["action"] = "game_event";
+        json["type"] = "rps";
+        json["value"] = cmd.a;
+        sendJson(json);
+        break;
+    case CmdFire:
+        if (protocol == ProtocolBinary) {
+            quint8 payload[1] = { quint8(cmd.b * 10 + cmd.a) };
+            sendFrame(WireProtocol::OpFire, payload, 1);
+            break;
+        }
+        json["action"] = "game_event";
+        json["type"] = "fire";
+        json["x"] = cmd.a;
+        json["y"] = cmd.b;
+        sendJson(json);
+        break;
+    case CmdFireResult:
+        if (protocol == ProtocolBinary) {
+            quint8 payload[2] = { quint8(cmd.b * 10 + cmd.a), quint8(cmd.c) };
+            sendFrame(WireProtocol::OpFireResult, payload, 2);
+            break;
+        }
+        json["action"] = "game_event";
+        json["type"] = "fire_result";
+        json["x"] = cmd.a;
+        json["y"] = cmd.b;
+        json["value"] = cmd.c;
+        sendJson(json);
+        break;
+    case CmdChat:
+        json["action"] = "game_event";
+        json["type"] = "chat";
+        json["data"] = cmd.text;
+        sendJson(json);
+        break;
+    case CmdFireBatch:
+    case CmdBatchResult: {
+        const quint8 *payload = reinterpret_cast<const quint8 *>(cmd.payload.constData());
+        if (protocol == ProtocolBinary) {
+            sendFrame(cmd.kind == CmdFireBatch ? WireProtocol::OpFireBatch : WireProtocol::OpBatchResult,
+                      payload, cmd.payload.size());
+            break;
+        }
+        WireProtocol::Batch batch;
+        WireProtocol::decodeBatch(payload, cmd.payload.size(), &batch);
+        QJsonArray cells;
+        QJsonArray results;
+        for (int i = 0; i < batch.count; ++i) {
+            cells.append(batch.cells[i]);
+            if (batch.hasResults) {
+                int status = WireProtocol::batchResult(batch, i);
+                results.append(status == WireProtocol::BatchRepeat ? -1 : status);
+            }
+        }
+        json["action"] = "game_event";
+        json["type"] = cmd.kind == CmdFireBatch ? "fire_batch" : "fire_batch_result";
+        json["mode"] = batch.mode;
+        json["cells"] = cells;
+        if (batch.hasResults) json["results"] = results;
+        sendJson(json);
+        break;
+    }
+    case CmdFlush:
+        flushOutbound();
+        break;
+    case CmdSubscribeLobby:
+        json["action"] = "subscribe_lobby";
+        json["version"] = cmd.version;
+        sendJson(json);
+        break;
+    case CmdUnsubscribeLobby:
+        json["action"] = "unsubscribe_lobby";
+        sendJson(json);
+        break;
+    case CmdSpectate:
+        json["action"] = "spectate_game";
+        json["gameId"] = cmd.text;
+        sendJson(json);
+        break;
+    case CmdLeaveSpectate:
+        json["action"] = "leave_spectate";
+        sendJson(json);
+        break;
+    case CmdEndMatch:
+        break;
+    }
+}
+
+void NetworkClient::onConnected()
+{
+    connectedState = true;
+    protocol = ProtocolJson;
+    reader.clear();
+    outbound.clear();
+    pendingMessages.clear();
+    negotiating = false;
+    serverResolves = false;
+    ackedSeq = receivedSeq;
+    pendingPings.clear();
+    lastReceivedMs = clock.elapsed();
+
+    // Предложение идет строкой JSON — его поймет любой сервер. Даже без бинарного протокола
+    // ответ нужен, чтобы узнать, разрешает ли сервер выстрелы сам.
+    QJsonObject hello;
+    hello["action"] = "hello";
+    hello["protocol"] = preferredProtocol == ProtocolBinary ? "binary" : "json";
+    hello["version"] = WireProtocol::VERSION;
+    if (reconnectingState) {
+        // Возвращаемся в матч: токен и сколько игровых сообщений уже получили
+        hello["session"] = sessionToken;
+        hello["ack"] = qint64(receivedSeq);
+    }
+    writeData(QJsonDocument(hello).toJson(QJsonDocument::Compact) + '\n');
+    flushOutbound();
+    negotiating = true;
+    negotiationTimer->start(NEGOTIATION_TIMEOUT_MS);
+    if (!reconnectingState) emit connected();
+}
+
+void NetworkClient::onDisconnected()
+{
+    connectedState = false;
+    flushTimer->stop();
+    ackTimer->stop();
+    heartbeatTimer->stop();
+    negotiationTimer->stop();
+    negotiating = false;
+    outbound.clear();
+
+    if (!reconnectingState && inMatch && reconnectEnabled && !sessionToken.isEmpty()) {
+        reconnectingState = true;
+        reconnectAttempt = 0;
+        reconnectClock.start();
+    }
+    if (reconnectingState) {
+        scheduleReconnect();
+        return;
+    }
+    emit disconnected();
+}
+
+void NetworkClient::scheduleReconnect()
+{
+    if (reconnectTimer->isActive()) return;
+    if (reconnectClock.elapsed() >= RECONNECT_GIVE_UP_MS) {
+        qDebug() << "Reconnect gave up after" << reconnectAttempt << "attempts";
+        reconnectingState = false;
+        inMatch = false;
+        unacked.clear();
+        emit disconnected();
+        return;
+    }
+    // Первая попытка почти сразу, дальше пауза удваивается. Случайный разброс — чтобы после
+    // падения сервера клиенты не возвращались все в одну миллисекунду.
+    int delay = qMin(RECONNECT_MAX_MS, RECONNECT_BASE_MS << qMin(reconnectAttempt, 6));
+    delay = delay / 2 + int(QRandomGenerator::global()->bounded(delay / 2 + 1));
+    ++reconnectAttempt;
+    emit reconnecting(reconnectAttempt, delay);
+    reconnectTimer->start(delay);
+}
+
+void NetworkClient::startMatch()
+{
+    latency.clear();
+    inMatch = true;
+    sentSeq = 0;
+    receivedSeq = 0;
+    ackedSeq = 0;
+    unacked.clear();
+}
+
+void NetworkClient::resumeMatch(quint32 serverAck)
+{
+    // Как на сервере: дослать можно, только если все, чего сервер не получил, еще хранится
+    // (после REPLAY_LIMIT старые сообщения теряются) — иначе поток с дырой и поля разойдутся.
+    // Окно матча по disconnected завершит матч, дальше — обычный вход в игру.
+    trimUnacked(serverAck);
+    bool complete = unacked.isEmpty() ? serverAck >= sentSeq : unacked.first().seq <= serverAck + 1;
+    if (!complete) {
+        failResume();
+        return;
+    }
+    reconnectingState = false;
+    qDebug() << "Match resumed after" << reconnectAttempt << "attempts," << reconnectClock.elapsed() << "ms";
+    // Сервер получил все до serverAck включительно — остальное отправляем заново, в том же порядке
+    for (const Command &cmd : unacked) encode(cmd);
+    flushOutbound();
+    emit resumed();
+}
+
+void NetworkClient::failResume()
+{
+    reconnectingState = false;
+    inMatch = false;
+    unacked.clear();
+    emit gameError("Не удалось вернуться в матч");
+    emit disconnected();
+}
+
+// Счет входящих игровых сообщений. seq из JSON, для кадров 0 — номер по порядку.
+// Повторы (сервер дослал то, что мы уже видели до обрыва) отбрасываются.
+bool NetworkClient::acceptGameMessage(quint32 seq)
+{
+    if (seq != 0 && seq <= receivedSeq) return false;
+    receivedSeq = seq != 0 ? seq : receivedSeq + 1;
+    if (!sessionToken.isEmpty() && !ackTimer->isActive()) ackTimer->start(ACK_DELAY_MS);
+    return true;
+}
+
+void NetworkClient::sendAck()
+{
+    if (receivedSeq == ackedSeq || negotiating || !transport->isOpen()) return;
+    ackedSeq = receivedSeq;
+    if (protocol == ProtocolBinary) {
+        quint8 payload[WireProtocol::MAX_VARINT];
+        int size = WireProtocol::putVarint(receivedSeq, payload);
+        sendFrame(WireProtocol::OpAck, payload, size);
+        return;
+    }
+    QJsonObject json;
+    json["action"] = "ack";
+    json["seq"] = qint64(receivedSeq);
+    sendJson(json);
+}
+
+void NetworkClient::trimUnacked(quint32 seq)
+{
+    while (!unacked.isEmpty() && unacked.first().seq <= seq) unacked.removeFirst();
+}
+
+// --- Heartbeat ---
+
+void NetworkClient::onHeartbeat()
+{
+    if (clock.elapsed() - lastReceivedMs > DEAD_PEER_MS) {
+        // Сервер молчит даже на пинги: соединение мертвое, хотя TCP об этом еще не знает.
+        // Обрыв пойдет обычным путем — с переподключением, если идет матч.
+        qDebug() << "No data from server for" << clock.elapsed() - lastReceivedMs << "ms, dropping connection";
+        transport->abort();
+        return;
+    }
+
+    qint64 now = clock.nsecsElapsed();
+    while (!pendingPings.isEmpty() && now - pendingPings.first().sentNs > qint64(PING_TIMEOUT_MS) * 1000000) {
+        pendingPings.removeFirst();
+        latency.addLoss();
+    }
+
+    PendingPing ping{++nextPingId, now};
+    pendingPings.append(ping);
+    if (protocol == ProtocolBinary) {
+        quint8 payload[WireProtocol::MAX_VARINT];
+        sendFrame(WireProtocol::OpPing, payload, WireProtocol::putVarint(ping.id, payload));
+    } else {
+        QJsonObject json;
+        json["action"] = "ping";
+        json["id"] = qint64(ping.id);
+        sendJson(json);
+    }
+    flushOutbound(); // Пинг не ждет склейки с другими сообщениями: задержка в буфере исказит RTT
+
+    LatencyStats::Summary s = latency.window();
+    emit latencyUpdated(int((s.lastUs + 500) / 1000), int((s.p95Us + 500) / 1000), int((s.jitterUs + 500) / 1000),
+                        s.lossPercent());
+}
+
+// Ответ на пинг. Старый сервер номер не возвращает — тогда ответ на самый ранний: TCP порядок сохраняет.
+void NetworkClient::finishPing(quint32 id, bool hasId)
+{
+    for (int i = 0; i < pendingPings.size(); ++i) {
+        if (hasId && pendingPings[i].id != id) continue;
+        qint64 rttNs = clock.nsecsElapsed() - pendingPings[i].sentNs;
+        latency.addSample(quint32(rttNs / 1000));
+        // Более ранние без ответа уже не дождемся
+        for (int j = 0; j < i; ++j) latency.addLoss();
+        pendingPings.erase(pendingPings.begin(), pendingPings.begin() + i + 1);
+        return;
+    }
+}
+
+void NetworkClient::logMatchLatency()
+{
+    LatencyStats::Summary s = latency.total();
+    if (s.samples + s.lost == 0) return;
+    auto ms = [](quint32 us) { return QString::number(us / 1000.0, 'f', 1); };
+    qDebug().noquote() << "Match latency: pings" << s.samples << "lost" << s.lost
+                       << "rtt p50" << ms(s.p50Us) << "p95" << ms(s.p95Us) << "p99" << ms(s.p99Us)
+                       << "max" << ms(s.maxUs) << "ms, jitter" << ms(s.jitterUs) << "ms";
+}
+
+void NetworkClient::finishNegotiation(Protocol result)
+{
+    if (!negotiating) return;
+    negotiating = false;
+    negotiationTimer->stop();
+    protocol = result;
+
+    QList<QJsonObject> pending;
+    pending.swap(pendingMessages);
+    for (const QJsonObject &json : pending) sendJson(json);
+    heartbeatTimer->start();
+}
+
+void NetworkClient::writeData(const QByteArray &data) {
+    if (!transport->isOpen()) return;
+    outbound.append(data);
+    writeStats.messages++;
+    writeStats.bufferHighWater = qMax(writeStats.bufferHighWater, qint64(outbound.size()));
+    // Таймер с нулевой задержкой срабатывает на следующей итерации цикла событий
+    if (!flushTimer->isActive()) flushTimer->start(flushDelayMs);
+}
+
+void NetworkClient::flushNow() {
+    Command cmd;
+    cmd.kind = CmdFlush;
+    submit(cmd);
+}
+
+void NetworkClient::flushOutbound() {
+    flushTimer->stop();
+    if (outbound.isEmpty()) return;
+    if (!transport->isOpen()) {
+        outbound.clear();
+        return;
+    }
+    transport->write(outbound);
+    writeStats.flushes++;
+    writeStats.bytes += outbound.size();
+    outbound.clear();
+    transport->flush();
+    writeStats.socketHighWater = qMax(writeStats.socketHighWater, transport->bytesToWrite());
 }
 
 void NetworkClient::sendJson(const QJsonObject &json) {
-    if (socket->state() == QAbstractSocket::ConnectedState) {
-        QJsonDocument doc(json);
-        QByteArray data = doc.toJson(QJsonDocument::Compact);
-        data.append('\n');
-        socket->write(data);
-        socket->flush();
+    if (!transport->isOpen()) return;
+    if (negotiating) {
+        pendingMessages.append(json);
+        return;
+    }
+
+    QJsonDocument doc(json);
+    QByteArray data = doc.toJson(QJsonDocument::Compact);
+    if (protocol == ProtocolBinary) {
+        sendFrame(WireProtocol::OpJson, reinterpret_cast<const quint8 *>(data.constData()), data.size());
+        return;
     }
+    data.append('\n');
+    writeData(data);
+}
+
+void NetworkClient::sendFrame(WireProtocol::Opcode op, const quint8 *payload, int size) {
+    QByteArray frame(WireProtocol::MAX_VARINT + 1 + size, Qt::Uninitialized);
+    int length = WireProtocol::encodeFrame(op, payload, size, reinterpret_cast<quint8 *>(frame.data()));
+    frame.truncate(length);
+    writeData(frame);
 }
 
 // --- Lobby Methods ---
 
 void NetworkClient::createLobby(const QString &playerName) {
-    QJsonObject json;
-    json["action"] = "create_game";
-    json["data"] = playerName;
-    sendJson(json);
+    Command cmd;
+    cmd.kind = CmdCreateLobby;
+    cmd.text = playerName;
+    submit(cmd);
+}
+
+void NetworkClient::subscribeLobby(qint64 version) {
+    Command cmd;
+    cmd.kind = CmdSubscribeLobby;
+    cmd.version = version;
+    submit(cmd);
+}
+
+void NetworkClient::unsubscribeLobby() {
+    Command cmd;
+    cmd.kind = CmdUnsubscribeLobby;
+    submit(cmd);
+}
+
+void NetworkClient::spectateGame(const QString &gameId) {
+    Command cmd;
+    cmd.kind = CmdSpectate;
+    cmd.text = gameId;
+    submit(cmd);
+}
+
+void NetworkClient::leaveSpectate() {
+    Command cmd;
+    cmd.kind = CmdLeaveSpectate;
+    submit(cmd);
 }
 
 void NetworkClient::joinLobby(const QString &gameId) {
-    QJsonObject json;
-    json["action"] = "join_game";
-    json["gameId"] = gameId;
-    sendJson(json);
+    Command cmd;
+    cmd.kind = CmdJoinLobby;
+    cmd.text = gameId;
+    submit(cmd);
 }
 
 // --- Game Methods ---
 
-void NetworkClient::sendReady() {
-    QJsonObject json;
-    json["action"] = "game_event";
-    json["type"] = "ready";
-    sendJson(json);
+void NetworkClient::sendReady(const QVector<FleetShip> &fleet) {
+    Command cmd;
+    cmd.kind = CmdReady;
+    for (int i = 0; i < fleet.size() && i < WireProtocol::MAX_FLEET; ++i) {
+        const FleetShip &ship = fleet[i];
+        cmd.payload.append(char(ship.y * 10 + ship.x));
+        cmd.payload.append(char(ship.size | (ship.vertical ? 0x80 : 0)));
+    }
+    submit(cmd);
 }
 
 void NetworkClient::sendRPS(int shapeId) {
-    QJsonObject json;
-    json["action"] = "game_event";
-    json["type"] = "rps";
-    json["value"] = shapeId;
-    sendJson(json);
+    Command cmd;
+    cmd.kind = CmdRps;
+    cmd.a = shapeId;
+    submit(cmd);
 }
 
 void NetworkClient::sendFire(int x, int y) {
-    QJsonObject json;
-    json["action"] = "game_event";
-    json["type"] = "fire";
-    json["x"] = x;
-    json["y"] = y;
-    sendJson(json);
+    Command cmd;
+    cmd.kind = CmdFire;
+    cmd.a = x;
+    cmd.b = y;
+    submit(cmd);
 }
 
 void NetworkClient::sendFireResult(int x, int y, int status) {
-    QJsonObject json;
-    json["action"] = "game_event";
-    json["type"] = "fire_result";
-    json["x"] = x;
-    json["y"] = y;
-    json["value"] = status;
-    sendJson(json);
+    Command cmd;
+    cmd.kind = CmdFireResult;
+    cmd.a = x;
+    cmd.b = y;
+    cmd.c = status;
+    submit(cmd);
 }
 
 void NetworkClient::sendChatMessage(const QString &msg) {
-    QJsonObject json;
-    json["action"] = "game_event";
-    json["type"] = "chat";
-    json["data"] = msg;
-    sendJson(json);
+    Command cmd;
+    cmd.kind = CmdChat;
+    cmd.text = msg;
+    submit(cmd);
+}
+
+void NetworkClient::sendFireBatch(int mode, const QVector<QPoint> &cells) {
+    sendBatch(CmdFireBatch, mode, cells, QVector<int>());
+}
+
+void NetworkClient::sendFireBatchResult(int mode, const QVector<QPoint> &cells, const QVector<int> &results) {
+    sendBatch(CmdBatchResult, mode, cells, results);
+}
+
+void NetworkClient::sendBatch(CommandKind kind, int mode, const QVector<QPoint> &cells, const QVector<int> &results) {
+    int count = qMin(int(cells.size()), WireProtocol::MAX_BATCH);
+    quint8 bytes[WireProtocol::MAX_BATCH];
+    int statuses[WireProtocol::MAX_BATCH];
+    for (int i = 0; i < count; ++i) {
+        bytes[i] = quint8(cells[i].y() * 10 + cells[i].x());
+        int status = i < results.size() ? results[i] : -1;
+        statuses[i] = status < 0 ? int(WireProtocol::BatchRepeat) : status;
+    }
+
+    Command cmd;
+    cmd.kind = kind;
+    cmd.payload.resize(WireProtocol::batchPayloadSize(count, kind == CmdBatchResult));
+    WireProtocol::encodeBatch(mode, bytes, kind == CmdBatchResult ? statuses : nullptr, count,
+                              reinterpret_cast<quint8 *>(cmd.payload.data()));
+    submit(cmd);
 }
 
 // --- Handling ---
 
+const NetworkClient::Handler NetworkClient::handlers[WireProtocol::KeyCount] = {
+    nullptr,                              // KeyUnknown
+    &NetworkClient::handleGameCreated,    // game_created
+    &NetworkClient::handleGameJoined,     // game_joined
+    &NetworkClient::handlePlayerJoined,   // player_joined
+    nullptr,                              // games_updated (список серверов запрашивает MainWindow)
+    &NetworkClient::handleError,          // error
+    nullptr,                              // game_event — разбирается по полю type
+    nullptr,                              // hello_ack — только при согласовании
+    &NetworkClient::handlePong,           // pong
+    &NetworkClient::handleLobbySnapshot,  // lobby_snapshot
+    &NetworkClient::handleLobbyUpdate,    // lobby_update
+    &NetworkClient::handleSpectateBegin,  // spectate_begin
+    &NetworkClient::handleSpectateEvent,  // spectate_event
+    nullptr,                              // create_game (запросы клиента — от сервера не приходят)
+    nullptr,                              // join_game
+    nullptr,                              // get_games
+    nullptr,                              // set_name
+    nullptr,                              // ping
+    nullptr,                              // hello
+    nullptr,                              // subscribe_lobby
+    nullptr,                              // unsubscribe_lobby
+    nullptr,                              // spectate_game
+    nullptr,                              // leave_spectate
+    &NetworkClient::handleAck,            // ack
+    &NetworkClient::handleReady,          // ready
+    &NetworkClient::handleRps,            // rps
+    &NetworkClient::handleFire,           // fire
+    &NetworkClient::handleFireResult,     // fire_result
+    &NetworkClient::handleChat,           // chat
+    &NetworkClient::handleTurnChange,     // turn_change
+    &NetworkClient::handleFireBatch,      // fire_batch
+    &NetworkClient::handleBatchResult     // fire_batch_result
+};
+
 void NetworkClient::onReadyRead()
 {
-    while (socket->canReadLine()) {
-        QByteArray line = socket->readLine().trimmed();
-        if (line.isEmpty()) continue;
-
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+    // Читаем прямо в кольцевой буфер, без промежуточных QByteArray
+    while (transport->bytesAvailable() > 0) {
+        int space = 0;
+        char *dst = reader.writeSpace(int(qMin<qint64>(transport->bytesAvailable(), FrameReader::MAX_CAPACITY)), &space);
+        if (!dst) {
+            qDebug() << "Incoming message too large, dropping connection";
+            reader.clear();
+            emit errorOccurred("Поврежденные данные от сервера");
+            transport->abort();
+            return;
+        }
+        qint64 n = transport->read(dst, space);
+        if (n <= 0) break;
+        reader.commit(int(n));
+        lastReceivedMs = clock.elapsed();
+    }
 
-        if (parseError.error != QJsonParseError::NoError) {
-            qDebug() << "JSON Parse Error:" << parseError.errorString() << "Data:" << line;
-            continue;
+    // Ответ на "hello" приходит строкой, все после него — уже кадрами
+    for (;;) {
+        if (protocol == ProtocolJson) {
+            const char *line = nullptr;
+            int len = 0;
+            if (!reader.nextLine(&line, &len)) break;
+            receivedMessages++;
+            handleMessage(line, len);
+        } else {
+            quint8 op = 0;
+            const quint8 *payload = nullptr;
+            int size = 0;
+            int result = reader.nextFrame(&op, &payload, &size);
+            if (result == 0) break;
+            if (result < 0) {
+                qDebug() << "Broken protocol frame, dropping connection";
+                reader.clear();
+                emit errorOccurred("Поврежденные данные от сервера");
+                transport->abort();
+                return;
+            }
+            receivedMessages++;
+            handleFrame(op, payload, size);
         }
+    }
+}
 
-        if (doc.isObject()) {
-            QJsonObject obj = doc.object();
-            QString action = obj["action"].toString();
-            QString data = obj["data"].toString();
+void NetworkClient::handleFrame(quint8 op, const quint8 *payload, int size)
+{
+    if (op >= WireProtocol::OpReady && op <= WireProtocol::OpBatchResult && !acceptGameMessage(0)) return;
+    switch (op) {
+    case WireProtocol::OpReady:
+        emit opponentReady();
+        break;
+    case WireProtocol::OpRps:
+        emit opponentRPS(payload[0]);
+        break;
+    case WireProtocol::OpFire:
+        if (size == 2) emit opponentShotResolved(payload[0] % 10, payload[0] / 10, payload[1]);
+        else emit opponentFired(payload[0] % 10, payload[0] / 10);
+        break;
+    case WireProtocol::OpFireResult:
+        emit fireResultReceived(payload[0] % 10, payload[0] / 10, payload[1]);
+        break;
+    case WireProtocol::OpTurnChange:
+        emit turnChanged(payload[0] == 1 ? "Player1" : "Player2");
+        break;
+    case WireProtocol::OpFireBatch:
+    case WireProtocol::OpBatchResult:
+        handleBatch(op == WireProtocol::OpBatchResult, payload, size);
+        break;
+    case WireProtocol::OpAck: {
+        quint32 seq = 0;
+        if (WireProtocol::getVarint(payload, size, &seq) > 0) trimUnacked(seq);
+        break;
+    }
+    case WireProtocol::OpPong: {
+        quint32 id = 0;
+        if (WireProtocol::getVarint(payload, size, &id) > 0) finishPing(id, true);
+        break;
+    }
+    case WireProtocol::OpJson:
+        handleMessage(reinterpret_cast<const char *>(payload), size);
+        break;
+    default:
+        qDebug() << "Unknown opcode:" << op;
+        break;
+    }
+}
 
-            // qDebug() << "Server Action:" << action;
+void NetworkClient::handleMessage(const char *json, int size)
+{
+    // Дерево JSON не строим: достаем action (и type) сканером и идем по таблице обработчиков
+    WireProtocol::JsonValue action;
+    if (!WireProtocol::findField(json, size, "action", &action) || !action.isString) {
+        qDebug() << "JSON Parse Error: no action. Data:" << QByteArray::fromRawData(json, size);
+        return;
+    }
+    WireProtocol::MessageKey key = WireProtocol::messageKey(action.data, action.size);
 
-            if (action == "game_created") {
-                QString gid = obj.contains("gameId") ? obj["gameId"].toString() : data;
-                emit lobbyCreated(gid);
-            }
-            else if (action == "game_joined") {
-                QString gid = obj.contains("gameId") ? obj["gameId"].toString() : data;
-                emit joinedLobby(gid);
-            }
-            else if (action == "player_joined") {
-                QString name = obj.contains("opponentId") ? obj["opponentId"].toString() : data;
-                emit playerJoined(name);
-            }
-            else if (action == "error") {
-                emit gameError(obj["message"].toString());
-            }
-            // Обработка игровых событий
-            else if (action == "game_event") {
-                QString type = obj["type"].toString();
-                if (type == "ready") {
-                    emit opponentReady();
-                } else if (type == "rps") {
-                    emit opponentRPS(obj["value"].toInt()); // value используется сервером для передачи choice
-                    // Также сервер может присылать "choice" вместо "value" в некоторых реализациях,
-                    // но в NetworkClient::sendRPS мы шлем "value", так что ожидаем симметрии или проверяем оба
-                    if (obj.contains("choice")) emit opponentRPS(obj["choice"].toString().toInt()); // Fallback если сервер шлет choice
-                } else if (type == "fire") {
-                    emit opponentFired(obj["x"].toInt(), obj["y"].toInt());
-                } else if (type == "fire_result") {
-                    emit fireResultReceived(obj["x"].toInt(), obj["y"].toInt(), obj["value"].toInt());
-                } else if (type == "chat") {
-                    emit chatMessageReceived(obj["data"].toString());
-                } else if (type == "turn_change") {
-                    emit turnChanged(obj["currentTurn"].toString());
-                }
+    if (negotiating) {
+        if (key == WireProtocol::KeyHelloAck) {
+            WireProtocol::JsonValue proto;
+            bool binary = WireProtocol::findField(json, size, "protocol", &proto) && proto.isString
+                          && QByteArray::fromRawData(proto.data, proto.size) == "binary";
+            WireProtocol::JsonValue resolve;
+            serverResolves = WireProtocol::findField(json, size, "resolve", &resolve)
+                             && QByteArray::fromRawData(resolve.data, resolve.size) == "true";
+            Message msg{json, size};
+            WireProtocol::JsonValue resumedValue;
+            bool resumedMatch = WireProtocol::findField(json, size, "resumed", &resumedValue)
+                                && QByteArray::fromRawData(resumedValue.data, resumedValue.size) == "true";
+            finishNegotiation(binary && preferredProtocol == ProtocolBinary ? ProtocolBinary : ProtocolJson);
+            if (reconnectingState) {
+                if (resumedMatch) resumeMatch(quint32(intField(msg, "ack")));
+                else failResume();
+                return;
             }
+            sessionToken = stringField(msg, "session");
+            return;
+        }
+        // Старый сервер не знает "hello" и отвечает ошибкой — ее пользователю не показываем
+        finishNegotiation(ProtocolJson);
+        if (reconnectingState) {
+            failResume();
+            return;
+        }
+        if (key == WireProtocol::KeyError) return;
+    }
+
+    // Обработка игровых событий
+    if (key == WireProtocol::KeyGameEvent) {
+        WireProtocol::JsonValue type;
+        if (!WireProtocol::findField(json, size, "type", &type) || !type.isString) return;
+        key = WireProtocol::messageKey(type.data, type.size);
+        if (key < WireProtocol::KeyReady) return; // Вложенными бывают только игровые типы
+        WireProtocol::JsonValue seq;
+        bool hasSeq = WireProtocol::findField(json, size, "seq", &seq);
+        if (!acceptGameMessage(hasSeq ? quint32(WireProtocol::toInt(seq)) : 0)) return;
+    } else if (key >= WireProtocol::KeyReady) {
+        return;
+    }
+
+    Handler handler = handlers[key];
+    if (handler) (this->*handler)(Message{json, size});
+}
+
+QString NetworkClient::stringField(const Message &msg, const char *key)
+{
+    WireProtocol::JsonValue value;
+    if (!WireProtocol::findField(msg.json, msg.size, key, &value) || !value.isString) return QString();
+    if (!value.escaped) return QString::fromUtf8(value.data, value.size);
+    // Escape-последовательности (кавычки в чате и т.п.) — редкий случай, отдаем полному разбору
+    QJsonDocument doc = QJsonDocument::fromJson(QByteArray::fromRawData(msg.json, msg.size));
+    return doc.object().value(QLatin1String(key)).toString();
+}
+
+int NetworkClient::intField(const Message &msg, const char *key)
+{
+    WireProtocol::JsonValue value;
+    return WireProtocol::findField(msg.json, msg.size, key, &value) ? WireProtocol::toInt(value) : 0;
+}
+
+void NetworkClient::handleGameCreated(const Message &msg)
+{
+    startMatch();
+    WireProtocol::JsonValue value;
+    bool hasId = WireProtocol::findField(msg.json, msg.size, "gameId", &value);
+    emit lobbyCreated(stringField(msg, hasId ? "gameId" : "data"));
+}
+
+void NetworkClient::handleGameJoined(const Message &msg)
+{
+    startMatch();
+    WireProtocol::JsonValue value;
+    bool hasId = WireProtocol::findField(msg.json, msg.size, "gameId", &value);
+    emit joinedLobby(stringField(msg, hasId ? "gameId" : "data"));
+}
+
+void NetworkClient::handlePlayerJoined(const Message &msg)
+{
+    WireProtocol::JsonValue value;
+    bool hasId = WireProtocol::findField(msg.json, msg.size, "opponentId", &value);
+    emit playerJoined(stringField(msg, hasId ? "opponentId" : "data"));
+}
+
+// Сообщения лобби редкие и вложенные (список, объект game): разбираем целиком через QJsonDocument
+void NetworkClient::handleLobbySnapshot(const Message &msg)
+{
+    QJsonObject json = QJsonDocument::fromJson(QByteArray::fromRawData(msg.json, msg.size)).object();
+    emit lobbySnapshot(json["version"].toInteger(), json["games"].toArray());
+}
+
+void NetworkClient::handleLobbyUpdate(const Message &msg)
+{
+    QJsonObject json = QJsonDocument::fromJson(QByteArray::fromRawData(msg.json, msg.size)).object();
+    QJsonObject game = json["game"].toObject();
+    QString gameId = game.isEmpty() ? json["gameId"].toString() : game["Id"].toString();
+    emit lobbyUpdated(json["version"].toInteger(), json["change"].toString(), gameId, game["Name"].toString());
+}
+
+void NetworkClient::handleSpectateBegin(const Message &msg)
+{
+    QJsonObject json = QJsonDocument::fromJson(QByteArray::fromRawData(msg.json, msg.size)).object();
+    const QJsonArray list = json["shots"].toArray();
+    QVector<int> shots;
+    shots.reserve(list.size());
+    for (const QJsonValue &value : list) shots.append(value.toInt());
+    emit spectateStarted(json["gameId"].toString(), json["gameName"].toString(), json["turn"].toInt(), shots);
+}
+
+// Событий у зрителя столько же, сколько у игроков (выстрелы и ходы): поля берем сканером, без QJsonDocument
+void NetworkClient::handleSpectateEvent(const Message &msg)
+{
+    WireProtocol::JsonValue type;
+    if (!WireProtocol::findField(msg.json, msg.size, "type", &type) || !type.isString) return;
+    QByteArray name = QByteArray::fromRawData(type.data, type.size);
+    if (name == "shot") emit spectatorShot(intField(msg, "by"), intField(msg, "x"), intField(msg, "y"), intField(msg, "value"));
+    else if (name == "turn_change") emit spectatorTurnChanged(stringField(msg, "currentTurn"));
+    else if (name == "chat") emit spectatorChat(intField(msg, "by"), stringField(msg, "data"));
+    else if (name == "player_joined") emit spectatorPlayerJoined(stringField(msg, "opponentId"));
+    else if (name == "ended") emit spectateEnded();
+}
+
+void NetworkClient::handleError(const Message &msg)
+{
+    emit gameError(stringField(msg, "message"));
+}
+
+void NetworkClient::handleReady(const Message &msg)
+{
+    Q_UNUSED(msg)
+    emit opponentReady();
+}
+
+void NetworkClient::handleRps(const Message &msg)
+{
+    emit opponentRPS(intField(msg, "value")); // value используется сервером для передачи choice
+    // Также сервер может присылать "choice" вместо "value" в некоторых реализациях,
+    // но в NetworkClient::sendRPS мы шлем "value", так что ожидаем симметрии или проверяем оба
+    WireProtocol::JsonValue choice;
+    if (WireProtocol::findField(msg.json, msg.size, "choice", &choice)) emit opponentRPS(WireProtocol::toInt(choice)); // Fallback если сервер шлет choice
+}
+
+void NetworkClient::handleFire(const Message &msg)
+{
+    WireProtocol::JsonValue value;
+    if (WireProtocol::findField(msg.json, msg.size, "value", &value))
+        emit opponentShotResolved(intField(msg, "x"), intField(msg, "y"), WireProtocol::toInt(value));
+    else
+        emit opponentFired(intField(msg, "x"), intField(msg, "y"));
+}
+
+void NetworkClient::handleFireResult(const Message &msg)
+{
+    emit fireResultReceived(intField(msg, "x"), intField(msg, "y"), intField(msg, "value"));
+}
+
+void NetworkClient::handleChat(const Message &msg)
+{
+    emit chatMessageReceived(stringField(msg, "data"));
+}
+
+void NetworkClient::handleTurnChange(const Message &msg)
+{
+    emit turnChanged(stringField(msg, "currentTurn"));
+}
+
+void NetworkClient::handleAck(const Message &msg)
+{
+    trimUnacked(quint32(intField(msg, "seq")));
+}
+
+void NetworkClient::handlePong(const Message &msg)
+{
+    WireProtocol::JsonValue id;
+    bool hasId = WireProtocol::findField(msg.json, msg.size, "id", &id);
+    finishPing(hasId ? quint32(WireProtocol::toInt(id)) : 0, hasId);
+}
+
+void NetworkClient::handleFireBatch(const Message &msg)
+{
+    quint8 payload[WireProtocol::batchPayloadSize(WireProtocol::MAX_BATCH, true)];
+    int size = WireProtocol::batchFromJson(msg.json, msg.size, payload);
+    if (size > 0) handleBatch(false, payload, size);
+}
+
+void NetworkClient::handleBatchResult(const Message &msg)
+{
+    quint8 payload[WireProtocol::batchPayloadSize(WireProtocol::MAX_BATCH, true)];
+    int size = WireProtocol::batchFromJson(msg.json, msg.size, payload);
+    if (size > 0) handleBatch(true, payload, size);
+}
+
+// Залп из кадра или из JSON, уже приведенного к виду кадра
+void NetworkClient::handleBatch(bool isResult, const quint8 *payload, int size)
+{
+    WireProtocol::Batch batch;
+    if (!WireProtocol::decodeBatch(payload, size, &batch) || (isResult && !batch.hasResults)) {
+        qDebug() << "Malformed fire_batch, ignored";
+        return;
+    }
+    QVector<QPoint> cells;
+    QVector<int> results;
+    cells.reserve(batch.count);
+    for (int i = 0; i < batch.count; ++i) {
+        cells.append(QPoint(batch.cells[i] % 10, batch.cells[i] / 10));
+        if (batch.hasResults) {
+            int status = WireProtocol::batchResult(batch, i);
+            results.append(status == WireProtocol::BatchRepeat ? -1 : status);
         }
     }
+
+    if (isResult) emit fireBatchResultReceived(batch.mode, cells, results);
+    else if (batch.hasResults) emit opponentBatchResolved(batch.mode, cells, results);
+    else emit opponentFiredBatch(batch.mode, cells);
 }
 
-void NetworkClient::onSocketError(QAbstractSocket::SocketError socketError)
+void NetworkClient::onTransportError(const QString &message)
 {
-    Q_UNUSED(socketError)
-    emit errorOccurred(socket->errorString());
+    if (reconnectingState) {
+        // Неудачная попытка переподключения: disconnected не придет, следующую планируем сами
+        if (!transport->isOpen()) scheduleReconnect();
+        return;
+    }
+    // Обрыв посреди матча пользователю не показываем — сначала попробуем вернуться
+    if (inMatch && reconnectEnabled && !sessionToken.isEmpty()) return;
+    emit errorOccurred(message);
 }
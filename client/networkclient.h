@@ -2,33 +2,109 @@
 #define NETWORKCLIENT_H
 
 #include <QObject>
-#include <QTcpSocket>
 #include <QHostAddress>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QJsonParseError>
+#include <QJsonArray>
+#include <QVector>
+#include <QPoint>
+#include <QTimer>
+#include <QList>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <atomic>
+#include "wireprotocol.h"
+#include "framereader.h"
+#include "latencystats.h"
+#include "transport.h"
+#include "spscqueue.h"
 
 class NetworkClient : public QObject
 {
     Q_OBJECT
 public:
     explicit NetworkClient(QObject *parent = nullptr);
+    // Свой канал вместо TCP (например, LoopbackTransport для партий внутри процесса). Клиент становится владельцем.
+    explicit NetworkClient(Transport *transport, QObject *parent = nullptr);
+    ~NetworkClient();
+
+    // Сокет, разбор и таймеры переезжают в отдельный поток (вызывать до connectToServer).
+    // Сигналы испускаются из него и доходят до окон в очереди событий с теми же сигнатурами,
+    // исходящие сообщения передаются через очередь без блокировок.
+    void startNetworkThread();
+    bool isThreaded() const { return thread != nullptr; }
+
+    // Формат обмена. Бинарный включается только после подтверждения сервером ("hello" -> "hello_ack"),
+    // до ответа исходящие сообщения придерживаются. Сервер без поддержки отвечает ошибкой — остаемся на JSON.
+    enum Protocol { ProtocolJson, ProtocolBinary };
+    void setPreferredProtocol(Protocol protocol) { preferredProtocol = protocol; }
+    Protocol getProtocol() const { return protocol; }
+
+    // Выстрелы разрешает сервер (если в hello_ack есть "resolve"): расстановка уходит с ready,
+    // на выстрел сервер сам отвечает стрелявшему и присылает нам opponentShotResolved — за один переход.
+    void setServerResolvedShots(bool enabled) { resolveEnabled = enabled; }
+
+    struct FleetShip {
+        int x;
+        int y;
+        int size;
+        bool vertical;
+    };
+
+    // Исходящие сообщения копятся в буфере и уходят одной записью за итерацию цикла событий
+    // (или через flushDelay мс). flushNow — для сообщений, которые нельзя задерживать.
+    void setFlushDelay(int ms) { flushDelayMs = qMax(0, ms); }
+    void flushNow();
+
+    struct WriteStats {
+        qint64 messages = 0;        // Поставлено в буфер
+        qint64 flushes = 0;         // Записей в сокет
+        qint64 bytes = 0;
+        qint64 bufferHighWater = 0; // Максимум нашего буфера перед записью
+        qint64 socketHighWater = 0; // Максимум bytesToWrite() канала после записи (ядро не успевает)
+    };
+    WriteStats getWriteStats() const;
+    qint64 getReceivedMessages() const; // Разобранных входящих строк и кадров
+    LatencyStats getLatencyStats() const; // Пинги текущего матча
 
     void connectToServer(const QString &ip, int port);
     bool isConnected() const;
 
+    // Обрыв посреди матча не завершает его: переподключение через 100, 200, 400... мс (до 4 с),
+    // сервер по токену сессии возвращает на место в комнате, обе стороны досылают неподтвержденные
+    // игровые сообщения (их номера и буфер — здесь). disconnected — только если вернуться не удалось.
+    void setReconnectEnabled(bool enabled) { reconnectEnabled = enabled; }
+    // Матч окончен (выход в меню): следующий обрыв уже не восстанавливается
+    void endMatch();
+
     // Лобби
     void createLobby(const QString &playerName);
     void joinLobby(const QString &gameId);
+    // Подписка на список ожидающих игр: сервер присылает lobbySnapshot, затем только изменения.
+    // version — последняя примененная версия: если изменения после нее еще у сервера, придут только они.
+    void subscribeLobby(qint64 version = 0);
+    void unsubscribeLobby();
+
+    // Наблюдение за чужой игрой: сервер присылает spectateStarted с уже сделанными выстрелами,
+    // дальше публичные события (выстрелы с результатом, смена хода, чат). Отправлять в игру зритель не может.
+    void spectateGame(const QString &gameId);
+    void leaveSpectate();
 
     // Игровой процесс
-    void sendReady();
+    void sendReady(const QVector<FleetShip> &fleet = QVector<FleetShip>());
     void sendRPS(int shapeId); // 1=Rock, 2=Paper, 3=Scissors
     void sendFire(int x, int y);
     void sendFireResult(int x, int y, int status); // 0=Miss, 1=Hit, 2=Kill
     void sendChatMessage(const QString &msg);
 
+    // Залп способности (WireProtocol::BatchMode) одним сообщением: до MAX_BATCH клеток, один ответ
+    // с результатами всех. Результаты как у receiveShot: -1 уже стреляли, 0 мимо, 1 попал, 2 убил.
+    void sendFireBatch(int mode, const QVector<QPoint> &cells);
+    void sendFireBatchResult(int mode, const QVector<QPoint> &cells, const QVector<int> &results);
+
 signals:
     void connected();
     void disconnected();
@@ -39,24 +115,185 @@ signals:
     void joinedLobby(const QString &gameId);
     void playerJoined(const QString &playerName);
     void gameError(const QString &message);
+    void lobbySnapshot(qint64 version, const QJsonArray &games); // Комнаты в формате games_list
+    // change: "added", "removed" или "updated"; у removed имени нет
+    void lobbyUpdated(qint64 version, const QString &change, const QString &gameId, const QString &gameName);
+
+    // Сигналы зрителя. by — кто стрелял или писал: 1 — Player1, 2 — Player2.
+    // shots — по три числа на выстрел: by, клетка (y * 10 + x), результат (0 мимо, 1 попал, 2 убил).
+    void spectateStarted(const QString &gameId, const QString &gameName, int turn, const QVector<int> &shots);
+    void spectatorPlayerJoined(const QString &playerId);
+    void spectatorShot(int by, int x, int y, int status);
+    void spectatorTurnChanged(const QString &who);
+    void spectatorChat(int by, const QString &msg);
+    void spectateEnded(); // Комната закрылась
 
     // Сигналы игры
     void opponentReady();
     void opponentRPS(int shapeId);
     void opponentFired(int x, int y);
+    void opponentShotResolved(int x, int y, int status); // Выстрел по нам, результат уже отправлен сервером
     void fireResultReceived(int x, int y, int status);
+    void opponentFiredBatch(int mode, const QVector<QPoint> &cells); // Ждет sendFireBatchResult
+    void opponentBatchResolved(int mode, const QVector<QPoint> &cells, const QVector<int> &results);
+    void fireBatchResultReceived(int mode, const QVector<QPoint> &cells, const QVector<int> &results);
     void chatMessageReceived(const QString &msg);
 
     // Новый сигнал для смены хода
     void turnChanged(const QString &who); // "Player1" or "Player2"
 
-private slots:
-    void onReadyRead();
-    void onSocketError(QAbstractSocket::SocketError socketError);
+    // Переподключение посреди матча
+    void reconnecting(int attempt, int delayMs);
+    void resumed();
+
+    // Раз в PING_INTERVAL_MS: последний RTT, 95-й перцентиль и джиттер по последним пингам, потери в процентах
+    void latencyUpdated(int rttMs, int p95Ms, int jitterMs, int lossPercent);
 
 private:
-    QTcpSocket *socket;
+    static const int NEGOTIATION_TIMEOUT_MS = 2000;
+    static const unsigned COMMAND_QUEUE_SIZE = 256;
+    static constexpr int RECONNECT_BASE_MS = 100;
+    static constexpr int RECONNECT_MAX_MS = 4000;
+    static constexpr int RECONNECT_GIVE_UP_MS = 30000;
+    static const int ACK_DELAY_MS = 50;   // Подтверждения копятся и уходят одним сообщением
+    static const int REPLAY_LIMIT = 256;  // Неподтвержденных игровых сообщений, дальше старые теряются
+    // Пинг: TCP keepalive замечает мертвое соединение через часы, нам нужно за секунды
+    static const int PING_INTERVAL_MS = 1000;
+    static const int PING_TIMEOUT_MS = 3000; // Ответ позже — пинг потерян
+    static const int DEAD_PEER_MS = 5000;    // Ни байта от сервера — соединение рвем сами
+
+    // Исходящее сообщение от окон: кодируется уже в потоке сокета (там известен протокол)
+    enum CommandKind { CmdCreateLobby, CmdJoinLobby, CmdReady, CmdRps, CmdFire, CmdFireResult, CmdChat,
+                       CmdFireBatch, CmdBatchResult, CmdFlush, CmdEndMatch, CmdSubscribeLobby, CmdUnsubscribeLobby,
+                       CmdSpectate, CmdLeaveSpectate };
+    static bool isGameCommand(CommandKind kind) { return kind >= CmdReady && kind <= CmdBatchResult; }
+    struct Command {
+        CommandKind kind = CmdFlush;
+        int a = 0;
+        int b = 0;
+        int c = 0;
+        QString text;
+        QByteArray payload; // CmdReady, CmdFireBatch, CmdBatchResult: данные кадра
+        quint32 seq = 0;    // Номер игрового сообщения в матче
+        qint64 version = 0; // CmdSubscribeLobby
+    };
+
+    // Все ниже, кроме очереди команд, трогается только из потока сокета (ioContext)
+    QObject *ioContext;           // Родитель сокета и таймеров, контекст их соединений
+    QThread *thread = nullptr;
+    SpscQueue<Command, COMMAND_QUEUE_SIZE> commands;
+    std::atomic_bool wakePending{false};
+    // Кольцо переполнилось: с этого момента все команды идут в overflow (под overflowMutex), пока поток
+    // сети его не опустошит — иначе команда из кольца обогнала бы отложенную. Поднимает только submit,
+    // опускает только drainCommands при пустом списке.
+    std::atomic_bool overflowing{false};
+    QMutex overflowMutex;
+    QVector<Command> overflow;
+    std::atomic_bool connectedState{false};
+
+    Transport *transport;
+    QTimer *negotiationTimer;
+    QTimer *flushTimer;
+    QTimer *reconnectTimer;
+    QTimer *ackTimer;
+    QTimer *heartbeatTimer;
+    QByteArray outbound; // Еще не переданное сокету
+    int flushDelayMs = 0;
+    WriteStats writeStats;
+    qint64 receivedMessages = 0;
+    Protocol preferredProtocol = ProtocolBinary;
+    Protocol protocol = ProtocolJson;
+    bool negotiating = false;
+    bool resolveEnabled = true;
+    bool serverResolves = false;
+    QList<QJsonObject> pendingMessages; // Отправленные во время согласования
+    FrameReader reader;                 // Входящие строки/кадры
+
+    // Матч и его возобновление после обрыва
+    QString host;
+    quint16 port = 0;
+    QString sessionToken;   // Из hello_ack; пустой — сервер не умеет возобновлять
+    bool inMatch = false;
+    bool reconnectEnabled = true;
+    bool reconnectingState = false;
+    int reconnectAttempt = 0;
+    QElapsedTimer reconnectClock;
+    quint32 sentSeq = 0;
+    quint32 receivedSeq = 0;
+    quint32 ackedSeq = 0;   // Сколько полученных уже подтвердили
+    QList<Command> unacked; // Отправленные игровые команды до подтверждения сервером
+
+    // Пинг и задержка
+    struct PendingPing {
+        quint32 id;
+        qint64 sentNs;
+    };
+    QElapsedTimer clock;
+    qint64 lastReceivedMs = 0;
+    quint32 nextPingId = 0;
+    QList<PendingPing> pendingPings; // По порядку отправки
+    LatencyStats latency;
+
+    // Входящее JSON-сообщение: указатель в буфер FrameReader, действителен только на время обработки
+    struct Message {
+        const char *json;
+        int size;
+    };
+    typedef void (NetworkClient::*Handler)(const Message &msg);
+    static const Handler handlers[WireProtocol::KeyCount]; // Обработчик по значению action/type
+
+    void submit(Command cmd);
+    void drainCommands();
+    void execute(const Command &cmd);
+    void encode(const Command &cmd);
+
+    void onConnected();
+    void onDisconnected();
+    void scheduleReconnect();
+    void startMatch();
+    void resumeMatch(quint32 serverAck);
+    void failResume();
+    bool acceptGameMessage(quint32 seq);
+    void sendAck();
+    void trimUnacked(quint32 seq);
+    void onHeartbeat();
+    void finishPing(quint32 id, bool hasId);
+    void logMatchLatency();
+    void onReadyRead();
+    void attachTransport();
+    void onTransportError(const QString &message);
+    void flushOutbound();
+
     void sendJson(const QJsonObject &json);
+    void sendFrame(WireProtocol::Opcode op, const quint8 *payload = nullptr, int size = 0);
+    void writeData(const QByteArray &data);
+    void finishNegotiation(Protocol result);
+    void handleMessage(const char *json, int size);
+    void handleFrame(quint8 op, const quint8 *payload, int size);
+    void handleBatch(bool isResult, const quint8 *payload, int size);
+    void sendBatch(CommandKind kind, int mode, const QVector<QPoint> &cells, const QVector<int> &results);
+
+    static QString stringField(const Message &msg, const char *key);
+    static int intField(const Message &msg, const char *key);
+
+    void handleGameCreated(const Message &msg);
+    void handleGameJoined(const Message &msg);
+    void handlePlayerJoined(const Message &msg);
+    void handleLobbySnapshot(const Message &msg);
+    void handleLobbyUpdate(const Message &msg);
+    void handleSpectateBegin(const Message &msg);
+    void handleSpectateEvent(const Message &msg);
+    void handleError(const Message &msg);
+    void handleReady(const Message &msg);
+    void handleRps(const Message &msg);
+    void handleFire(const Message &msg);
+    void handleFireResult(const Message &msg);
+    void handleChat(const Message &msg);
+    void handleTurnChange(const Message &msg);
+    void handleFireBatch(const Message &msg);
+    void handleBatchResult(const Message &msg);
+    void handleAck(const Message &msg);
+    void handlePong(const Message &msg);
 };
 
 #endif // NETWORKCLIENT_H
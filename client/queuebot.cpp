@@ -0,0 +1,90 @@
+#include "queuebot.h"
+
+QueueBot::QueueBot() {}
+
+void QueueBot::reset(const int *fleetSizes, int count) {
+    Q_UNUSED(fleetSizes);
+    Q_UNUSED(count);
+    closed = Bitboard();
+    hits = Bitboard();
+    targetQueue.clear();
+    shipHitPoints.clear();
+}
+
+int QueueBot::nextShot(QRandomGenerator &rng) {
+    // Сначала очередь добивания, негодные цели выбрасываем
+    while (!targetQueue.isEmpty()) {
+        QPoint target = targetQueue.takeFirst();
+        if (BoardModel::inBounds(target.x(), target.y())) {
+            int idx = BoardModel::index(target.x(), target.y());
+            if (!closed.test(idx)) return idx;
+        }
+    }
+
+    // Иначе — случайная клетка из еще открытых
+    Bitboard open = ~closed;
+    int count = open.count();
+    if (count == 0) return -1;
+    for (int skip = rng.bounded(count); skip > 0; --skip) open.popFirst();
+    return open.first();
+}
+
+void QueueBot::onShotResult(int x, int y, int result) {
+    if (!BoardModel::inBounds(x, y) || result < 0) return;
+    int idx = BoardModel::index(x, y);
+    closed.set(idx);
+    if (result == BoardModel::ShotMiss) return;
+
+    hits.set(idx);
+    if (result == BoardModel::ShotKill) {
+        // Вокруг потопленного кораблей нет
+        closed |= BoardModel::halo(BoardModel::component(hits, idx));
+        targetQueue.clear();
+        shipHitPoints.clear();
+        return;
+    }
+
+    shipHitPoints.append(QPoint(x, y));
+    if (shipHitPoints.size() == 1) addInitialTargets(x, y);
+    else determineNextTargetLine();
+}
+
+void QueueBot::addInitialTargets(int x, int y) {
+    int dx[] = {-1, 1, 0, 0};
+    int dy[] = {0, 0, -1, 1};
+    for(int i=0; i<4; ++i) {
+        int nx = x + dx[i];
+        int ny = y + dy[i];
+        if (nx >= 0 && nx < 10 && ny >= 0 && ny < 10) targetQueue.append(QPoint(nx, ny));
+    }
+}
+
+void QueueBot::determineNextTargetLine() {
+    if (shipHitPoints.size() < 2) return;
+    QPoint p1 = shipHitPoints.first();
+    QPoint p2 = shipHitPoints.last();
+    bool isHorizontal = (p1.y() == p2.y());
+    bool isVertical = (p1.x() == p2.x());
+
+    if (isHorizontal) {
+        int y = p1.y();
+        int minX = 10, maxX = -1;
+        for(const auto& p : shipHitPoints) {
+            if (p.x() < minX) minX = p.x();
+            if (p.x() > maxX) maxX = p.x();
+        }
+        targetQueue.clear();
+        targetQueue.append(QPoint(minX - 1, y));
+        targetQueue.append(QPoint(maxX + 1, y));
+    } else if (isVertical) {
+        int x = p1.x();
+        int minY = 10, maxY = -1;
+        for(const auto& p : shipHitPoints) {
+            if (p.y() < minY) minY = p.y();
+            if (p.y() > maxY) maxY = p.y();
+        }
+        targetQueue.clear();
+        targetQueue.append(QPoint(x, minY - 1));
+        targetQueue.append(QPoint(x, maxY + 1));
+    }
+}
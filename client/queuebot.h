@@ -0,0 +1,32 @@
+#ifndef QUEUEBOT_H
+#define QUEUEBOT_H
+
+#include <QList>
+#include <QPoint>
+#include "boardmodel.h"
+#include "shooter.h"
+
+// "Обычный" бот: случайные выстрелы, после попадания — очередь соседних клеток,
+// после второго попадания — концы линии корабля.
+class QueueBot : public Shooter
+{
+public:
+    QueueBot();
+
+    const char *name() const override { return "queue"; }
+    void reset(const int *fleetSizes, int count) override;
+    int nextShot(QRandomGenerator &rng) override;
+    void onShotResult(int x, int y, int result) override;
+
+private:
+    Bitboard closed;  // Куда стрелять бессмысленно: выстрелы и ореолы потопленных
+    Bitboard hits;    // Все попадания
+
+    QList<QPoint> targetQueue;
+    QList<QPoint> shipHitPoints;
+
+    void addInitialTargets(int x, int y);
+    void determineNextTargetLine();
+};
+
+#endif // QUEUEBOT_H
@@ -0,0 +1,228 @@
+#include "replaywindow.h"
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QPainter>
+#include <QSignalBlocker>
+
+ReplayWindow::ReplayWindow(const QString &path, QWidget *parent)
+    : QWidget(parent), file(path)
+{
+    setWindowTitle("Морской Бой - Запись партии");
+    resize(1000, 700);
+
+    // Запись читается прямо из отображенного файла, без копии
+    if (file.open(QIODevice::ReadOnly) && file.size() > 0) {
+        const uchar *data = file.map(0, file.size());
+        valid = data && replay.open(data, std::size_t(file.size()));
+    }
+
+    setupUI(QFileInfo(path).completeBaseName());
+    if (!valid) {
+        infoLabel->setText("НЕ УДАЛОСЬ\nОТКРЫТЬ ЗАПИСЬ");
+        slider->setEnabled(false);
+        return;
+    }
+
+    placeFleets();
+    for (int step = 0; step < replay.stepCount(); ++step) eventList->addItem(describe(replay.event(step)));
+    slider->setRange(0, replay.stepCount());
+    slider->setValue(replay.stepCount());
+    showStep(replay.stepCount());
+}
+
+void ReplayWindow::setupUI(const QString &title) {
+    QVBoxLayout *globalLayout = new QVBoxLayout(this);
+    globalLayout->setContentsMargins(0, 0, 0, 0);
+    globalLayout->setSpacing(0);
+
+    // --- Header ---
+    QWidget *headerWidget = new QWidget(this);
+    headerWidget->setStyleSheet("background-color: rgba(60, 50, 40, 200); border-bottom: 2px solid #555;");
+    headerWidget->setFixedHeight(60);
+    QHBoxLayout *headerLayout = new QHBoxLayout(headerWidget);
+    headerLayout->setContentsMargins(20, 0, 20, 0);
+
+    QLabel *titleLabel = new QLabel("ЗАПИСЬ: " + title, this);
+    titleLabel->setStyleSheet("color: #f0e6d2; font-weight: bold; font-size: 24px; font-family: 'Courier New';");
+
+    QPushButton *leaveBtn = new QPushButton("ВЫЙТИ", this);
+    leaveBtn->setCursor(Qt::PointingHandCursor);
+    leaveBtn->setStyleSheet(
+        "QPushButton { background-color: #c0392b; color: white; border: 2px solid #922b21; }"
+        "QPushButton:hover { background-color: #e74c3c; }"
+        );
+    connect(leaveBtn, &QPushButton::clicked, this, &ReplayWindow::onLeaveClicked);
+
+    headerLayout->addWidget(titleLabel);
+    headerLayout->addStretch();
+    headerLayout->addWidget(leaveBtn);
+    globalLayout->addWidget(headerWidget);
+
+    // --- Поля и центральная колонка ---
+    QWidget *contentWidget = new QWidget(this);
+    contentWidget->setStyleSheet("background: transparent;");
+    QHBoxLayout *mainLayout = new QHBoxLayout(contentWidget);
+    mainLayout->setContentsMargins(30, 10, 30, 20);
+    mainLayout->setSpacing(20);
+
+    QVBoxLayout *columns[2];
+    for (int side = 0; side < 2; ++side) {
+        columns[side] = new QVBoxLayout();
+
+        QLabel *fleetTitle = new QLabel(side == 0 ? QString("ФЛОТ ИГРОКА") : "ФЛОТ: " + sideName(2).toUpper());
+        fleetTitle->setAlignment(Qt::AlignCenter);
+        fleetTitle->setStyleSheet("font-weight: bold; color: #333; font-size: 18px; margin-bottom: 5px;");
+
+        // Только просмотр: корабли видны, клики до поля не доходят
+        boards[side] = new BoardWidget(this);
+        boards[side]->setEnemy(side == 1);
+        boards[side]->setEditable(false);
+        boards[side]->setShowShips(true);
+        boards[side]->setAttribute(Qt::WA_TransparentForMouseEvents);
+        boards[side]->setupSizePolicy();
+
+        columns[side]->addWidget(fleetTitle);
+        columns[side]->addWidget(boards[side]);
+        columns[side]->addStretch(1);
+    }
+
+    QWidget *centerWidget = new QWidget();
+    centerWidget->setFixedWidth(280);
+    centerWidget->setStyleSheet("background-color: #f0e6d2; border: 4px solid #2c3e50; border-radius: 0px;");
+    QVBoxLayout *centerLayout = new QVBoxLayout(centerWidget);
+    centerLayout->setContentsMargins(15, 15, 15, 15);
+
+    infoLabel = new QLabel();
+    infoLabel->setAlignment(Qt::AlignCenter);
+    infoLabel->setWordWrap(true);
+    infoLabel->setMinimumHeight(60);
+    infoLabel->setStyleSheet("font-size: 18px; font-weight: bold; color: #2c3e50; border-bottom: 2px solid #ccc; padding-bottom: 10px; font-family: 'Courier New';");
+
+    eventList = new QListWidget();
+    eventList->setFocusPolicy(Qt::NoFocus);
+    eventList->setStyleSheet("QListWidget { background: transparent; border: none; font-family: 'Courier New'; font-size: 13px; }");
+    connect(eventList, &QListWidget::currentRowChanged, this, &ReplayWindow::onEventSelected);
+
+    // Перемотка: ползунок по шагам и по шагу кнопками
+    slider = new QSlider(Qt::Horizontal);
+    connect(slider, &QSlider::valueChanged, this, &ReplayWindow::showStep);
+
+    QPushButton *prevBtn = new QPushButton("<");
+    QPushButton *nextBtn = new QPushButton(">");
+    connect(prevBtn, &QPushButton::clicked, this, [this]() { slider->setValue(slider->value() - 1); });
+    connect(nextBtn, &QPushButton::clicked, this, [this]() { slider->setValue(slider->value() + 1); });
+    QHBoxLayout *seekLayout = new QHBoxLayout();
+    seekLayout->addWidget(prevBtn);
+    seekLayout->addWidget(slider, 1);
+    seekLayout->addWidget(nextBtn);
+
+    centerLayout->addWidget(infoLabel);
+    centerLayout->addWidget(eventList, 1);
+    centerLayout->addLayout(seekLayout);
+
+    mainLayout->addLayout(columns[0], 2);
+    mainLayout->addWidget(centerWidget);
+    mainLayout->addLayout(columns[1], 2);
+    globalLayout->addWidget(contentWidget);
+}
+
+void ReplayWindow::paintEvent(QPaintEvent *) {
+    // Фон как у окна наблюдения
+    QPainter p(this);
+    p.fillRect(rect(), QColor(248, 240, 227));
+    p.setBrush(QColor(160, 160, 160));
+    p.setPen(Qt::NoPen);
+    for (int y = 0; y < height(); y += 50) {
+        for (int x = -50; x < width() + 50; x += 30) {
+            p.drawRect(x, y, 4, 4);
+        }
+    }
+}
+
+// Корабли на поля — из масок флотов в конце записи (расстановка за партию не меняется)
+void ReplayWindow::placeFleets() {
+    MatchLog::State last;
+    replay.seek(replay.stepCount(), &last);
+    for (int side = 0; side < 2; ++side) {
+        Bitboard rest = last.sides[side].ships;
+        int count = 0;
+        for (int idx = rest.first(); idx >= 0 && count < BoardModel::MAX_SHIPS; idx = rest.first()) {
+            Bitboard mask = BoardModel::component(rest, idx);
+            rest = rest & ~mask;
+            Ship &ship = ships[side][count];
+            ship = Ship(count++, mask.count());
+            ship.topLeft = QPoint(idx % 10, idx / 10);
+            ship.orientation = mask.count() > 1 && mask.test(idx + 10) ? Orientation::Vertical : Orientation::Horizontal;
+        }
+        shipCounts[side] = count;
+        boards[side]->setShips(ships[side], count);
+    }
+}
+
+void ReplayWindow::showStep(int step) {
+    if (!valid) return;
+    MatchLog::State state;
+    replay.seek(step, &state);
+    for (int side = 0; side < 2; ++side) {
+        // Подбитые палубы — по состоянию на этот шаг (убитые корабли рисуются иначе)
+        for (int i = 0; i < shipCounts[side]; ++i) {
+            Ship &ship = ships[side][i];
+            Bitboard mask = BoardModel::shipMask(ship.topLeft.x(), ship.topLeft.y(), ship.size, ship.orientation);
+            ship.hits = (mask & state.sides[side].hits).count();
+        }
+        boards[side]->setShots(state.sides[side].hits, state.sides[side].misses);
+        // Подсвечено поле, по которому сейчас стреляют
+        boards[side]->setActive(state.winner == 0 && state.turn == 2 - side);
+    }
+
+    QSignalBlocker blocker(eventList);
+    eventList->setCurrentRow(step - 1);
+
+    std::uint32_t timeMs = step > 0 ? replay.event(step - 1).timeMs : 0;
+    QString time = QString("%1:%2").arg(timeMs / 60000).arg(timeMs / 1000 % 60, 2, 10, QChar('0'));
+    QString status;
+    if (state.winner != 0) status = "ПОБЕДА: " + sideName(state.winner).toUpper();
+    else if (state.turn == 0) status = "РАССТАНОВКА";
+    else status = "ХОДИТ: " + sideName(state.turn).toUpper();
+    infoLabel->setText(QString("ШАГ %1 / %2  %3\n%4").arg(step).arg(replay.stepCount()).arg(time, status));
+}
+
+void ReplayWindow::onEventSelected(int row) {
+    // Выбранное событие — последнее примененное
+    if (row >= 0) slider->setValue(row + 1);
+}
+
+void ReplayWindow::onLeaveClicked() {
+    emit backToMenu();
+    close();
+}
+
+QString ReplayWindow::sideName(int side) const {
+    if (side == 1) return "Игрок";
+    return replay.getMode() == MatchLog::ModeSingle ? "Бот" : "Соперник";
+}
+
+QString ReplayWindow::describe(const MatchLog::Event &event) const {
+    static const char *const results[] = {"повтор", "мимо", "попал", "убил"};
+    static const char *const abilities[] = {"", "туман", "радар", "авиаудар"};
+    QString cell = event.cell >= 0 ? QString("%1%2").arg(QChar('A' + event.cell % 10)).arg(event.cell / 10 + 1) : QString();
+    QString time = QString("%1:%2 ").arg(event.timeMs / 60000).arg(event.timeMs / 1000 % 60, 2, 10, QChar('0'));
+
+    switch (event.type) {
+    case MatchLog::RecFleet:
+        return time + QString("%1: расстановка (%2)").arg(sideName(event.side)).arg(event.value);
+    case MatchLog::RecShot:
+        return time + QString("%1: %2 %3").arg(sideName(event.side), cell,
+                                               results[qBound(0, event.value + 1, 3)]);
+    case MatchLog::RecAbility:
+        return time + QString("%1: %2 %3").arg(sideName(event.side),
+                                               event.value >= 1 && event.value <= 3 ? abilities[event.value] : "?", cell);
+    case MatchLog::RecTurn:
+        return time + "ход: " + sideName(event.side);
+    case MatchLog::RecEnd:
+        return time + "победа: " + sideName(event.side);
+    default:
+        return time + "?";
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef REPLAYWINDOW_H
+#define REPLAYWINDOW_H
+
+#include <QWidget>
+#include <QFile>
+#include <QLabel>
+#include <QListWidget>
+#include <QPushButton>
+#include <QSlider>
+#include "boardwidget.h"
+#include "matchlog.h"
+
+// Просмотр записи партии (MatchRecorder): файл отображается в память целиком, ползунок
+// перематывает на любой шаг — состояние берется от ближайшего снимка в записи.
+// Для разбора спорных партий: видны обе расстановки (у сетевой — только своя), все выстрелы и способности.
+class ReplayWindow : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ReplayWindow(const QString &path, QWidget *parent = nullptr);
+
+    bool isValid() const { return valid; }
+
+signals:
+    void backToMenu();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private slots:
+    void showStep(int step);
+    void onEventSelected(int row);
+    void onLeaveClicked();
+
+private:
+    QFile file;
+    MatchReplay replay;
+    bool valid = false;
+
+    BoardWidget *boards[2]; // Флот стороны 1 (владелец записи) и стороны 2
+    Ship ships[2][BoardModel::MAX_SHIPS]; // Корабли полей (по записи), поля хранят только указатель
+    int shipCounts[2] = {0, 0};
+    QLabel *infoLabel;
+    QListWidget *eventList;
+    QSlider *slider;
+
+    void setupUI(const QString &title);
+    void placeFleets();
+    QString sideName(int side) const;
+    QString describe(const MatchLog::Event &event) const;
+};
+
+#endif // REPLAYWINDOW_H
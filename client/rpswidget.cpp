@@ -5,6 +5,7 @@
 #include <QRandomGenerator>
 #include <QMouseEvent>
 #include <QPropertyAnimation>
+#include "animationclock.h"
 
 // --- RPSItem ---
 
@@ -13,27 +14,24 @@ RPSItem::RPSItem(RPSType type, QWidget *parent)
 {
     setFixedSize(100, 100);
     setCursor(Qt::PointingHandCursor);
-    shakeTimer = new QTimer(this);
-    shakeTimer->setInterval(30);
-    connect(shakeTimer, &QTimer::timeout, this, &RPSItem::updateShake);
 }
 
 void RPSItem::setDisabledState(bool disabled) {
     isDisabled = disabled;
     setCursor(disabled ? Qt::ArrowCursor : Qt::PointingHandCursor);
-    if (disabled) shakeTimer->stop();
+    if (disabled) AnimationClock::instance()->stop(this);
     update();
 }
 
 void RPSItem::enterEvent(QEnterEvent *) {
     if (isDisabled) return;
     isHovered = true;
-    shakeTimer->start();
+    AnimationClock::instance()->repeat(this, AnimationClock::SHAKE_MS, [this]() { updateShake(); });
 }
 
 void RPSItem::leaveEvent(QEvent *) {
     isHovered = false;
-    shakeTimer->stop();
+    AnimationClock::instance()->stop(this);
     shakeOffset = QPoint(0, 0);
     update();
 }
@@ -28,7 +28,6 @@ private slots:
 
 private:
     RPSType type;
-    QTimer *shakeTimer;
     QPoint shakeOffset;
     bool isHovered;
     bool isDisabled;
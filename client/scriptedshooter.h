@@ -0,0 +1,44 @@
+#ifndef SCRIPTEDSHOOTER_H
+#define SCRIPTEDSHOOTER_H
+
+#include <QVector>
+#include "boardmodel.h"
+#include "shooter.h"
+
+// Выстрелы по заранее заданному списку клеток (y * 10 + x), потом — по порядку в еще не простреленные.
+// Для воспроизводимых партий HeadlessPlayer: одинаковый сценарий дает одинаковый обмен сообщениями.
+class ScriptedShooter : public Shooter
+{
+public:
+    explicit ScriptedShooter(const QVector<int> &cells = QVector<int>()) : script(cells) {}
+
+    const char *name() const override { return "script"; }
+
+    void reset(const int *fleetSizes, int count) override {
+        Q_UNUSED(fleetSizes);
+        Q_UNUSED(count);
+        shot = Bitboard();
+        next = 0;
+    }
+
+    int nextShot(QRandomGenerator &rng) override {
+        Q_UNUSED(rng);
+        while (next < script.size()) {
+            int idx = script[next++];
+            if (idx >= 0 && idx < BoardModel::CELLS && !shot.test(idx)) return idx;
+        }
+        return (~shot).first();
+    }
+
+    void onShotResult(int x, int y, int result) override {
+        Q_UNUSED(result);
+        if (BoardModel::inBounds(x, y)) shot.set(BoardModel::index(x, y));
+    }
+
+private:
+    QVector<int> script;
+    int next = 0;
+    Bitboard shot;
+};
+
+#endif // SCRIPTEDSHOOTER_H
@@ -0,0 +1,22 @@
+#ifndef SHOOTER_H
+#define SHOOTER_H
+
+#include <QRandomGenerator>
+
+// Стратегия стрельбы бота: выбирает клетку и узнает результат своего выстрела.
+// Общий интерфейс для GameWindow и турнира ботов (tools/selfplay).
+class Shooter
+{
+public:
+    virtual ~Shooter() {}
+
+    // Короткое имя стратегии (для отчетов и командной строки)
+    virtual const char *name() const = 0;
+    virtual void reset(const int *fleetSizes, int count) = 0;
+    // Индекс клетки (y * 10 + x) для следующего выстрела, -1 — стрелять некуда
+    virtual int nextShot(QRandomGenerator &rng) = 0;
+    // Результат выстрела: -1 уже стреляли, 0 мимо, 1 попал, 2 убил
+    virtual void onShotResult(int x, int y, int result) = 0;
+};
+
+#endif // SHOOTER_H
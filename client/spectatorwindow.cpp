@@ -0,0 +1,182 @@
+#include "spectatorwindow.h"
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QPainter>
+
+SpectatorWindow::SpectatorWindow(NetworkClient *client, const QString &gameName, int turn, const QVector<int> &shots,
+                                 QWidget *parent)
+    : QWidget(parent), netClient(client), turn(turn)
+{
+    setWindowTitle("Морской Бой - Наблюдение");
+    resize(1000, 700);
+
+    for (int size : FLEET_SIZES) fleetCells += size;
+
+    connect(netClient, &NetworkClient::spectatorShot, this, &SpectatorWindow::onShot);
+    connect(netClient, &NetworkClient::spectatorTurnChanged, this, &SpectatorWindow::onTurnChanged);
+    connect(netClient, &NetworkClient::spectatorChat, this, &SpectatorWindow::onChat);
+    connect(netClient, &NetworkClient::spectatorPlayerJoined, this, &SpectatorWindow::onPlayerJoined);
+    connect(netClient, &NetworkClient::spectateEnded, this, &SpectatorWindow::onEnded);
+    connect(netClient, &NetworkClient::disconnected, this, &SpectatorWindow::onEnded);
+
+    setupUI(gameName);
+
+    // Выстрелы, сделанные до нашего прихода: по три числа (кто, клетка, результат)
+    for (int i = 0; i + 2 < shots.size(); i += 3) applyShot(shots[i], shots[i + 1] % 10, shots[i + 1] / 10, shots[i + 2]);
+    updateInfo();
+}
+
+void SpectatorWindow::setupUI(const QString &gameName) {
+    QVBoxLayout *globalLayout = new QVBoxLayout(this);
+    globalLayout->setContentsMargins(0, 0, 0, 0);
+    globalLayout->setSpacing(0);
+
+    // --- Header ---
+    QWidget *headerWidget = new QWidget(this);
+    headerWidget->setStyleSheet("background-color: rgba(60, 50, 40, 200); border-bottom: 2px solid #555;");
+    headerWidget->setFixedHeight(60);
+    QHBoxLayout *headerLayout = new QHBoxLayout(headerWidget);
+    headerLayout->setContentsMargins(20, 0, 20, 0);
+
+    QLabel *title = new QLabel(gameName.isEmpty() ? QString("НАБЛЮДЕНИЕ") : "НАБЛЮДЕНИЕ: " + gameName, this);
+    title->setStyleSheet("color: #f0e6d2; font-weight: bold; font-size: 24px; font-family: 'Courier New';");
+
+    QPushButton *leaveBtn = new QPushButton("ВЫЙТИ", this);
+    leaveBtn->setCursor(Qt::PointingHandCursor);
+    leaveBtn->setStyleSheet(
+        "QPushButton { background-color: #c0392b; color: white; border: 2px solid #922b21; }"
+        "QPushButton:hover { background-color: #e74c3c; }"
+        );
+    connect(leaveBtn, &QPushButton::clicked, this, &SpectatorWindow::onLeaveClicked);
+
+    headerLayout->addWidget(title);
+    headerLayout->addStretch();
+    headerLayout->addWidget(leaveBtn);
+    globalLayout->addWidget(headerWidget);
+
+    // --- Поля и центральная колонка ---
+    QWidget *contentWidget = new QWidget(this);
+    contentWidget->setStyleSheet("background: transparent;");
+    QHBoxLayout *mainLayout = new QHBoxLayout(contentWidget);
+    mainLayout->setContentsMargins(30, 10, 30, 20);
+    mainLayout->setSpacing(20);
+
+    QVBoxLayout *columns[2];
+    for (int side = 0; side < 2; ++side) {
+        columns[side] = new QVBoxLayout();
+
+        QLabel *fleetTitle = new QLabel(QString("ФЛОТ ИГРОКА %1").arg(side + 1));
+        fleetTitle->setAlignment(Qt::AlignCenter);
+        fleetTitle->setStyleSheet("font-weight: bold; color: #333; font-size: 18px; margin-bottom: 5px;");
+
+        hitLabels[side] = new QLabel();
+        hitLabels[side]->setAlignment(Qt::AlignCenter);
+        hitLabels[side]->setStyleSheet("color: #555; font-size: 14px; font-family: 'Courier New';");
+
+        // Только просмотр: кораблей не видно, клики и наведение до поля не доходят
+        boards[side] = new BoardWidget(this);
+        boards[side]->setEnemy(true);
+        boards[side]->setEditable(false);
+        boards[side]->setShowShips(false);
+        boards[side]->setAttribute(Qt::WA_TransparentForMouseEvents);
+        boards[side]->setupSizePolicy();
+
+        columns[side]->addWidget(fleetTitle);
+        columns[side]->addWidget(hitLabels[side]);
+        columns[side]->addWidget(boards[side]);
+        columns[side]->addStretch(1);
+    }
+
+    QWidget *centerWidget = new QWidget();
+    centerWidget->setFixedWidth(280);
+    centerWidget->setStyleSheet("background-color: #f0e6d2; border: 4px solid #2c3e50; border-radius: 0px;");
+    QVBoxLayout *centerLayout = new QVBoxLayout(centerWidget);
+    centerLayout->setContentsMargins(15, 15, 15, 15);
+
+    infoLabel = new QLabel();
+    infoLabel->setAlignment(Qt::AlignCenter);
+    infoLabel->setWordWrap(true);
+    infoLabel->setMinimumHeight(60);
+    infoLabel->setStyleSheet("font-size: 18px; font-weight: bold; color: #2c3e50; border-bottom: 2px solid #ccc; padding-bottom: 10px; font-family: 'Courier New';");
+
+    chatList = new QListWidget();
+    chatList->setFocusPolicy(Qt::NoFocus);
+    chatList->setSelectionMode(QAbstractItemView::NoSelection);
+    chatList->setStyleSheet("QListWidget { background: transparent; border: none; font-family: 'Courier New'; font-size: 14px; }");
+
+    centerLayout->addWidget(infoLabel);
+    centerLayout->addWidget(new QLabel("ЧАТ ИГРОКОВ"));
+    centerLayout->addWidget(chatList, 1);
+
+    mainLayout->addLayout(columns[0], 2);
+    mainLayout->addWidget(centerWidget);
+    mainLayout->addLayout(columns[1], 2);
+    globalLayout->addWidget(contentWidget);
+}
+
+void SpectatorWindow::paintEvent(QPaintEvent *) {
+    // Фон как у окна сетевой игры
+    QPainter p(this);
+    p.fillRect(rect(), QColor(248, 240, 227));
+    p.setBrush(QColor(160, 160, 160));
+    p.setPen(Qt::NoPen);
+    for (int y = 0; y < height(); y += 50) {
+        for (int x = -50; x < width() + 50; x += 30) {
+            p.drawRect(x, y, 4, 4);
+        }
+    }
+}
+
+// Выстрел игрока by ложится на поле его соперника
+void SpectatorWindow::applyShot(int by, int x, int y, int status) {
+    if ((by != 1 && by != 2) || x < 0 || x >= 10 || y < 0 || y >= 10) return;
+    int target = 2 - by;
+    bool hit = status == BoardModel::ShotHit || status == BoardModel::ShotKill;
+    if (hit && boards[target]->getCellState(x, y) != CellState::Hit) hits[target]++;
+    boards[target]->setCellState(x, y, hit ? CellState::Hit : CellState::Miss);
+    if (hits[target] >= fleetCells) gameOver = true;
+}
+
+void SpectatorWindow::onShot(int by, int x, int y, int status) {
+    applyShot(by, x, y, status);
+    updateInfo();
+}
+
+void SpectatorWindow::onTurnChanged(const QString &who) {
+    turn = who == "Player1" ? 1 : 2;
+    updateInfo();
+}
+
+void SpectatorWindow::onChat(int by, const QString &msg) {
+    chatList->addItem(QString("Игрок %1: %2").arg(by).arg(msg));
+    chatList->scrollToBottom();
+}
+
+void SpectatorWindow::onPlayerJoined(const QString &playerId) {
+    Q_UNUSED(playerId)
+    chatList->addItem("Второй игрок вошел в комнату");
+    updateInfo();
+}
+
+void SpectatorWindow::onEnded() {
+    if (!gameOver) infoLabel->setText("ИГРА ЗАВЕРШЕНА");
+    gameOver = true;
+    for (BoardWidget *board : boards) board->setActive(false);
+}
+
+void SpectatorWindow::onLeaveClicked() {
+    netClient->leaveSpectate();
+    emit backToMenu();
+    close();
+}
+
+void SpectatorWindow::updateInfo() {
+    for (int side = 0; side < 2; ++side) {
+        hitLabels[side]->setText(QString("Подбито %1 из %2").arg(hits[side]).arg(fleetCells));
+        // Подсвечено поле, по которому сейчас стреляют
+        boards[side]->setActive(!gameOver && turn == 2 - side);
+    }
+    if (gameOver) infoLabel->setText(hits[0] >= fleetCells ? "ПОБЕДИЛ ИГРОК 2" : "ПОБЕДИЛ ИГРОК 1");
+    else if (turn == 0) infoLabel->setText("ИГРОКИ ГОТОВЯТСЯ\nК БОЮ");
+    else infoLabel->setText(QString("ХОДИТ\nИГРОК %1").arg(turn));
+}
@@ -0,0 +1,52 @@
+#ifndef SPECTATORWINDOW_H
+#define SPECTATORWINDOW_H
+
+#include <QWidget>
+#include <QLabel>
+#include <QListWidget>
+#include <QPushButton>
+#include <QVector>
+#include "boardwidget.h"
+#include "networkclient.h"
+
+// Чужая игра глазами зрителя: два поля только для просмотра, ход и чат.
+// Корабли зрителю не видны — на полях только выстрелы с результатами, которые рассылает сервер.
+class SpectatorWindow : public QWidget
+{
+    Q_OBJECT
+public:
+    // Начальное состояние — из NetworkClient::spectateStarted
+    SpectatorWindow(NetworkClient *client, const QString &gameName, int turn, const QVector<int> &shots,
+                    QWidget *parent = nullptr);
+
+signals:
+    void backToMenu();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private slots:
+    void onShot(int by, int x, int y, int status);
+    void onTurnChanged(const QString &who);
+    void onChat(int by, const QString &msg);
+    void onPlayerJoined(const QString &playerId);
+    void onEnded();
+    void onLeaveClicked();
+
+private:
+    NetworkClient *netClient;
+    BoardWidget *boards[2];   // Флот Player1 и флот Player2: по флоту стреляет его соперник
+    QLabel *hitLabels[2];
+    QLabel *infoLabel;
+    QListWidget *chatList;
+    int hits[2] = {0, 0};     // Подбитых клеток флота
+    int fleetCells = 0;
+    int turn = 0;             // 0 — бой еще не начался, 1/2 — ходит Player1/Player2
+    bool gameOver = false;
+
+    void setupUI(const QString &gameName);
+    void applyShot(int by, int x, int y, int status);
+    void updateInfo();
+};
+
+#endif // SPECTATORWINDOW_H
@@ -0,0 +1,41 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// Очередь без блокировок на одного писателя и одного читателя.
+// push вызывает только поток-производитель, pop — только поток-потребитель.
+template <typename T, unsigned Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // false — очередь полна (value при этом не тронут)
+    bool push(T &&value) {
+        unsigned t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) return false;
+        items[t & (Capacity - 1)] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // false — очередь пуста
+    bool pop(T &value) {
+        unsigned h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        T &slot = items[h & (Capacity - 1)];
+        value = std::move(slot);
+        slot = T(); // Не держим память отданного элемента
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T items[Capacity];
+    alignas(64) std::atomic<unsigned> head{0}; // Пишет только читатель
+    alignas(64) std::atomic<unsigned> tail{0}; // Пишет только писатель
+};
+
+#endif // SPSCQUEUE_H
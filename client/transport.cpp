@@ -0,0 +1,132 @@
+#include "transport.h"
+#include <cstring>
+
+// --- TCP ---
+
+TcpTransport::TcpTransport(QObject *parent) : Transport(parent)
+{
+    socket = new QTcpSocket(this);
+    connect(socket, &QTcpSocket::connected, this, &Transport::connected);
+    connect(socket, &QTcpSocket::disconnected, this, &Transport::disconnected);
+    connect(socket, &QTcpSocket::readyRead, this, &Transport::readyRead);
+    connect(socket, &QTcpSocket::errorOccurred, this,
+            [this](QAbstractSocket::SocketError) { emit errorOccurred(socket->errorString()); });
+}
+
+void TcpTransport::open(const QString &host, quint16 port) {
+    socket->abort();
+    socket->connectToHost(host, port);
+}
+
+void TcpTransport::abort() {
+    socket->abort();
+}
+
+bool TcpTransport::isOpen() const {
+    return socket->state() == QAbstractSocket::ConnectedState;
+}
+
+qint64 TcpTransport::write(const QByteArray &data) {
+    return socket->write(data);
+}
+
+void TcpTransport::flush() {
+    socket->flush();
+}
+
+qint64 TcpTransport::bytesToWrite() const {
+    return socket->bytesToWrite();
+}
+
+qint64 TcpTransport::bytesAvailable() const {
+    return socket->bytesAvailable();
+}
+
+qint64 TcpTransport::read(char *data, qint64 maxSize) {
+    return socket->read(data, maxSize);
+}
+
+QString TcpTransport::errorString() const {
+    return socket->errorString();
+}
+
+// --- Loopback ---
+
+void LoopbackTransport::setPeer(LoopbackTransport *other) {
+    peer = other;
+    if (other) other->peer = this;
+}
+
+void LoopbackTransport::open(const QString &host, quint16 port) {
+    Q_UNUSED(host)
+    Q_UNUSED(port)
+    close(true);
+    if (!peer) {
+        // Как отказ в подключении: ошибка без disconnected
+        QMetaObject::invokeMethod(this, [this]() {
+            errorText = "Loopback peer is gone";
+            emit errorOccurred(errorText);
+        }, Qt::QueuedConnection);
+        return;
+    }
+    // Подключение завершается на следующей итерации цикла, как у сокета
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!peer || opened) return;
+        opened = true;
+        peer->opened = true;
+        emit peer->connected();
+        emit connected();
+    }, Qt::QueuedConnection);
+}
+
+void LoopbackTransport::abort() {
+    close(true);
+}
+
+qint64 LoopbackTransport::write(const QByteArray &data) {
+    if (!opened || !peer) return -1;
+    peer->deliver(data);
+    return data.size();
+}
+
+void LoopbackTransport::deliver(const QByteArray &data) {
+    // Прочитанное целиком выбрасываем: буфер не растет за время партии
+    if (readPos == inbox.size()) {
+        inbox.clear();
+        readPos = 0;
+    }
+    inbox.append(data);
+    if (readPending) return;
+    readPending = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        readPending = false;
+        if (opened && bytesAvailable() > 0) emit readyRead();
+    }, Qt::QueuedConnection);
+}
+
+qint64 LoopbackTransport::read(char *data, qint64 maxSize) {
+    qint64 n = qMin(maxSize, bytesAvailable());
+    if (n <= 0) return 0;
+    memcpy(data, inbox.constData() + readPos, size_t(n));
+    readPos += n;
+    return n;
+}
+
+void LoopbackTransport::close(bool notifyPeer) {
+    inbox.clear();
+    readPos = 0;
+    if (!opened) return;
+    opened = false;
+    if (notifyPeer && peer && peer->opened) {
+        // Закрытие доходит до второго конца тоже через очередь: сначала он дочитает то, что уже пришло
+        QPointer<LoopbackTransport> other = peer;
+        QMetaObject::invokeMethod(other, [other]() {
+            if (!other || !other->opened) return;
+            other->opened = false;
+            other->errorText = "Remote closed";
+            emit other->errorOccurred(other->errorText);
+            emit other->disconnected();
+        }, Qt::QueuedConnection);
+    }
+    emit disconnected();
+}
@@ -0,0 +1,91 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QByteArray>
+#include <QPointer>
+
+// Поток байт до сервера под NetworkClient. События — как у сокета: connected, readyRead,
+// disconnected (только если соединение было), errorOccurred (неудачное подключение или обрыв).
+class Transport : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Transport(QObject *parent = nullptr) : QObject(parent) {}
+
+    virtual void open(const QString &host, quint16 port) = 0;
+    virtual void abort() = 0;
+    virtual bool isOpen() const = 0;
+
+    virtual qint64 write(const QByteArray &data) = 0;
+    virtual void flush() {}
+    virtual qint64 bytesToWrite() const { return 0; }
+
+    virtual qint64 bytesAvailable() const = 0;
+    virtual qint64 read(char *data, qint64 maxSize) = 0;
+
+    virtual QString errorString() const = 0;
+
+signals:
+    void connected();
+    void disconnected();
+    void readyRead();
+    void errorOccurred(const QString &message);
+};
+
+class TcpTransport : public Transport
+{
+    Q_OBJECT
+public:
+    explicit TcpTransport(QObject *parent = nullptr);
+
+    void open(const QString &host, quint16 port) override;
+    void abort() override;
+    bool isOpen() const override;
+    qint64 write(const QByteArray &data) override;
+    void flush() override;
+    qint64 bytesToWrite() const override;
+    qint64 bytesAvailable() const override;
+    qint64 read(char *data, qint64 maxSize) override;
+    QString errorString() const override;
+
+private:
+    QTcpSocket *socket;
+};
+
+// Пара каналов в памяти: что записано в один конец, читается из другого. Без сокетов и сервера —
+// для партий внутри одного процесса (LoopbackServer, бенчмарки). Оба конца живут в одном потоке;
+// данные доходят событием в очереди, как из сокета, порядок событий детерминирован.
+class LoopbackTransport : public Transport
+{
+    Q_OBJECT
+public:
+    explicit LoopbackTransport(QObject *parent = nullptr) : Transport(parent) {}
+
+    // Второй конец, который принимает подключение (сторона сервера). open() клиента
+    // открывает оба конца: у этого испускается connected раньше, чем у клиента.
+    void setPeer(LoopbackTransport *peer);
+    LoopbackTransport *getPeer() const { return peer; }
+
+    void open(const QString &host, quint16 port) override;
+    void abort() override;
+    bool isOpen() const override { return opened; }
+    qint64 write(const QByteArray &data) override;
+    qint64 bytesAvailable() const override { return inbox.size() - readPos; }
+    qint64 read(char *data, qint64 maxSize) override;
+    QString errorString() const override { return errorText; }
+
+private:
+    QPointer<LoopbackTransport> peer;
+    QByteArray inbox;
+    qint64 readPos = 0;
+    bool opened = false;
+    bool readPending = false; // readyRead уже в очереди
+    QString errorText;
+
+    void deliver(const QByteArray &data);
+    void close(bool notifyPeer);
+};
+
+#endif // TRANSPORT_H
@@ -0,0 +1,289 @@
+#include "wireprotocol.h"
+#include <cstring>
+
+int WireProtocol::putVarint(std::uint32_t value, std::uint8_t *out) {
+    int n = 0;
+    while (value >= 0x80) {
+        out[n++] = std::uint8_t(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = std::uint8_t(value);
+    return n;
+}
+
+int WireProtocol::getVarint(const std::uint8_t *data, int avail, std::uint32_t *value) {
+    std::uint32_t result = 0;
+    for (int i = 0; i < MAX_VARINT; ++i) {
+        if (i >= avail) return 0;
+        result |= std::uint32_t(data[i] & 0x7F) << (7 * i);
+        if (!(data[i] & 0x80)) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+int WireProtocol::encodeFrame(Opcode op, const std::uint8_t *payload, int size, std::uint8_t *out) {
+    int n = putVarint(std::uint32_t(size + 1), out);
+    out[n++] = op;
+    if (size > 0) std::memcpy(out + n, payload, size);
+    return n + size;
+}
+
+int WireProtocol::parseFrame(const std::uint8_t *data, int avail, std::uint8_t *op,
+                             const std::uint8_t **payload, int *size) {
+    std::uint32_t length = 0;
+    int header = getVarint(data, avail, &length);
+    if (header <= 0) return header;
+    if (length == 0 || length > std::uint32_t(MAX_FRAME)) return -1;
+    if (avail - header < int(length)) return 0;
+
+    *op = data[header];
+    *payload = data + header + 1;
+    *size = int(length) - 1;
+    if (!payloadSizeValid(*op, *size)) return -1;
+    return header + int(length);
+}
+
+bool WireProtocol::payloadSizeValid(std::uint8_t op, int size) {
+    switch (op) {
+    case OpReady: return size % 2 == 0 && size <= MAX_FLEET * 2;
+    case OpRps: return size == 1;
+    case OpFire: return size == 1 || size == 2;
+    case OpFireResult: return size == 2;
+    case OpTurnChange: return size == 1;
+    case OpFireBatch:
+    case OpBatchResult: return size >= 2 && size <= batchPayloadSize(MAX_BATCH, true);
+    case OpAck:
+    case OpPing:
+    case OpPong: return size >= 1 && size <= MAX_VARINT;
+    default: return true;
+    }
+}
+
+namespace {
+
+const int KEY_TABLE_SIZE = 64;
+
+constexpr const char *KEY_NAMES[WireProtocol::KeyCount] = {
+    "",
+    "game_created", "game_joined", "player_joined", "games_updated", "error", "game_event", "hello_ack", "pong",
+    "lobby_snapshot", "lobby_update", "spectate_begin", "spectate_event",
+    "create_game", "join_game", "get_games", "set_name", "ping", "hello",
+    "subscribe_lobby", "unsubscribe_lobby", "spectate_game", "leave_spectate",
+    "ack",
+    "ready", "rps", "fire", "fire_result", "chat", "turn_change", "fire_batch", "fire_batch_result"
+};
+
+constexpr int keyLength(const char *s) {
+    int n = 0;
+    while (s[n]) ++n;
+    return n;
+}
+
+// Константы подобраны так, что у всех известных ключей разные ячейки
+constexpr unsigned keyHash(const char *s, int len) {
+    return (unsigned(len) + std::uint8_t(s[1]) * 5 + std::uint8_t(s[len - 1]) * 2) & (KEY_TABLE_SIZE - 1);
+}
+
+// Таблица строится при компиляции
+struct KeyTable {
+    std::uint8_t slots[KEY_TABLE_SIZE] = {};
+    bool perfect = true; // Ни у одной пары ключей не совпала ячейка
+
+    constexpr KeyTable() {
+        for (int key = 1; key < WireProtocol::KeyCount; ++key) {
+            unsigned h = keyHash(KEY_NAMES[key], keyLength(KEY_NAMES[key]));
+            if (slots[h] != WireProtocol::KeyUnknown) perfect = false;
+            slots[h] = std::uint8_t(key);
+        }
+    }
+};
+
+constexpr KeyTable keyTable;
+// Новый ключ попал в занятую ячейку — сообщение ушло бы чужому обработчику: подобрать константы keyHash
+static_assert(keyTable.perfect, "WireProtocol message keys collide in keyHash");
+
+inline int skipSpace(const char *s, int i, int len) {
+    while (i < len && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) ++i;
+    return i;
+}
+
+// Конец строки, начинающейся после открывающей кавычки в i: индекс закрывающей кавычки или -1
+int stringEnd(const char *s, int i, int len, bool *escaped) {
+    for (; i < len; ++i) {
+        if (s[i] == '\\') { *escaped = true; ++i; continue; }
+        if (s[i] == '"') return i;
+    }
+    return -1;
+}
+
+// Пропуск значения любого типа, возвращает индекс за ним или -1
+int skipValue(const char *s, int i, int len) {
+    if (i >= len) return -1;
+    if (s[i] == '"') {
+        bool escaped = false;
+        int end = stringEnd(s, i + 1, len, &escaped);
+        return end < 0 ? -1 : end + 1;
+    }
+    if (s[i] == '{' || s[i] == '[') {
+        int depth = 0;
+        for (; i < len; ++i) {
+            if (s[i] == '"') {
+                bool escaped = false;
+                i = stringEnd(s, i + 1, len, &escaped);
+                if (i < 0) return -1;
+            } else if (s[i] == '{' || s[i] == '[') {
+                ++depth;
+            } else if (s[i] == '}' || s[i] == ']') {
+                if (--depth == 0) return i + 1;
+            }
+        }
+        return -1;
+    }
+    // Число или true/false/null
+    while (i < len && s[i] != ',' && s[i] != '}' && s[i] != ' ' && s[i] != '\r' && s[i] != '\n' && s[i] != '\t') ++i;
+    return i;
+}
+
+}
+
+WireProtocol::MessageKey WireProtocol::messageKey(const char *s, int len) {
+    if (len < 2) return KeyUnknown; // Известные ключи не короче трех символов
+    int key = keyTable.slots[keyHash(s, len)];
+    if (key == KeyUnknown) return KeyUnknown;
+    const char *name = KEY_NAMES[key];
+    if (std::strlen(name) != std::size_t(len) || std::memcmp(name, s, len) != 0) return KeyUnknown;
+    return MessageKey(key);
+}
+
+const char *WireProtocol::messageKeyName(MessageKey key) {
+    return key > KeyUnknown && key < KeyCount ? KEY_NAMES[key] : "";
+}
+
+bool WireProtocol::findField(const char *json, int len, const char *key, JsonValue *out) {
+    int keyLen = int(std::strlen(key));
+    int i = skipSpace(json, 0, len);
+    if (i >= len || json[i] != '{') return false;
+    i = skipSpace(json, i + 1, len);
+
+    while (i < len && json[i] == '"') {
+        bool keyEscaped = false;
+        int keyEnd = stringEnd(json, i + 1, len, &keyEscaped);
+        if (keyEnd < 0) return false;
+        bool match = !keyEscaped && keyEnd - i - 1 == keyLen && std::memcmp(json + i + 1, key, keyLen) == 0;
+
+        i = skipSpace(json, keyEnd + 1, len);
+        if (i >= len || json[i] != ':') return false;
+        i = skipSpace(json, i + 1, len);
+
+        int valueEnd = skipValue(json, i, len);
+        if (valueEnd < 0) return false;
+        if (match) {
+            JsonValue value;
+            if (json[i] == '"') {
+                value.isString = true;
+                value.data = json + i + 1;
+                value.size = valueEnd - i - 2;
+                value.escaped = std::memchr(value.data, '\\', value.size) != nullptr;
+            } else {
+                value.data = json + i;
+                value.size = valueEnd - i;
+            }
+            *out = value;
+            return true;
+        }
+
+        i = skipSpace(json, valueEnd, len);
+        if (i < len && json[i] == ',') i = skipSpace(json, i + 1, len);
+        else break;
+    }
+    return false;
+}
+
+int WireProtocol::toInt(const JsonValue &value, int fallback) {
+    int i = 0;
+    bool negative = false;
+    if (i < value.size && value.data[i] == '-') { negative = true; ++i; }
+    if (i >= value.size || value.data[i] < '0' || value.data[i] > '9') return fallback;
+    long long result = 0;
+    for (; i < value.size && value.data[i] >= '0' && value.data[i] <= '9'; ++i) {
+        result = result * 10 + (value.data[i] - '0');
+        if (result > 0x7FFFFFFF) return fallback;
+    }
+    return int(negative ? -result : result);
+}
+
+int WireProtocol::toInts(const JsonValue &value, int *out, int max) {
+    int count = 0;
+    int i = 0;
+    while (i < value.size && count < max) {
+        char ch = value.data[i];
+        bool negative = ch == '-' && i + 1 < value.size && value.data[i + 1] >= '0' && value.data[i + 1] <= '9';
+        if (!negative && (ch < '0' || ch > '9')) {
+            ++i;
+            continue;
+        }
+        int start = negative ? i + 1 : i;
+        int end = start;
+        while (end < value.size && value.data[end] >= '0' && value.data[end] <= '9') ++end;
+        JsonValue digits;
+        digits.data = value.data + start;
+        digits.size = end - start;
+        int n = toInt(digits);
+        out[count++] = negative ? -n : n;
+        i = end;
+    }
+    return count;
+}
+
+int WireProtocol::encodeBatch(int mode, const std::uint8_t *cells, const int *results, int count, std::uint8_t *out) {
+    out[0] = std::uint8_t((mode & ~BatchHasResults) | (results ? BatchHasResults : 0));
+    out[1] = std::uint8_t(count);
+    std::memcpy(out + 2, cells, count);
+    if (!results) return batchPayloadSize(count, false);
+    std::uint8_t *packed = out + 2 + count;
+    std::memset(packed, 0, (count + 3) / 4);
+    for (int i = 0; i < count; ++i) packed[i / 4] |= std::uint8_t((results[i] & 3) << (i % 4 * 2));
+    return batchPayloadSize(count, true);
+}
+
+bool WireProtocol::decodeBatch(const std::uint8_t *payload, int size, Batch *out) {
+    if (size < 2) return false;
+    out->mode = payload[0] & ~BatchHasResults;
+    out->hasResults = payload[0] & BatchHasResults;
+    out->count = payload[1];
+    if (out->mode > BatchFog || out->count > MAX_BATCH) return false;
+    if (size != batchPayloadSize(out->count, out->hasResults)) return false;
+    out->cells = payload + 2;
+    out->results = out->hasResults ? payload + 2 + out->count : nullptr;
+    for (int i = 0; i < out->count; ++i) {
+        if (out->cells[i] >= 100) return false;
+    }
+    return true;
+}
+
+int WireProtocol::batchFromJson(const char *json, int len, std::uint8_t *out) {
+    JsonValue value;
+    int mode = findField(json, len, "mode", &value) ? toInt(value, -1) : BatchFire;
+    if (mode < BatchFire || mode > BatchFog) return -1;
+
+    int cells[MAX_BATCH + 1];
+    int count = findField(json, len, "cells", &value) ? toInts(value, cells, MAX_BATCH + 1) : 0;
+    if (count > MAX_BATCH) return -1;
+    std::uint8_t bytes[MAX_BATCH];
+    for (int i = 0; i < count; ++i) {
+        if (cells[i] < 0 || cells[i] >= 100) return -1;
+        bytes[i] = std::uint8_t(cells[i]);
+    }
+
+    if (!findField(json, len, "results", &value)) return encodeBatch(mode, bytes, nullptr, count, out);
+    int results[MAX_BATCH + 1];
+    if (toInts(value, results, MAX_BATCH + 1) != count) return -1;
+    for (int i = 0; i < count; ++i) {
+        if (results[i] < 0) results[i] = BatchRepeat; // В JSON "уже стреляли" — -1, как у receiveShot
+        if (results[i] > BatchRepeat) return -1;
+    }
+    return encodeBatch(mode, bytes, results, count, out);
+}
@@ -0,0 +1,113 @@
+#ifndef WIREPROTOCOL_H
+#define WIREPROTOCOL_H
+
+#include <cstdint>
+
+// Компактный бинарный протокол (после согласования через JSON "hello"/"hello_ack").
+// Кадр: varint длины (опкод + данные), байт опкода, данные.
+// Частые игровые события идут фиксированными полями, остальное — JSON внутри кадра OpJson.
+// Игровые сообщения нумеруются в каждом направлении с 1 от начала матча (для возобновления после обрыва):
+// в JSON — полем "seq", у кадров номер неявный — по порядку в потоке. Подтверждение — "ack" / OpAck.
+// Без Qt: тот же код использует сервер.
+class WireProtocol
+{
+public:
+    static constexpr int VERSION = 1;
+    static constexpr int MAX_VARINT = 5;
+    static constexpr int MAX_FRAME = 64 * 1024; // Больше — считаем поток испорченным
+    static constexpr int MAX_FLEET = 16;        // Кораблей в расстановке, отправляемой с ready
+    static constexpr int MAX_BATCH = 100;       // Клеток в одном fire_batch (радар перечисляет все непростреленные)
+
+    enum Opcode : std::uint8_t {
+        OpReady      = 0x01, // — или расстановка: по кораблю u8 клетка носа, u8 размер | 0x80 если вертикальный
+        OpRps        = 0x02, // u8 фигура (1..3)
+        OpFire       = 0x03, // u8 клетка (y * 10 + x) [+ u8 результат, если выстрел уже разрешен сервером]
+        OpFireResult = 0x04, // u8 клетка, u8 результат (0 мимо, 1 попал, 2 убил)
+        OpTurnChange = 0x05, // u8 чей ход (1 — Player1, 2 — Player2)
+        OpFireBatch  = 0x06, // Залп, см. Batch [+ результаты, если уже разрешен сервером]
+        OpBatchResult = 0x07, // Ответ на залп, см. Batch (результаты всегда есть)
+        OpAck        = 0x08, // varint номер последнего полученного игрового сообщения
+        OpPing       = 0x09, // varint номер пинга
+        OpPong       = 0x0A, // varint номер пинга, на который ответ
+        OpJson       = 0x7F  // JSON-объект одной строкой (лобби, чат и все остальное)
+    };
+
+    // Запись varint (7 бит на байт, младшие первыми), возвращает число байт
+    static int putVarint(std::uint32_t value, std::uint8_t *out);
+    // Чтение varint: число байт, 0 — данных пока не хватает, -1 — испорчен
+    static int getVarint(const std::uint8_t *data, int avail, std::uint32_t *value);
+
+    // Кадр целиком в out (нужно не больше MAX_VARINT + 1 + size байт), возвращает длину
+    static int encodeFrame(Opcode op, const std::uint8_t *payload, int size, std::uint8_t *out);
+    // Первый кадр в буфере: длина кадра целиком, 0 — кадр еще не пришел полностью, -1 — поток испорчен.
+    // payload указывает внутрь data (без копирования).
+    static int parseFrame(const std::uint8_t *data, int avail, std::uint8_t *op,
+                          const std::uint8_t **payload, int *size);
+
+    // Допустим ли такой размер данных для опкода (незнакомые опкоды — любой)
+    static bool payloadSizeValid(std::uint8_t op, int size);
+
+    // Залп (fire_batch): способность за один обмен сообщениями вместо выстрела на клетку.
+    // Данные: u8 режим (| BatchHasResults), u8 число клеток N, N клеток (y * 10 + x),
+    // при BatchHasResults — результаты по 2 бита, 4 на байт, младшие первыми.
+    enum BatchMode : std::uint8_t {
+        BatchFire = 0,  // Кластерный удар: выстрел по каждой клетке
+        BatchScan = 1,  // Радар: 1 у одной клетки с целым кораблем, остальные 0, без выстрелов
+        BatchFog  = 2,  // Туман: без клеток и ответа, соперник стреляет вслепую до промаха
+        BatchHasResults = 0x80
+    };
+    enum BatchStatus { BatchMiss = 0, BatchHit = 1, BatchKill = 2, BatchRepeat = 3 }; // Repeat — уже стреляли
+
+    struct Batch {
+        int mode = BatchFire;
+        bool hasResults = false;
+        int count = 0;
+        const std::uint8_t *cells = nullptr;
+        const std::uint8_t *results = nullptr; // Упакованные, см. batchResult
+    };
+
+    static constexpr int batchPayloadSize(int count, bool withResults) { return 2 + count + (withResults ? (count + 3) / 4 : 0); }
+    // results — BatchStatus по клетке или nullptr; out — не меньше batchPayloadSize байт. Возвращает размер.
+    static int encodeBatch(int mode, const std::uint8_t *cells, const int *results, int count, std::uint8_t *out);
+    // Разбор с проверкой размера и клеток; указатели в Batch смотрят внутрь payload
+    static bool decodeBatch(const std::uint8_t *payload, int size, Batch *out);
+    static int batchResult(const Batch &batch, int i) { return (batch.results[i / 4] >> (i % 4 * 2)) & 3; }
+    // fire_batch / fire_batch_result в JSON ({"mode":0,"cells":[...],"results":[...]}) — в данные кадра.
+    // out — не меньше batchPayloadSize(MAX_BATCH, true) байт. Возвращает размер, -1 — некорректно.
+    static int batchFromJson(const char *json, int len, std::uint8_t *out);
+
+    // Известные значения полей "action" и "type". Игровые типы (type в game_event) — последними.
+    enum MessageKey {
+        KeyUnknown,
+        // От сервера
+        KeyGameCreated, KeyGameJoined, KeyPlayerJoined, KeyGamesUpdated, KeyError, KeyGameEvent, KeyHelloAck, KeyPong,
+        KeyLobbySnapshot, KeyLobbyUpdate, KeySpectateBegin, KeySpectateEvent,
+        // От клиента
+        KeyCreateGame, KeyJoinGame, KeyGetGames, KeySetName, KeyPing, KeyHello,
+        KeySubscribeLobby, KeyUnsubscribeLobby, KeySpectateGame, KeyLeaveSpectate,
+        // В обе стороны
+        KeyAck,
+        // Игровые события
+        KeyReady, KeyRps, KeyFire, KeyFireResult, KeyChat, KeyTurnChange, KeyFireBatch, KeyBatchResult,
+        KeyCount
+    };
+    // Идеальный хеш по длине, второму и последнему символу: не больше одного сравнения строк
+    static MessageKey messageKey(const char *s, int len);
+    static const char *messageKeyName(MessageKey key);
+
+    // Сырое значение поля JSON-объекта. Для строк — содержимое без кавычек.
+    struct JsonValue {
+        const char *data = nullptr;
+        int size = 0;
+        bool isString = false;
+        bool escaped = false; // Строка с escape-последовательностями: нужен полный разбор
+    };
+    // Поле верхнего уровня без построения дерева. false — поля нет или JSON испорчен.
+    static bool findField(const char *json, int len, const char *key, JsonValue *out);
+    // Целое из числа или строки с числом ("choice": "2")
+    static int toInt(const JsonValue &value, int fallback = 0);
+    // Все целые подряд из значения (массив, в том числе вложенный), возвращает количество
+    static int toInts(const JsonValue &value, int *out, int max);
+};
+
+#endif // WIREPROTOCOL_H
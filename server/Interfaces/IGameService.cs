@@ -1,3 +1,4 @@
+using System;
 using System.Collections.Generic;
 
 namespace GameServer
@@ -12,5 +13,15 @@ namespace GameServer
 		bool RemoveGame(string gameId);
 		bool IsPlayerInGame(string playerId);
 		GameRoom GetGameByPlayer(string playerId);
+
+		// :   ,      
+		bool AddSpectator(string playerId, string gameId);
+		void RemoveSpectator(string playerId);
+		List<string> GetSpectators(string gameId);
+
+		//   ,   
+		event Action<LobbyUpdate>? LobbyChanged;
+		//  version,     ,  null   
+		List<LobbyUpdate>? GetLobbyUpdatesSince(long version, out List<GameRoom>? snapshot, out long currentVersion);
 	}
 }
\ No newline at end of file
@@ -16,5 +16,8 @@ namespace GameServer
 
         //JSON  
         Task SendJsonToPlayers(System.Collections.Generic.List<string> playerIds, object data);
+
+        //,   
+        Task SendToLobby(string message);
     }
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 using System;
+using System.Collections.Generic;
+using System.Text.Json.Serialization;
 
 namespace GameServer
 {
@@ -25,6 +27,10 @@ namespace GameServer
 
         public string WinnerId { get; set; }
 
+        //:   ,     (   GameService)
+        [JsonIgnore]
+        public List<string> SpectatorIds { get; } = new List<string>();
+
         public bool IsFull
         {
             get
@@ -0,0 +1,21 @@
+﻿using System;
+
+namespace GameServer
+{
+    //изменение списка ожидающих игр (рассылается подписчикам лобби)
+    public class LobbyUpdate
+    {
+        //номер изменения, растет на 1
+        public long Version { get; set; }
+
+        //"added", "removed" или "updated"
+        public string Change { get; set; } = null!;
+
+        public string GameId { get; set; } = null!;
+
+        //данные комнаты на момент изменения (для added/updated)
+        public string? GameName { get; set; }
+
+        public string? Player1Id { get; set; }
+    }
+}
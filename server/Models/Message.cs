@@ -16,5 +16,9 @@ namespace GameServer
         //id 
         [JsonPropertyName("gameId")] 
         public string GameId { get; set; }
+
+        //     (subscribe_lobby)
+        [JsonPropertyName("version")]
+        public long Version { get; set; }
     }
 }
\ No newline at end of file
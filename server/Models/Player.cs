@@ -10,6 +10,9 @@ namespace GameServer
         public TcpClient Client { get; set; }
         public DateTime ConnectedAt { get; private set; }
 
+        //подписан на изменения лобби (subscribe_lobby)
+        public bool LobbySubscribed { get; set; }
+
         public bool IsConnected
         {
             get
@@ -1,5 +1,6 @@
 using System;
 using System.Collections.Generic;
+using System.IO;
 using System.Net;
 using System.Net.Sockets;
 using System.Text;
@@ -20,6 +21,9 @@ namespace GameServer
         private static string serverIp;
         private static int serverPort;
 
+        //  -    ( WireProtocol::MAX_FRAME  )
+        private const int MaxMessageBytes = 64 * 1024;
+
         static async Task Main(string[] args)
         {
             Console.WriteLine("====================================");
@@ -117,6 +121,7 @@ namespace GameServer
                 //     
                 NetworkStream stream = client.GetStream();
                 byte[] buffer = new byte[4096]; //    
+                MemoryStream pending = new MemoryStream(); //  ,  '\n'   
 
                 //    
                 while (client.Connected)
@@ -131,12 +136,39 @@ namespace GameServer
                         break;
                     }
 
-                    //   
-                    string message = Encoding.UTF8.GetString(buffer, 0, bytesRead);
-                    Console.WriteLine($"  {player.Id}: {message}");
+                    //  -  :     
+                    //(  )    
+                    int start = 0;
+                    for (int i = 0; i < bytesRead; i++)
+                    {
+                        if (buffer[i] != (byte)'\n')
+                        {
+                            continue;
+                        }
+
+                        pending.Write(buffer, start, i - start);
+                        start = i + 1;
+
+                        //   
+                        string message = Encoding.UTF8.GetString(pending.GetBuffer(), 0, (int)pending.Length).TrimEnd('\r');
+                        pending.SetLength(0);
+                        if (message.Length == 0)
+                        {
+                            continue;
+                        }
+
+                        Console.WriteLine($"  {player.Id}: {message}");
+
+                        //   
+                        await messageHandler.HandleMessage(player.Id, message);
+                    }
 
-                    //   
-                    await messageHandler.HandleMessage(player.Id, message);
+                    pending.Write(buffer, start, bytesRead - start);
+                    if (pending.Length > MaxMessageBytes)
+                    {
+                        Console.WriteLine($" {player.Id} :      {MaxMessageBytes} ");
+                        break;
+                    }
                 }
             }
             catch (Exception ex)
@@ -148,6 +180,7 @@ namespace GameServer
                 //   
                 if (player != null)
                 {
+                    gameService.RemoveSpectator(player.Id);
                     playerService.RemovePlayer(player.Id);
                     Console.WriteLine($"   : {player.Id}");
                 }
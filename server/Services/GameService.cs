@@ -11,6 +11,19 @@ namespace GameServer
 
         private readonly object _lock = new object();
 
+        //    ,     
+        private const int LobbyHistorySize = 256;
+
+        private long _lobbyVersion = 0;
+
+        private readonly Queue<LobbyUpdate> _lobbyHistory = new Queue<LobbyUpdate>();
+
+        //   
+        private const int MaxSpectators = 1000;
+
+        //  _lock,     ;     
+        public event Action<LobbyUpdate>? LobbyChanged;
+
         public GameRoom CreateGame(string playerId, string gameName)
         {
             lock (_lock)
@@ -29,6 +42,7 @@ namespace GameServer
                 };
 
                 _gameRooms[room.Id] = room;
+                RecordLobbyChange("added", room);
 
                 Console.WriteLine($"[GameService]   : '{gameName}' (ID: {room.Id})");
                 return room;
@@ -47,11 +61,12 @@ namespace GameServer
 
                 if (_gameRooms.TryGetValue(gameId, out GameRoom room))
                 {
-                    if (room.Status == GameStatus.Waiting && !room.IsFull)
+                    if (IsListed(room))
                     {
                         room.Player2Id = playerId;
                         room.Status = GameStatus.PlacingShips;
                         room.StartedAt = DateTime.UtcNow;
+                        RecordLobbyChange("removed", room);
 
                         Console.WriteLine($"[GameService]  {playerId}    '{room.Name}'");
                         return true;
@@ -76,7 +91,7 @@ namespace GameServer
 
                 foreach (GameRoom room in _gameRooms.Values)
                 {
-                    if (room.Status == GameStatus.Waiting && !room.IsFull)
+                    if (IsListed(room))
                     {
                         availableGames.Add(room);
                     }
@@ -86,6 +101,60 @@ namespace GameServer
             }
         }
 
+        public List<LobbyUpdate>? GetLobbyUpdatesSince(long version, out List<GameRoom>? snapshot, out long currentVersion)
+        {
+            lock (_lock)
+            {
+                currentVersion = _lobbyVersion;
+
+                //     -   
+                if (version > 0 && version <= _lobbyVersion && _lobbyVersion - version <= _lobbyHistory.Count)
+                {
+                    snapshot = null;
+                    List<LobbyUpdate> updates = new List<LobbyUpdate>();
+                    foreach (LobbyUpdate update in _lobbyHistory)
+                    {
+                        if (update.Version > version)
+                        {
+                            updates.Add(update);
+                        }
+                    }
+
+                    return updates;
+                }
+
+                snapshot = GetAvailableGames();
+                return null;
+            }
+        }
+
+        //   
+        private static bool IsListed(GameRoom room)
+        {
+            return room.Status == GameStatus.Waiting && !room.IsFull;
+        }
+
+        //  ,   _lock
+        private void RecordLobbyChange(string change, GameRoom room)
+        {
+            LobbyUpdate update = new LobbyUpdate
+            {
+                Version = ++_lobbyVersion,
+                Change = change,
+                GameId = room.Id,
+                GameName = room.Name,
+                Player1Id = room.Player1Id
+            };
+
+            _lobbyHistory.Enqueue(update);
+            if (_lobbyHistory.Count > LobbyHistorySize)
+            {
+                _lobbyHistory.Dequeue();
+            }
+
+            LobbyChanged?.Invoke(update);
+        }
+
         public GameRoom GetGame(string gameId)
         {
             lock (_lock)
@@ -103,6 +172,11 @@ namespace GameServer
         {
             lock (_lock)
             {
+                if (_gameRooms.TryGetValue(gameId, out GameRoom? listed) && IsListed(listed))
+                {
+                    RecordLobbyChange("removed", listed);
+                }
+
                 bool removed = _gameRooms.Remove(gameId);
 
                 if (removed)
@@ -152,6 +226,55 @@ namespace GameServer
             }
         }
 
+        // :      ,   
+        public bool AddSpectator(string playerId, string gameId)
+        {
+            lock (_lock)
+            {
+                if (!_gameRooms.TryGetValue(gameId, out GameRoom? room) || room.HasPlayer(playerId) ||
+                    room.Status == GameStatus.Finished || room.SpectatorIds.Count >= MaxSpectators)
+                {
+                    Console.WriteLine($"[GameService]  {playerId}      {gameId}");
+                    return false;
+                }
+
+                //    
+                foreach (GameRoom other in _gameRooms.Values)
+                {
+                    other.SpectatorIds.Remove(playerId);
+                }
+
+                room.SpectatorIds.Add(playerId);
+                Console.WriteLine($"[GameService]  {playerId}    '{room.Name}' (: {room.SpectatorIds.Count})");
+                return true;
+            }
+        }
+
+        public void RemoveSpectator(string playerId)
+        {
+            lock (_lock)
+            {
+                foreach (GameRoom room in _gameRooms.Values)
+                {
+                    room.SpectatorIds.Remove(playerId);
+                }
+            }
+        }
+
+        //  :    
+        public List<string> GetSpectators(string gameId)
+        {
+            lock (_lock)
+            {
+                if (_gameRooms.TryGetValue(gameId, out GameRoom? room))
+                {
+                    return new List<string>(room.SpectatorIds);
+                }
+
+                return new List<string>();
+            }
+        }
+
         public List<GameRoom> GetAllGames()
         {
             lock (_lock)
@@ -173,8 +296,14 @@ namespace GameServer
             {
                 if (_gameRooms.TryGetValue(gameId, out GameRoom room))
                 {
+                    bool wasListed = IsListed(room);
                     room.Status = newStatus;
 
+                    if (wasListed && !IsListed(room))
+                    {
+                        RecordLobbyChange("removed", room);
+                    }
+
                     //  
                     if (newStatus == GameStatus.Finished)
                     {
@@ -212,6 +341,11 @@ namespace GameServer
             {
                 if (_gameRooms.TryGetValue(gameId, out GameRoom room))
                 {
+                    if (IsListed(room))
+                    {
+                        RecordLobbyChange("removed", room);
+                    }
+
                     room.WinnerId = winnerId;
                     room.Status = GameStatus.Finished;
                     room.FinishedAt = DateTime.UtcNow;
@@ -1,5 +1,7 @@
 using System;
+using System.Collections.Generic;
 using System.Text.Json;
+using System.Threading.Channels;
 using System.Threading.Tasks;
 
 namespace GameServer
@@ -11,11 +13,17 @@ namespace GameServer
 		private readonly IGameService _gameService;
 		private readonly INetworkService _networkService;
 
+		//    ;  ,     
+		private readonly Channel<string> _lobbyUpdates = Channel.CreateUnbounded<string>(new UnboundedChannelOptions { SingleReader = true });
+
 		public MessageHandler(IPlayerService playerService, IGameService gameService, INetworkService networkService)
 		{
 			_playerService = playerService;
 			_gameService = gameService;
 			_networkService = networkService;
+
+			_gameService.LobbyChanged += OnLobbyChanged;
+			_ = Task.Run(SendLobbyUpdates);
 		}
 
 		//   
@@ -47,6 +55,22 @@ namespace GameServer
 						await HandleJoinGame(playerId, message.GameId);
 						break;
 
+					case "subscribe_lobby":
+						await HandleSubscribeLobby(playerId, message.Version);
+						break;
+
+					case "unsubscribe_lobby":
+						SetLobbySubscribed(playerId, false);
+						break;
+
+					case "spectate_game":
+						await HandleSpectateGame(playerId, message.GameId);
+						break;
+
+					case "leave_spectate":
+						_gameService.RemoveSpectator(playerId);
+						break;
+
 					case "set_name":
 						await HandleSetName(playerId, message.Data);
 						break;
@@ -81,6 +105,9 @@ namespace GameServer
 				return;
 			}
 
+			//    ,        
+			SetLobbySubscribed(playerId, false);
+
 			await _networkService.SendJson(playerId, new
 			{
 				action = "game_created",
@@ -88,9 +115,6 @@ namespace GameServer
 				gameName = game.Name
 			});
 
-			//     
-			await _networkService.Broadcast("games_updated");
-
 			Console.WriteLine($"[MessageHandler]  : {game.Name} (ID: {game.Id})");
 		}
 
@@ -142,11 +166,144 @@ namespace GameServer
 				yourTurn = false
 			});
 
-			await _networkService.Broadcast("games_updated");
+			SetLobbySubscribed(playerId, false);
+
+			//,    ,    
+			List<string> spectators = _gameService.GetSpectators(gameId);
+			if (spectators.Count > 0)
+			{
+				await _networkService.SendJsonToPlayers(spectators, new
+				{
+					action = "spectate_event",
+					type = "player_joined",
+					opponentId = playerId
+				});
+			}
 
 			Console.WriteLine($"[MessageHandler]  {playerId}    {gameId}");
 		}
 
+		//:    ,      
+		private async Task HandleSpectateGame(string playerId, string gameId)
+		{
+			Console.WriteLine($"[MessageHandler]  {playerId}     {gameId}");
+
+			GameRoom? game = gameId != null ? _gameService.GetGame(gameId) : null;
+
+			if (game == null || !_gameService.AddSpectator(playerId, game.Id))
+			{
+				await SendError(playerId, "    ");
+				return;
+			}
+
+			SetLobbySubscribed(playerId, false);
+
+			//    -      
+			await _networkService.SendJson(playerId, new
+			{
+				action = "spectate_begin",
+				gameId = game.Id,
+				gameName = game.Name,
+				player1Id = game.Player1Id,
+				player2Id = game.Player2Id,
+				turn = game.Status == GameStatus.InProgress ? (int)game.CurrentTurn + 1 : 0,
+				shots = new int[0]
+			});
+		}
+
+		//  :   version    
+		private async Task HandleSubscribeLobby(string playerId, long version)
+		{
+			//    ,     
+			SetLobbySubscribed(playerId, true);
+
+			List<LobbyUpdate>? updates = _gameService.GetLobbyUpdatesSince(version, out List<GameRoom>? snapshot, out long currentVersion);
+
+			if (updates == null)
+			{
+				await _networkService.SendJson(playerId, new
+				{
+					action = "lobby_snapshot",
+					version = currentVersion,
+					games = snapshot
+				});
+
+				Console.WriteLine($"[MessageHandler]  {playerId}   ,   {currentVersion}");
+				return;
+			}
+
+			foreach (LobbyUpdate update in updates)
+			{
+				await _networkService.SendToClient(playerId, LobbyUpdateJson(update));
+			}
+
+			Console.WriteLine($"[MessageHandler]  {playerId}   ,    {version}: {updates.Count}");
+		}
+
+		//        
+		private void OnLobbyChanged(LobbyUpdate update)
+		{
+			string json = LobbyUpdateJson(update);
+
+			//   GameService,       
+			_lobbyUpdates.Writer.TryWrite(json);
+		}
+
+		//  :     
+		private async Task SendLobbyUpdates()
+		{
+			await foreach (string json in _lobbyUpdates.Reader.ReadAllAsync())
+			{
+				try
+				{
+					await _networkService.SendToLobby(json);
+				}
+				catch (Exception ex)
+				{
+					Console.WriteLine($"[MessageHandler]    : {ex.Message}");
+				}
+			}
+		}
+
+		private static string LobbyUpdateJson(LobbyUpdate update)
+		{
+			if (update.Change == "removed")
+			{
+				return JsonSerializer.Serialize(new
+				{
+					action = "lobby_update",
+					version = update.Version,
+					change = update.Change,
+					gameId = update.GameId
+				});
+			}
+
+			//     (GameRoom  JsonSerializer)
+			return JsonSerializer.Serialize(new
+			{
+				action = "lobby_update",
+				version = update.Version,
+				change = update.Change,
+				game = new
+				{
+					Id = update.GameId,
+					Name = update.GameName,
+					Player1Id = update.Player1Id,
+					Status = GameStatus.Waiting
+				}
+			});
+		}
+
+		private void SetLobbySubscribed(string playerId, bool subscribed)
+		{
+			Player player = _playerService.GetPlayer(playerId);
+
+			if (player != null)
+			{
+				player.LobbySubscribed = subscribed;
+			}
+		}
+
 		//   
 		private async Task HandleSetName(string playerId, string name)
 		{
@@ -18,6 +18,19 @@ namespace GameServer
 		}
 
 		public async Task SendToClient(string playerId, string message)
+		{
+			await SendBytes(playerId, Encode(message), message);
+		}
+
+		//  -  :   JSON  '\n',      
+		private static byte[] Encode(string message)
+		{
+			return Encoding.UTF8.GetBytes(message + "\n");
+		}
+
+		//   :          ,
+		//      
+		private async Task SendBytes(string playerId, byte[] data, string message)
 		{
 			Player player = _playerService.GetPlayer(playerId);
 
@@ -38,9 +51,6 @@ namespace GameServer
 				//  
 				NetworkStream stream = player.Client.GetStream();
 
-				//   
-				byte[] data = Encoding.UTF8.GetBytes(message);
-
 				// 
 				await stream.WriteAsync(data, 0, data.Length);
 
@@ -61,6 +71,8 @@ namespace GameServer
 			List<Player> players = _playerService.GetConnectedPlayers();
 			List<Task> sendTasks = new List<Task>();
 
+			byte[] data = Encode(message);
+
 			HashSet<string> excludeSet = new HashSet<string>();
 			foreach (string excludedId in excludePlayerIds)
 			{
@@ -77,7 +89,7 @@ namespace GameServer
 				}
 
 				//  
-				sendTasks.Add(SendToClient(player.Id, message));
+				sendTasks.Add(SendBytes(player.Id, data, message));
 			}
 
 			if (sendTasks.Count > 0)
@@ -87,6 +99,27 @@ namespace GameServer
 			}
 		}
 
+		//    ,     
+		public async Task SendToLobby(string message)
+		{
+			List<Player> players = _playerService.GetConnectedPlayers();
+			List<Task> sendTasks = new List<Task>();
+			byte[] data = Encode(message);
+
+			foreach (Player player in players)
+			{
+				if (player.LobbySubscribed)
+				{
+					sendTasks.Add(SendBytes(player.Id, data, message));
+				}
+			}
+
+			if (sendTasks.Count > 0)
+			{
+				await Task.WhenAll(sendTasks);
+			}
+		}
+
 		// JSON 
 		public async Task SendJson(string playerId, object data)
 		{
@@ -95,16 +128,17 @@ namespace GameServer
 			await SendToClient(playerId, json);
 		}
 
-		// JSON  
+		// JSON  :       
 		public async Task SendJsonToPlayers(List<string> playerIds, object data)
 		{
 			string json = JsonSerializer.Serialize(data);
+			byte[] bytes = Encode(json);
 			List<Task> sendTasks = new List<Task>();
 
 			//     
 			foreach (string playerId in playerIds)
 			{
-				sendTasks.Add(SendToClient(playerId, json));
+				sendTasks.Add(SendBytes(playerId, bytes, json));
 			}
 
 			//   
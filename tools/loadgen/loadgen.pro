@@ -0,0 +1,38 @@
+QT       = core network
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = morskoy_loadgen
+
+# Сеть, протокол, ядро игры и боты берутся из клиента без виджетов
+CLIENT_DIR = ../../client
+INCLUDEPATH += $$CLIENT_DIR
+
+SOURCES += \
+    main.cpp \
+    $$CLIENT_DIR/boardmodel.cpp \
+    $$CLIENT_DIR/densitybot.cpp \
+    $$CLIENT_DIR/fleetplacer.cpp \
+    $$CLIENT_DIR/framereader.cpp \
+    $$CLIENT_DIR/headlessplayer.cpp \
+    $$CLIENT_DIR/latencystats.cpp \
+    $$CLIENT_DIR/networkclient.cpp \
+    $$CLIENT_DIR/queuebot.cpp \
+    $$CLIENT_DIR/transport.cpp \
+    $$CLIENT_DIR/wireprotocol.cpp
+
+HEADERS += \
+    $$CLIENT_DIR/Ship.h \
+    $$CLIENT_DIR/boardmodel.h \
+    $$CLIENT_DIR/densitybot.h \
+    $$CLIENT_DIR/fleetplacer.h \
+    $$CLIENT_DIR/framereader.h \
+    $$CLIENT_DIR/headlessplayer.h \
+    $$CLIENT_DIR/latencystats.h \
+    $$CLIENT_DIR/networkclient.h \
+    $$CLIENT_DIR/queuebot.h \
+    $$CLIENT_DIR/shooter.h \
+    $$CLIENT_DIR/spscqueue.h \
+    $$CLIENT_DIR/transport.h \
+    $$CLIENT_DIR/wireprotocol.h
@@ -0,0 +1,336 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QTextStream>
+#include <QTimer>
+#include <memory>
+#include "densitybot.h"
+#include "headlessplayer.h"
+#include "latencystats.h"
+#include "networkclient.h"
+#include "queuebot.h"
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+// Нагрузка на сервер лобби и партий: morskoy_loadgen -H 127.0.0.1 -P 8888 -c 4000 -d 300
+// Тысячи настоящих NetworkClient по TCP в одном цикле событий, каждая пара играет партию за партией
+// по протоколу окна: create/join, ready, К-Н-Б, fire/fire_result, чат, пинги. Ходы делает бот с паузой.
+// Раз в интервал — скорость сообщений, в конце — перцентили задержек и ошибки по причинам.
+
+namespace {
+
+struct Settings {
+    QString host = "127.0.0.1";
+    int port = 8888;
+    int connections = 1000;
+    int ramp = 200;          // Новых подключений в секунду
+    int duration = 60;       // Секунд новых партий, затем доигрываются начатые
+    int thinkMin = 200;
+    int thinkMax = 800;
+    int chatInterval = 5;
+    int matchTimeout = 300;
+    int reportInterval = 5;
+    NetworkClient::Protocol protocol = NetworkClient::ProtocolBinary;
+    bool resolve = true;
+    QString bot = "queue";
+    quint64 seed = 1;
+};
+
+std::unique_ptr<Shooter> createShooter(const QString &name) {
+    if (name == "queue") return std::unique_ptr<Shooter>(new QueueBot());
+    if (name == "density") return std::unique_ptr<Shooter>(new DensityBot());
+    return nullptr;
+}
+
+// Тысячи сокетов упираются в лимит дескрипторов: поднимаем мягкий до жесткого
+void raiseFileLimit() {
+#ifdef Q_OS_UNIX
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#endif
+}
+
+QString formatUs(std::uint32_t us) {
+    return QString::number(us / 1000.0, 'f', 2);
+}
+
+// Держит connections / 2 пар: ramp подключений в секунду, закончившаяся пара начинает новую партию
+class Runner : public QObject
+{
+public:
+    Runner(const Settings &settings) : settings(settings) {}
+
+    void start() {
+        clock.start();
+        connect(&rampTimer, &QTimer::timeout, this, [this]() { onRamp(); });
+        connect(&watchdogTimer, &QTimer::timeout, this, [this]() { onWatchdog(); });
+        connect(&reportTimer, &QTimer::timeout, this, [this]() { report(); });
+        rampTimer.start(20);
+        watchdogTimer.start(1000);
+        if (settings.reportInterval > 0) reportTimer.start(settings.reportInterval * 1000);
+    }
+
+    void printSummary() {
+        double seconds = clock.nsecsElapsed() / 1e9;
+        qint64 sent = 0;
+        qint64 received = 0;
+        countMessages(&sent, &received);
+        int ended = finished + failed;
+
+        QTextStream out(stdout);
+        out << "\n" << settings.connections << " connections to " << settings.host << ":" << settings.port
+            << ", protocol " << (settings.protocol == NetworkClient::ProtocolJson ? "json" : "binary")
+            << ", think " << settings.thinkMin << "-" << settings.thinkMax << " ms, bot " << settings.bot << "\n";
+        out << "time " << QString::number(seconds, 'f', 1) << " s, matches finished " << finished << ", failed " << failed
+            << " (" << QString::number(ended ? failed * 100.0 / ended : 0.0, 'f', 2) << "%)\n";
+        out << "connects " << connectAttempts << ", failed " << connectErrors
+            << " (" << QString::number(connectAttempts ? connectErrors * 100.0 / connectAttempts : 0.0, 'f', 2) << "%)\n";
+        out << "messages sent " << sent << ", received " << received << ", "
+            << QString::number((sent + received) / seconds, 'f', 0) << " messages/s, shots " << shots
+            << ", chat " << chats << "\n";
+        out << "latency, ms          count      p50      p95      p99      max\n";
+        printLatency(out, "connect (hello_ack)", connectLatency);
+        printLatency(out, "lobby (create/join)", lobbyLatency);
+        printLatency(out, "fire -> fire_result", fireLatency);
+        printLatency(out, "ping -> pong", pingLatency);
+        if (!errors.isEmpty()) {
+            out << "errors:\n";
+            for (auto it = errors.constBegin(); it != errors.constEnd(); ++it)
+                out << "  " << it.value() << "  " << it.key() << "\n";
+        }
+    }
+
+    int failed = 0;
+
+private:
+    struct Match {
+        NetworkClient *clients[2];
+        HeadlessPlayer *players[2];
+        qint64 connectStartNs = 0;
+        qint64 startMs = 0;
+        bool connected[2] = {false, false};
+        int done = 0;
+        bool failed = false;
+    };
+
+    Settings settings;
+    QElapsedTimer clock;
+    QTimer rampTimer;
+    QTimer watchdogTimer;
+    QTimer reportTimer;
+    QList<Match *> matches;
+    int pairsStarted = 0;
+    int started = 0;
+    bool stopping = false;
+
+    int finished = 0;
+    qint64 connectAttempts = 0;
+    qint64 connectErrors = 0;
+    qint64 shots = 0;
+    qint64 chats = 0;
+    qint64 closedSent = 0;     // Сообщения уже удаленных клиентов
+    qint64 closedReceived = 0;
+    qint64 lastReportMessages = 0;
+    qint64 lastReportNs = 0;
+    QMap<QString, int> errors;
+    LatencyStats connectLatency;
+    LatencyStats lobbyLatency;
+    LatencyStats fireLatency;
+    LatencyStats pingLatency;
+
+    void onRamp() {
+        if (!stopping && clock.elapsed() >= qint64(settings.duration) * 1000) {
+            stopping = true;
+            rampTimer.stop();
+            if (matches.isEmpty()) QCoreApplication::quit();
+            return;
+        }
+        int pairs = settings.connections / 2;
+        int target = int(qMin<qint64>(pairs, clock.elapsed() * settings.ramp / 2000 + 1));
+        while (pairsStarted < target) {
+            pairsStarted++;
+            startMatch();
+        }
+    }
+
+    void startMatch() {
+        int index = started++;
+        Match *match = new Match;
+        match->startMs = clock.elapsed();
+        match->connectStartNs = clock.nsecsElapsed();
+        for (int side = 0; side < 2; ++side) {
+            NetworkClient *client = new NetworkClient();
+            client->setPreferredProtocol(settings.protocol);
+            client->setServerResolvedShots(settings.resolve);
+            client->setReconnectEnabled(false);
+            HeadlessPlayer *player = new HeadlessPlayer(client, createShooter(settings.bot),
+                                                        settings.seed * 1000003 + quint64(index) * 2 + side);
+            player->setThinkTime(settings.thinkMin, settings.thinkMax);
+            player->setChatInterval(settings.chatInterval);
+            match->clients[side] = client;
+            match->players[side] = player;
+
+            connect(client, &NetworkClient::connected, this, [this, match, side]() {
+                match->connected[side] = true;
+                connectLatency.addSample(std::uint32_t((clock.nsecsElapsed() - match->connectStartNs) / 1000));
+            });
+            connect(player, &HeadlessPlayer::actionTimed, this, [this](HeadlessPlayer::Action action, qint64 us) {
+                (action == HeadlessPlayer::ActionLobby ? lobbyLatency : fireLatency).addSample(std::uint32_t(us));
+            });
+            connect(player, &HeadlessPlayer::matchFinished, this, [this, match]() { onPlayerDone(match, QString()); });
+            connect(player, &HeadlessPlayer::matchFailed, this, [this, match, side](const QString &reason) {
+                onPlayerDone(match, match->connected[side] ? reason : "Подключение: " + reason);
+            });
+        }
+        connect(match->players[0], &HeadlessPlayer::gameCreated, match->players[1],
+                [match](const QString &gameId) { match->players[1]->join(gameId); });
+        match->players[0]->host(QString("load-%1").arg(index));
+        for (NetworkClient *client : match->clients) client->connectToServer(settings.host, settings.port);
+        connectAttempts += 2;
+        matches.append(match);
+    }
+
+    void onPlayerDone(Match *match, const QString &error) {
+        // Партия сыграна, когда конец увидели оба; ошибка любой стороны завершает ее сразу
+        if (!error.isEmpty()) {
+            match->failed = true;
+            errors[error]++;
+        }
+        if (++match->done < 2 && error.isEmpty()) return;
+        closeMatch(match);
+    }
+
+    void closeMatch(Match *match) {
+        if (match->failed) failed++;
+        else finished++;
+        for (int side = 0; side < 2; ++side) {
+            if (!match->connected[side]) connectErrors++;
+            NetworkClient *client = match->clients[side];
+            HeadlessPlayer *player = match->players[side];
+            shots += player->getShots();
+            chats += player->getChats();
+            closedSent += client->getWriteStats().messages;
+            closedReceived += client->getReceivedMessages();
+            pingLatency.merge(client->getLatencyStats());
+            player->disconnect(this); // Дальнейшие сигналы этой партии не считаются
+            client->disconnect(this);
+            player->deleteLater();
+            client->deleteLater();
+        }
+        matches.removeOne(match);
+        delete match;
+
+        if (!stopping) startMatch();
+        else if (matches.isEmpty()) QCoreApplication::quit();
+    }
+
+    // Зависшая партия (соперник пропал, сервер не ответил) считается ошибкой, пара начинает новую
+    void onWatchdog() {
+        qint64 now = clock.elapsed();
+        const QList<Match *> snapshot = matches;
+        for (Match *match : snapshot) {
+            if (now - match->startMs < qint64(settings.matchTimeout) * 1000) continue;
+            match->failed = true;
+            errors["Партия не закончилась за отведенное время"]++;
+            closeMatch(match);
+        }
+    }
+
+    void countMessages(qint64 *sent, qint64 *received) const {
+        *sent = closedSent;
+        *received = closedReceived;
+        for (const Match *match : matches) {
+            for (const NetworkClient *client : match->clients) {
+                *sent += client->getWriteStats().messages;
+                *received += client->getReceivedMessages();
+            }
+        }
+    }
+
+    void report() {
+        qint64 sent = 0;
+        qint64 received = 0;
+        countMessages(&sent, &received);
+        qint64 now = clock.nsecsElapsed();
+        double seconds = (now - lastReportNs) / 1e9;
+        double rate = seconds > 0 ? (sent + received - lastReportMessages) / seconds : 0.0;
+        lastReportMessages = sent + received;
+        lastReportNs = now;
+
+        int connected = 0;
+        for (const Match *match : matches) connected += match->connected[0] + match->connected[1];
+        QTextStream(stdout) << "[" << QString::number(now / 1e9, 'f', 0).rightJustified(5) << " s] connected "
+                            << connected << ", matches " << finished << " ok / " << failed << " failed, "
+                            << QString::number(rate, 'f', 0) << " messages/s, fire p95 "
+                            << formatUs(fireLatency.total().p95Us) << " ms\n";
+    }
+
+    static void printLatency(QTextStream &out, const char *name, const LatencyStats &stats) {
+        LatencyStats::Summary summary = stats.total();
+        out << QString(name).leftJustified(20) << QString::number(summary.samples).rightJustified(6)
+            << formatUs(summary.p50Us).rightJustified(9) << formatUs(summary.p95Us).rightJustified(9)
+            << formatUs(summary.p99Us).rightJustified(9) << formatUs(summary.maxUs).rightJustified(9) << "\n";
+    }
+};
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("morskoy_loadgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Нагрузка на сервер: тысячи клиентов-ботов играют партии по сети.");
+    parser.addHelpOption();
+    QCommandLineOption hostOpt({"H", "host"}, "Адрес сервера.", "host", "127.0.0.1");
+    QCommandLineOption portOpt({"P", "port"}, "Порт сервера.", "port", "8888");
+    QCommandLineOption connectionsOpt({"c", "connections"}, "Одновременных подключений (четное).", "count", "1000");
+    QCommandLineOption rampOpt("ramp", "Новых подключений в секунду на старте.", "count", "200");
+    QCommandLineOption durationOpt({"d", "duration"}, "Секунд начинать новые партии.", "seconds", "60");
+    QCommandLineOption thinkOpt("think", "Пауза перед ходом, мс: min-max.", "range", "200-800");
+    QCommandLineOption chatOpt("chat", "Сообщение в чат на каждый N-й выстрел, 0 — без чата.", "count", "5");
+    QCommandLineOption timeoutOpt("match-timeout", "Секунд на партию, дольше — ошибка.", "seconds", "300");
+    QCommandLineOption intervalOpt({"i", "interval"}, "Печатать скорость раз в N секунд, 0 — не печатать.", "seconds", "5");
+    QCommandLineOption protocolOpt("protocol", "Формат обмена: json или binary.", "name", "binary");
+    QCommandLineOption clientShotsOpt("client-shots", "Выстрелы разрешают клиенты, а не сервер.");
+    QCommandLineOption botOpt("bot", "Стратегия игроков: queue, density.", "name", "queue");
+    QCommandLineOption seedOpt("seed", "Начальное значение генератора.", "number", "1");
+    parser.addOptions({hostOpt, portOpt, connectionsOpt, rampOpt, durationOpt, thinkOpt, chatOpt, timeoutOpt,
+                       intervalOpt, protocolOpt, clientShotsOpt, botOpt, seedOpt});
+    parser.process(app);
+
+    Settings settings;
+    settings.host = parser.value(hostOpt);
+    settings.port = parser.value(portOpt).toInt();
+    settings.connections = qMax(2, parser.value(connectionsOpt).toInt() & ~1);
+    settings.ramp = qMax(1, parser.value(rampOpt).toInt());
+    settings.duration = qMax(0, parser.value(durationOpt).toInt());
+    QStringList think = parser.value(thinkOpt).split('-');
+    settings.thinkMin = qMax(0, think.value(0).toInt());
+    settings.thinkMax = qMax(settings.thinkMin, think.value(1, think.value(0)).toInt());
+    settings.chatInterval = qMax(0, parser.value(chatOpt).toInt());
+    settings.matchTimeout = qMax(1, parser.value(timeoutOpt).toInt());
+    settings.reportInterval = qMax(0, parser.value(intervalOpt).toInt());
+    settings.protocol = parser.value(protocolOpt) == "json" ? NetworkClient::ProtocolJson : NetworkClient::ProtocolBinary;
+    settings.resolve = !parser.isSet(clientShotsOpt);
+    settings.bot = parser.value(botOpt);
+    settings.seed = parser.value(seedOpt).toULongLong();
+    if (!createShooter(settings.bot)) {
+        QTextStream(stderr) << "Неизвестная стратегия: " << settings.bot << "\n";
+        return 1;
+    }
+    raiseFileLimit();
+
+    Runner runner(settings);
+    QMetaObject::invokeMethod(&runner, [&runner]() { runner.start(); }, Qt::QueuedConnection);
+    app.exec();
+
+    runner.printSummary();
+    return runner.failed ? 2 : 0;
+}
@@ -0,0 +1,162 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <memory>
+#include "densitybot.h"
+#include "headlessplayer.h"
+#include "loopbackserver.h"
+#include "networkclient.h"
+#include "queuebot.h"
+#include "scriptedshooter.h"
+
+// Партии целиком внутри процесса: morskoy_loopbench -n 10000 -p 64 --protocol binary
+// Два NetworkClient с ботами играют через LoopbackServer по LoopbackTransport — без сокетов и сервера.
+// Меряется весь путь: кодирование и разбор сообщений, таблица обработчиков, ход партии, очередь событий Qt.
+
+namespace {
+
+struct Settings {
+    int matches = 1000;
+    int parallel = 64;
+    NetworkClient::Protocol protocol = NetworkClient::ProtocolBinary;
+    QString bot = "queue";
+    quint64 seed = 1;
+};
+
+std::unique_ptr<Shooter> createShooter(const QString &name) {
+    if (name == "queue") return std::unique_ptr<Shooter>(new QueueBot());
+    if (name == "density") return std::unique_ptr<Shooter>(new DensityBot());
+    if (name == "script") return std::unique_ptr<Shooter>(new ScriptedShooter());
+    return nullptr;
+}
+
+// Ведет партии: держит parallel партий одновременно, пока не сыграно matches
+class Runner : public QObject
+{
+public:
+    Runner(const Settings &settings) : settings(settings) {}
+
+    void start() {
+        timer.start();
+        for (int i = 0; i < settings.parallel && started < settings.matches; ++i) startMatch();
+    }
+
+    LoopbackServer server;
+    int finished = 0;
+    int failed = 0;
+    qint64 shots = 0;
+    qint64 rpsRounds = 0;
+    QElapsedTimer timer;
+    QString lastError;
+
+private:
+    struct Match {
+        NetworkClient *clients[2];
+        HeadlessPlayer *players[2];
+        int done = 0;
+        bool failed = false;
+    };
+
+    Settings settings;
+    int started = 0;
+
+    void startMatch() {
+        int index = started++;
+        Match *match = new Match;
+        for (int side = 0; side < 2; ++side) {
+            NetworkClient *client = new NetworkClient(server.createClientTransport());
+            client->setPreferredProtocol(settings.protocol);
+            client->setReconnectEnabled(false);
+            // Свой seed у каждой партии и стороны: прогон целиком воспроизводим
+            HeadlessPlayer *player = new HeadlessPlayer(client, createShooter(settings.bot),
+                                                        settings.seed * 1000003 + quint64(index) * 2 + side);
+            match->clients[side] = client;
+            match->players[side] = player;
+            connect(player, &HeadlessPlayer::matchFinished, this, [this, match]() { onPlayerDone(match, false); });
+            connect(player, &HeadlessPlayer::matchFailed, this, [this, match](const QString &reason) {
+                lastError = reason;
+                onPlayerDone(match, true);
+            });
+        }
+        connect(match->players[0], &HeadlessPlayer::gameCreated, match->players[1],
+                [match](const QString &gameId) { match->players[1]->join(gameId); });
+        match->players[0]->host(QString("bench-%1").arg(index));
+        for (NetworkClient *client : match->clients) client->connectToServer("loopback", 0);
+    }
+
+    void onPlayerDone(Match *match, bool error) {
+        // Партия сыграна, когда конец увидели оба; ошибка любой стороны завершает ее сразу
+        match->failed |= error;
+        if (++match->done < 2 && !error) return;
+
+        if (match->failed) failed++;
+        else finished++;
+        for (HeadlessPlayer *player : match->players) {
+            shots += player->getShots();
+            rpsRounds += player->getRpsRounds();
+        }
+        for (int side = 0; side < 2; ++side) {
+            match->players[side]->disconnect(this); // Дальнейшие сигналы этой партии не считаются
+            match->players[side]->deleteLater();
+            match->clients[side]->deleteLater();
+        }
+        delete match;
+
+        if (started < settings.matches) startMatch();
+        else if (finished + failed == settings.matches) QCoreApplication::quit();
+    }
+};
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("morskoy_loopbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Партии ботов через NetworkClient внутри процесса: протокол и ход игры без сети.");
+    parser.addHelpOption();
+    QCommandLineOption matchesOpt({"n", "matches"}, "Сколько партий сыграть.", "count", "1000");
+    QCommandLineOption parallelOpt({"p", "parallel"}, "Партий одновременно.", "count", "64");
+    QCommandLineOption protocolOpt("protocol", "Формат обмена: json или binary.", "name", "binary");
+    QCommandLineOption botOpt("bot", "Стратегия обоих игроков: queue, density, script.", "name", "queue");
+    QCommandLineOption seedOpt("seed", "Начальное значение генератора.", "number", "1");
+    parser.addOptions({matchesOpt, parallelOpt, protocolOpt, botOpt, seedOpt});
+    parser.process(app);
+
+    Settings settings;
+    settings.matches = qMax(1, parser.value(matchesOpt).toInt());
+    settings.parallel = qMax(1, parser.value(parallelOpt).toInt());
+    settings.protocol = parser.value(protocolOpt) == "json" ? NetworkClient::ProtocolJson : NetworkClient::ProtocolBinary;
+    settings.bot = parser.value(botOpt);
+    settings.seed = parser.value(seedOpt).toULongLong();
+    if (!createShooter(settings.bot)) {
+        QTextStream(stderr) << "Неизвестная стратегия: " << settings.bot << "\n";
+        return 1;
+    }
+
+    Runner runner(settings);
+    QMetaObject::invokeMethod(&runner, [&runner]() { runner.start(); }, Qt::QueuedConnection);
+    app.exec();
+
+    double seconds = runner.timer.nsecsElapsed() / 1e9;
+    const LoopbackServer::Stats &stats = runner.server.getStats();
+    qint64 messages = stats.messagesIn + stats.messagesOut;
+    int played = qMax(1, runner.finished);
+
+    QTextStream out(stdout);
+    out << settings.matches << " matches, " << settings.parallel << " in parallel, protocol "
+        << (settings.protocol == NetworkClient::ProtocolJson ? "json" : "binary") << ", bot " << settings.bot << "\n";
+    out << "finished " << runner.finished << ", failed " << runner.failed;
+    if (runner.failed) out << " (last: " << runner.lastError << ")";
+    out << "\n";
+    out << "time " << QString::number(seconds, 'f', 3) << " s, " << QString::number(runner.finished / seconds, 'f', 0)
+        << " matches/s, " << QString::number(messages / seconds, 'f', 0) << " messages/s\n";
+    out << "per match: " << QString::number(double(messages) / played, 'f', 1) << " messages, "
+        << QString::number(double(stats.bytesIn + stats.bytesOut) / played, 'f', 0) << " bytes, "
+        << QString::number(double(runner.shots) / played, 'f', 1) << " shots, "
+        << QString::number(double(runner.rpsRounds) / played / 2, 'f', 2) << " RPS rounds\n";
+    return runner.failed ? 2 : 0;
+}
@@ -0,0 +1,279 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include "framereader.h"
+#include "wireprotocol.h"
+
+// Микробенчмарк разбора входящих сообщений NetworkClient: morskoy_netbench -n 100000 -r 5
+// legacy — прежний onReadyRead (readLine + trimmed + QJsonDocument + цепочка сравнений QString),
+// ring — FrameReader + сканер полей + таблица по идеальному хешу, binary — кадры WireProtocol.
+// Сигналы не испускаются: считаем разобранные значения, чтобы работу нельзя было выбросить.
+
+namespace {
+
+struct Counters {
+    qint64 messages = 0;
+    qint64 checksum = 0;
+};
+
+// Смесь как в реальной партии: в основном выстрелы и ответы, иногда чат и смена хода
+QByteArray makeJsonStream(int count) {
+    QByteArray stream;
+    for (int i = 0; i < count; ++i) {
+        QJsonObject json;
+        json["action"] = "game_event";
+        switch (i % 8) {
+        case 0: case 1: case 2:
+            json["type"] = "fire";
+            json["x"] = i % 10;
+            json["y"] = (i / 10) % 10;
+            break;
+        case 3: case 4: case 5:
+            json["type"] = "fire_result";
+            json["x"] = i % 10;
+            json["y"] = (i / 10) % 10;
+            json["value"] = i % 3;
+            break;
+        case 6:
+            json["type"] = "chat";
+            json["data"] = QString("Сообщение номер %1").arg(i);
+            break;
+        default:
+            json["type"] = "turn_change";
+            json["currentTurn"] = (i & 8) ? "Player1" : "Player2";
+            break;
+        }
+        stream += QJsonDocument(json).toJson(QJsonDocument::Compact);
+        stream += '\n';
+    }
+    return stream;
+}
+
+QByteArray makeBinaryStream(const QByteArray &jsonStream) {
+    QByteArray stream;
+    quint8 frame[WireProtocol::MAX_VARINT + 1 + 256];
+    for (const QByteArray &line : jsonStream.split('\n')) {
+        if (line.isEmpty()) continue;
+        QJsonObject obj = QJsonDocument::fromJson(line).object();
+        QString type = obj["type"].toString();
+        int cell = obj["y"].toInt() * 10 + obj["x"].toInt();
+        int n = 0;
+        if (type == "fire") {
+            quint8 payload[1] = { quint8(cell) };
+            n = WireProtocol::encodeFrame(WireProtocol::OpFire, payload, 1, frame);
+        } else if (type == "fire_result") {
+            quint8 payload[2] = { quint8(cell), quint8(obj["value"].toInt()) };
+            n = WireProtocol::encodeFrame(WireProtocol::OpFireResult, payload, 2, frame);
+        } else if (type == "turn_change") {
+            quint8 payload[1] = { quint8(obj["currentTurn"].toString() == "Player1" ? 1 : 2) };
+            n = WireProtocol::encodeFrame(WireProtocol::OpTurnChange, payload, 1, frame);
+        } else {
+            n = WireProtocol::encodeFrame(WireProtocol::OpJson, reinterpret_cast<const quint8 *>(line.constData()),
+                                          line.size(), frame);
+        }
+        stream.append(reinterpret_cast<const char *>(frame), n);
+    }
+    return stream;
+}
+
+// Прежний путь NetworkClient::onReadyRead
+void runLegacy(QIODevice &device, Counters &c) {
+    while (device.canReadLine()) {
+        QByteArray line = device.readLine().trimmed();
+        if (line.isEmpty()) continue;
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) continue;
+
+        QJsonObject obj = doc.object();
+        QString action = obj["action"].toString();
+        QString data = obj["data"].toString();
+        c.messages++;
+        if (action == "game_created" || action == "game_joined") {
+            c.checksum += (obj.contains("gameId") ? obj["gameId"].toString() : data).size();
+        } else if (action == "player_joined") {
+            c.checksum += (obj.contains("opponentId") ? obj["opponentId"].toString() : data).size();
+        } else if (action == "error") {
+            c.checksum += obj["message"].toString().size();
+        } else if (action == "game_event") {
+            QString type = obj["type"].toString();
+            if (type == "ready") {
+                c.checksum += 1;
+            } else if (type == "rps") {
+                c.checksum += obj["value"].toInt();
+            } else if (type == "fire") {
+                c.checksum += obj["x"].toInt() + obj["y"].toInt();
+            } else if (type == "fire_result") {
+                c.checksum += obj["x"].toInt() + obj["y"].toInt() + obj["value"].toInt();
+            } else if (type == "chat") {
+                c.checksum += obj["data"].toString().size();
+            } else if (type == "turn_change") {
+                c.checksum += obj["currentTurn"].toString().size();
+            }
+        }
+    }
+}
+
+int intField(const char *json, int size, const char *key) {
+    WireProtocol::JsonValue value;
+    return WireProtocol::findField(json, size, key, &value) ? WireProtocol::toInt(value) : 0;
+}
+
+QString stringField(const char *json, int size, const char *key) {
+    WireProtocol::JsonValue value;
+    if (!WireProtocol::findField(json, size, key, &value) || !value.isString) return QString();
+    if (!value.escaped) return QString::fromUtf8(value.data, value.size);
+    return QJsonDocument::fromJson(QByteArray::fromRawData(json, size)).object().value(QLatin1String(key)).toString();
+}
+
+// Тот же разбор, что в NetworkClient::handleMessage
+void handleJson(const char *json, int size, Counters &c) {
+    WireProtocol::JsonValue action;
+    if (!WireProtocol::findField(json, size, "action", &action) || !action.isString) return;
+    WireProtocol::MessageKey key = WireProtocol::messageKey(action.data, action.size);
+    if (key == WireProtocol::KeyGameEvent) {
+        WireProtocol::JsonValue type;
+        if (!WireProtocol::findField(json, size, "type", &type) || !type.isString) return;
+        key = WireProtocol::messageKey(type.data, type.size);
+    }
+    c.messages++;
+    switch (key) {
+    case WireProtocol::KeyReady: c.checksum += 1; break;
+    case WireProtocol::KeyRps: c.checksum += intField(json, size, "value"); break;
+    case WireProtocol::KeyFire: c.checksum += intField(json, size, "x") + intField(json, size, "y"); break;
+    case WireProtocol::KeyFireResult:
+        c.checksum += intField(json, size, "x") + intField(json, size, "y") + intField(json, size, "value");
+        break;
+    case WireProtocol::KeyChat: c.checksum += stringField(json, size, "data").size(); break;
+    case WireProtocol::KeyTurnChange: c.checksum += stringField(json, size, "currentTurn").size(); break;
+    case WireProtocol::KeyError: c.checksum += stringField(json, size, "message").size(); break;
+    default: break;
+    }
+}
+
+// Поток подается кусками по chunk байт, как из сокета
+void feed(FrameReader &reader, const QByteArray &stream, int &offset, int chunk) {
+    int left = qMin(chunk, int(stream.size()) - offset);
+    while (left > 0) {
+        int space = 0;
+        char *dst = reader.writeSpace(left, &space);
+        int n = qMin(space, left);
+        memcpy(dst, stream.constData() + offset, n);
+        reader.commit(n);
+        offset += n;
+        left -= n;
+    }
+}
+
+void runRing(const QByteArray &stream, int chunk, Counters &c) {
+    FrameReader reader;
+    int offset = 0;
+    while (offset < stream.size()) {
+        feed(reader, stream, offset, chunk);
+        const char *line = nullptr;
+        int len = 0;
+        while (reader.nextLine(&line, &len)) handleJson(line, len, c);
+    }
+}
+
+void runBinary(const QByteArray &stream, int chunk, Counters &c) {
+    FrameReader reader;
+    int offset = 0;
+    while (offset < stream.size()) {
+        feed(reader, stream, offset, chunk);
+        quint8 op = 0;
+        const quint8 *payload = nullptr;
+        int size = 0;
+        while (reader.nextFrame(&op, &payload, &size) == 1) {
+            switch (op) {
+            case WireProtocol::OpFire:
+                c.messages++;
+                c.checksum += payload[0] % 10 + payload[0] / 10;
+                break;
+            case WireProtocol::OpFireResult:
+                c.messages++;
+                c.checksum += payload[0] % 10 + payload[0] / 10 + payload[1];
+                break;
+            case WireProtocol::OpTurnChange:
+                c.messages++;
+                c.checksum += QString(payload[0] == 1 ? "Player1" : "Player2").size();
+                break;
+            case WireProtocol::OpJson:
+                handleJson(reinterpret_cast<const char *>(payload), size, c);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("morskoy_netbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Скорость разбора входящих сообщений: прежний путь против кольцевого буфера.");
+    parser.addHelpOption();
+    QCommandLineOption countOpt({"n", "messages"}, "Сообщений в потоке.", "count", "100000");
+    QCommandLineOption roundsOpt({"r", "rounds"}, "Повторов (берется лучший).", "count", "5");
+    QCommandLineOption chunkOpt("chunk", "Байт за одно чтение из сокета.", "bytes", "1460");
+    parser.addOptions({countOpt, roundsOpt, chunkOpt});
+    parser.process(app);
+
+    int count = qMax(1, parser.value(countOpt).toInt());
+    int rounds = qMax(1, parser.value(roundsOpt).toInt());
+    int chunk = qMax(1, parser.value(chunkOpt).toInt());
+
+    QByteArray jsonStream = makeJsonStream(count);
+    QByteArray binaryStream = makeBinaryStream(jsonStream);
+
+    QTextStream out(stdout);
+    out << count << " messages, JSON " << jsonStream.size() << " bytes, binary " << binaryStream.size()
+        << " bytes, " << chunk << " bytes per read\n\n";
+    out << qSetFieldWidth(10) << Qt::left << "path" << qSetFieldWidth(14) << Qt::right
+        << "msg/s" << "ns/msg" << "checksum" << qSetFieldWidth(0) << "\n";
+
+    double legacyRate = 0;
+    for (int path = 0; path < 3; ++path) {
+        double best = 0;
+        Counters counters;
+        for (int round = 0; round < rounds; ++round) {
+            counters = Counters();
+            QElapsedTimer timer;
+            timer.start();
+            if (path == 0) {
+                // Кусками, как приходят данные в буфер QTcpSocket
+                QBuffer device;
+                device.open(QBuffer::ReadWrite);
+                for (int offset = 0; offset < jsonStream.size(); offset += chunk) {
+                    qint64 pos = device.pos();
+                    device.seek(device.size());
+                    device.write(jsonStream.constData() + offset, qMin(chunk, int(jsonStream.size()) - offset));
+                    device.seek(pos);
+                    runLegacy(device, counters);
+                }
+            } else if (path == 1) {
+                runRing(jsonStream, chunk, counters);
+            } else {
+                runBinary(binaryStream, chunk, counters);
+            }
+            double seconds = timer.nsecsElapsed() / 1e9;
+            best = qMax(best, counters.messages / seconds);
+        }
+        if (path == 0) legacyRate = best;
+        static const char *const names[3] = {"legacy", "ring", "binary"};
+        out << qSetFieldWidth(10) << Qt::left << names[path] << qSetFieldWidth(14) << Qt::right
+            << qRound64(best) << QString::number(1e9 / best, 'f', 1) << counters.checksum << qSetFieldWidth(0);
+        if (path > 0 && legacyRate > 0) out << "  x" << QString::number(best / legacyRate, 'f', 1);
+        out << "\n";
+    }
+    return 0;
+}
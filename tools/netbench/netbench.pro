@@ -0,0 +1,19 @@
+QT       = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = morskoy_netbench
+
+# Разбор входящего потока берется из клиента
+CLIENT_DIR = ../../client
+INCLUDEPATH += $$CLIENT_DIR
+
+SOURCES += \
+    main.cpp \
+    $$CLIENT_DIR/framereader.cpp \
+    $$CLIENT_DIR/wireprotocol.cpp
+
+HEADERS += \
+    $$CLIENT_DIR/framereader.h \
+    $$CLIENT_DIR/wireprotocol.h
@@ -0,0 +1,72 @@
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include "relayserver.h"
+
+namespace {
+
+void printUsage() {
+    std::printf("Сервер-ретранслятор для клиента Морского боя (newline JSON, по запросу — бинарные кадры).\n\n"
+                "  -p, --port N       порт (8888, 0 — любой свободный)\n"
+                "  -j, --threads N    рабочих потоков (0 — по числу ядер)\n"
+                "      --stats SEC    печатать нагрузку раз в SEC секунд (10, 0 — не печатать)\n"
+                "      --resume SEC   сколько ждать игрока после обрыва связи (15, 0 — сразу закрывать матч)\n"
+                "  -v, --verbose      писать подключения, создание и вход в игры\n"
+                "  -h, --help\n");
+}
+
+}
+
+// Локальный сервер вместо сервера на C#: morskoy_relay -p 8888 -j 4
+int main(int argc, char *argv[])
+{
+    RelaySettings settings;
+    int statsSeconds = 10;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ((arg == "-p" || arg == "--port") && hasValue) settings.port = std::atoi(argv[++i]);
+        else if ((arg == "-j" || arg == "--threads") && hasValue) settings.threads = std::atoi(argv[++i]);
+        else if (arg == "--stats" && hasValue) statsSeconds = std::atoi(argv[++i]);
+        else if (arg == "--resume" && hasValue) settings.resumeGraceMs = int(std::atof(argv[++i]) * 1000);
+        else if (arg == "-v" || arg == "--verbose") settings.verbose = true;
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else {
+            std::fprintf(stderr, "Неизвестный параметр: %s\n", arg.c_str());
+            printUsage();
+            return 1;
+        }
+    }
+
+    // Сигналы блокируем до запуска потоков — их ждет только главный поток
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    RelayServer server(settings);
+    if (!server.start()) return 1;
+
+    timespec last;
+    clock_gettime(CLOCK_MONOTONIC, &last);
+    for (;;) {
+        timespec timeout = {statsSeconds > 0 ? statsSeconds : 3600, 0};
+        int sig = sigtimedwait(&signals, nullptr, &timeout);
+        if (sig == SIGINT || sig == SIGTERM) break;
+        if (statsSeconds <= 0) continue;
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double seconds = (now.tv_sec - last.tv_sec) + (now.tv_nsec - last.tv_nsec) / 1e9;
+        last = now;
+        if (seconds > 0) server.printStats(seconds);
+    }
+
+    std::printf("[RelayServer] Остановка\n");
+    server.stop();
+    return 0;
+}
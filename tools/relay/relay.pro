@@ -0,0 +1,23 @@
+# Сервер без Qt: epoll, только Linux
+CONFIG += c++17 console
+CONFIG -= qt app_bundle
+
+TARGET = morskoy_relay
+
+LIBS += -pthread
+QMAKE_CXXFLAGS += -pthread
+
+# Протокол и разбор входящего потока — общие с клиентом
+CLIENT_DIR = ../../client
+INCLUDEPATH += $$CLIENT_DIR
+
+SOURCES += \
+    main.cpp \
+    relayserver.cpp \
+    $$CLIENT_DIR/framereader.cpp \
+    $$CLIENT_DIR/wireprotocol.cpp
+
+HEADERS += \
+    relayserver.h \
+    $$CLIENT_DIR/framereader.h \
+    $$CLIENT_DIR/wireprotocol.h
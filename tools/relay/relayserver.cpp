@@ -0,0 +1,1424 @@
+#include "relayserver.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+
+const int MAX_EVENTS = 256;
+const int READ_CHUNK = 16 * 1024;         // За одно событие — не больше, чтобы остальные подключения не ждали
+const size_t MAX_PENDING_OUT = 1 << 20;   // Клиент не читает — отключаем
+const size_t KEEP_OUT_CAPACITY = 4096;    // Больший буфер после отправки освобождаем
+const size_t REPLAY_LIMIT = 256;          // Неподтвержденных игровых сообщений на игрока
+const int EXPIRY_CHECK_MS = 500;
+const size_t MAX_SPECTATORS = 1000;       // На комнату
+
+// Метки epoll: слушающий сокет и eventfd отличаются от подключений по адресу
+char listenTag;
+char wakeTag;
+
+bool inBoard(int x, int y) {
+    return x >= 0 && x < 10 && y >= 0 && y < 10;
+}
+
+// Камень (1) бьет ножницы (3), ножницы — бумагу (2), бумага — камень
+bool rpsBeats(int a, int b) {
+    return (a == 1 && b == 3) || (a == 3 && b == 2) || (a == 2 && b == 1);
+}
+
+const char *turnName(int turn) {
+    return turn == 1 ? "Player1" : "Player2";
+}
+
+// Расстановка из пар (клетка носа, размер | 0x80 если вертикальный). Флот классический:
+// один 4-палубный, два 3-, три 2- и четыре 1-палубных, корабли не касаются даже углами.
+bool parseFleet(const std::uint8_t *ships, int size, Fleet *fleet) {
+    int count = size / 2;
+    if (count > WireProtocol::MAX_FLEET) return false;
+    std::memset(fleet->shipAt, -1, sizeof(fleet->shipAt));
+    std::memset(fleet->shot, 0, sizeof(fleet->shot));
+    int bySize[5] = {0, 0, 0, 0, 0};
+    int cells = 0;
+    for (int slot = 0; slot < count; ++slot) {
+        int bow = ships[slot * 2];
+        int length = ships[slot * 2 + 1] & 0x7F;
+        int step = (ships[slot * 2 + 1] & 0x80) ? 10 : 1;
+        if (bow >= 100 || length < 1 || length > 4) return false;
+        if (step == 1 ? bow % 10 + length > 10 : bow / 10 + length > 10) return false;
+        for (int i = 0; i < length; ++i) {
+            int cell = bow + i * step;
+            if (fleet->shipAt[cell] >= 0) return false;
+            fleet->shipAt[cell] = std::int8_t(slot);
+        }
+        fleet->sizes[slot] = std::uint8_t(length);
+        fleet->hits[slot] = 0;
+        ++bySize[length];
+        cells += length;
+    }
+    if (bySize[1] != 4 || bySize[2] != 3 || bySize[3] != 2 || bySize[4] != 1) return false;
+    for (int cell = 0; cell < 100; ++cell) {
+        int slot = fleet->shipAt[cell];
+        if (slot < 0) continue;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int x = cell % 10 + dx;
+                int y = cell / 10 + dy;
+                if (inBoard(x, y) && fleet->shipAt[y * 10 + x] >= 0 && fleet->shipAt[y * 10 + x] != slot) return false;
+            }
+        }
+    }
+    fleet->cellsLeft = cells;
+    return true;
+}
+
+// Выстрел по расстановке: BatchStatus (BatchRepeat — сюда уже стреляли, клетка не меняется)
+int shootAt(Fleet &fleet, int cell) {
+    if (fleet.shot[cell]) return WireProtocol::BatchRepeat;
+    fleet.shot[cell] = true;
+    int slot = fleet.shipAt[cell];
+    if (slot < 0) return WireProtocol::BatchMiss;
+    --fleet.cellsLeft;
+    return ++fleet.hits[slot] == fleet.sizes[slot] ? WireProtocol::BatchKill : WireProtocol::BatchHit;
+}
+
+// Комната в списке — в формате сервера на C# (GameRoom через JsonSerializer)
+std::string gameJson(const std::string &id, const Lobby::Entry &entry) {
+    return "{\"Id\":\"" + id + "\",\"Name\":\"" + entry.name + "\",\"Player1Id\":\"" + entry.hostId
+           + "\",\"Status\":0}";
+}
+
+// JSON кадром OpJson: так уходят строки клиентам с двоичным протоколом
+std::string jsonFrame(const char *json, int size) {
+    std::uint8_t header[WireProtocol::MAX_VARINT + 1];
+    int n = WireProtocol::putVarint(std::uint32_t(size + 1), header);
+    header[n++] = WireProtocol::OpJson;
+    std::string frame(reinterpret_cast<const char *>(header), size_t(n));
+    frame.append(json, size_t(size));
+    return frame;
+}
+
+std::string rawString(const WireProtocol::JsonValue &value) {
+    return value.isString ? std::string(value.data, value.size) : std::string();
+}
+
+int intField(const char *json, int size, const char *key, int fallback = 0) {
+    WireProtocol::JsonValue value;
+    return WireProtocol::findField(json, size, key, &value) ? WireProtocol::toInt(value, fallback) : fallback;
+}
+
+std::int64_t nowMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return std::int64_t(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Номер игрового сообщения в JSON: перед закрывающей скобкой строки line[0..n) ("...}\n")
+int appendSeq(char *line, int n, size_t capacity, std::uint32_t seq) {
+    if (!seq) return n;
+    n -= 2;
+    return n + std::snprintf(line + n, capacity - size_t(n), ",\"seq\":%u}\n", seq);
+}
+
+std::string utcTimestamp() {
+    timeval now;
+    gettimeofday(&now, nullptr);
+    tm parts;
+    gmtime_r(&now.tv_sec, &parts);
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", parts.tm_year + 1900, parts.tm_mon + 1,
+                  parts.tm_mday, parts.tm_hour, parts.tm_min, parts.tm_sec, int(now.tv_usec / 1000));
+    return buf;
+}
+
+}
+
+// --- Lobby ---
+
+void Lobby::add(const std::string &id, const Entry &entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    rooms[id] = entry;
+    publishLocked(id, &entry);
+}
+
+void Lobby::remove(const std::string &id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (rooms.erase(id)) publishLocked(id, nullptr);
+}
+
+bool Lobby::claim(const std::string &id, int *shard) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = rooms.find(id);
+    if (it == rooms.end()) return false;
+    *shard = it->second.shard;
+    rooms.erase(it);
+    publishLocked(id, nullptr);
+    return true;
+}
+
+// Изменение одной комнаты: добавлена (added) или ушла из списка (removed)
+void Lobby::publishLocked(const std::string &id, const Entry *added) {
+    std::string line = "{\"action\":\"lobby_update\",\"version\":" + std::to_string(++version);
+    if (added) line += ",\"change\":\"added\",\"game\":" + gameJson(id, *added) + "}";
+    else line += ",\"change\":\"removed\",\"gameId\":\"" + id + "\"}";
+    history.push_back(line);
+    if (int(history.size()) > HISTORY) history.pop_front();
+    if (publish) publish(line);
+}
+
+std::vector<std::string> Lobby::subscribe(std::uint64_t since) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> lines;
+    if (since > 0 && since <= version && version - since <= history.size()) {
+        lines.assign(history.end() - std::ptrdiff_t(version - since), history.end());
+        return lines;
+    }
+    std::string json = "{\"action\":\"lobby_snapshot\",\"version\":" + std::to_string(version) + ",\"games\":[";
+    bool first = true;
+    for (const auto &room : rooms) {
+        if (!first) json += ',';
+        first = false;
+        json += gameJson(room.first, room.second);
+    }
+    json += "]}";
+    lines.push_back(json);
+    return lines;
+}
+
+void Sessions::add(const std::string &token, const Entry &entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    sessions[token] = entry;
+}
+
+void Sessions::remove(const std::string &token) {
+    std::lock_guard<std::mutex> lock(mutex);
+    sessions.erase(token);
+}
+
+bool Sessions::find(const std::string &token, Entry *out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = sessions.find(token);
+    if (it == sessions.end()) return false;
+    *out = it->second;
+    return true;
+}
+
+void RoomDirectory::add(const std::string &id, int shard) {
+    std::lock_guard<std::mutex> lock(mutex);
+    rooms[id] = shard;
+}
+
+void RoomDirectory::remove(const std::string &id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    rooms.erase(id);
+}
+
+bool RoomDirectory::find(const std::string &id, int *shard) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = rooms.find(id);
+    if (it == rooms.end()) return false;
+    *shard = it->second;
+    return true;
+}
+
+std::string Lobby::listJson() const {
+    std::string json = "{\"action\":\"games_list\",\"games\":[";
+    std::lock_guard<std::mutex> lock(mutex);
+    bool first = true;
+    for (const auto &room : rooms) {
+        if (!first) json += ',';
+        first = false;
+        json += gameJson(room.first, room.second);
+    }
+    json += "]}";
+    return json;
+}
+
+// --- RelayWorker ---
+
+RelayWorker::RelayWorker(RelayServer *server, int index) : server(server), index(index) {}
+
+RelayWorker::~RelayWorker() {
+    for (Connection *conn : connections) {
+        ::close(conn->fd);
+        delete conn;
+    }
+    for (Connection *conn : dead) delete conn;
+    for (Mail &m : mailbox) {
+        if (!m.conn) continue;
+        ::close(m.conn->fd);
+        delete m.conn;
+    }
+    if (listenFd >= 0) ::close(listenFd);
+    if (epollFd >= 0) ::close(epollFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+}
+
+bool RelayWorker::open(int port) {
+    // У каждого потока свой слушающий сокет на том же порту: ядро само раскидывает подключения
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        std::perror("[RelayServer] socket");
+        return false;
+    }
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(std::uint16_t(port));
+    if (::bind(listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || ::listen(listenFd, SOMAXCONN) < 0) {
+        std::perror("[RelayServer] bind");
+        return false;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        std::perror("[RelayServer] epoll");
+        return false;
+    }
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &listenTag;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    ev.data.ptr = &wakeTag;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+    return true;
+}
+
+int RelayWorker::boundPort() const {
+    sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (getsockname(listenFd, reinterpret_cast<sockaddr *>(&addr), &len) < 0) return -1;
+    return ntohs(addr.sin_port);
+}
+
+void RelayWorker::start() {
+    thread = std::thread(&RelayWorker::loop, this);
+}
+
+void RelayWorker::requestStop() {
+    stopping = true;
+    std::uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void RelayWorker::join() {
+    if (thread.joinable()) thread.join();
+}
+
+void RelayWorker::adopt(Connection *conn, const std::string &roomId, Arrival arrival) {
+    {
+        std::lock_guard<std::mutex> lock(mailMutex);
+        mailbox.push_back(Mail{conn, roomId, arrival});
+    }
+    std::uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void RelayWorker::post(const std::string &line) {
+    {
+        std::lock_guard<std::mutex> lock(mailMutex);
+        mailbox.push_back(Mail{nullptr, line, ArriveJoin});
+    }
+    std::uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+void RelayWorker::loop() {
+    epoll_event events[MAX_EVENTS];
+    while (!stopping) {
+        // Пока есть места, ждущие возобновления, просыпаемся проверить их срок
+        int n = epoll_wait(epollFd, events, MAX_EVENTS, droppedSeats > 0 ? EXPIRY_CHECK_MS : -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::perror("[RelayServer] epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            void *tag = events[i].data.ptr;
+            if (tag == &listenTag) {
+                acceptAll();
+            } else if (tag == &wakeTag) {
+                std::uint64_t value;
+                ssize_t ignored = ::read(wakeFd, &value, sizeof(value));
+                (void)ignored;
+                drainMailbox();
+            } else {
+                Connection *conn = static_cast<Connection *>(tag);
+                if (conn->closed || conn->detached) continue;
+                if (events[i].events & EPOLLOUT) flush(conn);
+                if (!conn->closed && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) readFrom(conn);
+            }
+        }
+        finishIteration();
+    }
+}
+
+void RelayWorker::acceptAll() {
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) std::perror("[RelayServer] accept");
+            return;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        Connection *conn = new Connection;
+        conn->fd = fd;
+        conn->playerId = "p" + std::to_string(index) + "-" + std::to_string(++nextId);
+        attach(conn);
+        if (server->getSettings().verbose) std::printf("[RelayServer] Подключился %s\n", conn->playerId.c_str());
+    }
+}
+
+void RelayWorker::attach(Connection *conn) {
+    epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP | (conn->wantWrite ? std::uint32_t(EPOLLOUT) : 0u);
+    ev.data.ptr = conn;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, conn->fd, &ev);
+    connections.insert(conn);
+    stats.connections++;
+}
+
+void RelayWorker::drainMailbox() {
+    std::vector<Mail> mail;
+    {
+        std::lock_guard<std::mutex> lock(mailMutex);
+        mail.swap(mailbox);
+    }
+    for (Mail &m : mail) {
+        if (m.conn) {
+            // Игрок или зритель переехал в поток комнаты: входим и дочитываем то, что уже пришло
+            Connection *conn = m.conn;
+            conn->detached = false;
+            attach(conn);
+            if (m.arrival == ArriveResume) finishResume(conn, m.text);
+            else if (m.arrival == ArriveSpectate) finishSpectate(conn, m.text);
+            else finishJoin(conn, m.text);
+            processInput(conn);
+            if (!conn->closed && conn->outOffset < conn->out.size() && !conn->dirty) {
+                conn->dirty = true;
+                dirty.push_back(conn);
+            }
+        } else {
+            for (Connection *conn : connections) {
+                if (conn->lobbyWatcher && !conn->room && !conn->watching && !conn->closed && !conn->detached)
+                    sendLine(conn, m.text);
+            }
+        }
+    }
+}
+
+void RelayWorker::readFrom(Connection *conn) {
+    int total = 0;
+    while (total < READ_CHUNK) {
+        int space = 0;
+        char *dst = conn->reader.writeSpace(4096, &space);
+        if (!dst) { // Сообщение длиннее предела — поток испорчен
+            closeConnection(conn);
+            return;
+        }
+        ssize_t n = ::recv(conn->fd, dst, size_t(space), 0);
+        if (n > 0) {
+            conn->reader.commit(int(n));
+            total += int(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        closeConnection(conn); // 0 — клиент закрыл соединение
+        return;
+    }
+    processInput(conn);
+}
+
+void RelayWorker::processInput(Connection *conn) {
+    while (!conn->closed && !conn->detached) {
+        if (!conn->binary) {
+            const char *line = nullptr;
+            int len = 0;
+            if (!conn->reader.nextLine(&line, &len)) break;
+            stats.messagesIn++;
+            handleJson(conn, line, len);
+        } else {
+            std::uint8_t op = 0;
+            const std::uint8_t *payload = nullptr;
+            int size = 0;
+            int result = conn->reader.nextFrame(&op, &payload, &size);
+            if (result == 0) break;
+            if (result < 0) {
+                closeConnection(conn);
+                break;
+            }
+            stats.messagesIn++;
+            handleFrame(conn, op, payload, size);
+        }
+    }
+
+    // Одно подтверждение на всю пачку прочитанного (только клиентам с сессией — другие его не знают)
+    Room *room = conn->room;
+    if (room && !conn->closed && !conn->detached && !conn->session.empty()) {
+        Seat &seat = room->seats[conn->seat];
+        if (seat.acked != seat.received) {
+            sendAck(conn, seat.received);
+            seat.acked = seat.received;
+        }
+    }
+}
+
+void RelayWorker::handleJson(Connection *conn, const char *json, int size) {
+    WireProtocol::JsonValue action;
+    if (!WireProtocol::findField(json, size, "action", &action) || !action.isString) {
+        sendError(conn, "Ошибка обработки сообщения");
+        return;
+    }
+
+    WireProtocol::JsonValue value;
+    switch (WireProtocol::messageKey(action.data, action.size)) {
+    case WireProtocol::KeyHello: {
+        conn->helloBinary = WireProtocol::findField(json, size, "protocol", &value) && value.isString
+                            && value.size == 6 && std::memcmp(value.data, "binary", 6) == 0;
+        bool resume = WireProtocol::findField(json, size, "session", &value) && value.isString && !value.escaped;
+        Sessions::Entry entry;
+        if (resume && !conn->room && server->getSessions().find(rawString(value), &entry)) {
+            // Возврат в матч после обрыва: место ждет в потоке комнаты
+            conn->session = rawString(value);
+            conn->resumeAck = std::uint32_t(intField(json, size, "ack"));
+            if (conn->watching) stopWatching(conn);
+            if (entry.shard == index) {
+                finishResume(conn, entry.roomId);
+            } else {
+                conn->detached = true;
+                migrations.push_back(Migration{conn, entry.shard, entry.roomId, ArriveResume});
+            }
+            break;
+        }
+        if (!conn->room) conn->session = newSession();
+        sendHelloAck(conn, resume, false, 0);
+        break;
+    }
+    case WireProtocol::KeyAck:
+        handleAck(conn, std::uint32_t(intField(json, size, "seq")));
+        break;
+    case WireProtocol::KeyCreateGame:
+        WireProtocol::findField(json, size, "data", &value);
+        createGame(conn, value);
+        break;
+    case WireProtocol::KeyGetGames:
+        sendLine(conn, server->getLobby().listJson());
+        break;
+    case WireProtocol::KeySubscribeLobby:
+        // Изменения, опубликованные после снимка, уже в очереди этого потока: до клиента дойдут все
+        conn->lobbyWatcher = !conn->room && !conn->watching;
+        if (conn->lobbyWatcher) {
+            for (const std::string &line : server->getLobby().subscribe(std::uint64_t(intField(json, size, "version"))))
+                sendLine(conn, line);
+        }
+        break;
+    case WireProtocol::KeyUnsubscribeLobby:
+        conn->lobbyWatcher = false;
+        break;
+    case WireProtocol::KeyJoinGame:
+        if (!WireProtocol::findField(json, size, "gameId", &value) || !value.isString || value.escaped) {
+            sendError(conn, "Не удалось присоединиться к игре");
+            break;
+        }
+        joinGame(conn, rawString(value));
+        break;
+    case WireProtocol::KeySpectateGame:
+        if (!WireProtocol::findField(json, size, "gameId", &value) || !value.isString || value.escaped) {
+            sendError(conn, "Не удалось наблюдать за игрой");
+            break;
+        }
+        spectateGame(conn, rawString(value));
+        break;
+    case WireProtocol::KeyLeaveSpectate:
+        if (conn->watching) stopWatching(conn);
+        break;
+    case WireProtocol::KeySetName:
+        WireProtocol::findField(json, size, "data", &value);
+        sendLine(conn, "{\"action\":\"name_set\",\"name\":\"" + rawString(value) + "\"}");
+        break;
+    case WireProtocol::KeyPing: {
+        // Номер пинга возвращаем как есть: по нему клиент считает RTT
+        std::string pong = "{\"action\":\"pong\"";
+        if (WireProtocol::findField(json, size, "id", &value)) pong += ",\"id\":" + std::to_string(WireProtocol::toInt(value));
+        sendLine(conn, pong + ",\"timestamp\":\"" + utcTimestamp() + "\"}");
+        break;
+    }
+    case WireProtocol::KeyGameEvent: {
+        if (!WireProtocol::findField(json, size, "type", &value) || !value.isString) {
+            sendError(conn, "Ошибка обработки сообщения");
+            break;
+        }
+        WireProtocol::MessageKey type = WireProtocol::messageKey(value.data, value.size);
+        if (!acceptGameMessage(conn, std::uint32_t(intField(json, size, "seq")))) break; // Повтор после возобновления
+        if (type == WireProtocol::KeyFireBatch || type == WireProtocol::KeyBatchResult) {
+            std::uint8_t payload[WireProtocol::batchPayloadSize(WireProtocol::MAX_BATCH, true)];
+            int bytes = WireProtocol::batchFromJson(json, size, payload);
+            if (bytes < 0) sendError(conn, "Некорректный залп");
+            else handleBatch(conn, type == WireProtocol::KeyBatchResult, payload, bytes);
+            break;
+        }
+        int shape = intField(json, size, "value");
+        WireProtocol::JsonValue choice;
+        if (type == WireProtocol::KeyRps && WireProtocol::findField(json, size, "choice", &choice))
+            shape = WireProtocol::toInt(choice);
+        if (type == WireProtocol::KeyReady && WireProtocol::findField(json, size, "fleet", &value)) {
+            // [[x, y, размер, вертикальный], ...] — в пары как у OpReady
+            int numbers[WireProtocol::MAX_FLEET * 4 + 1];
+            int count = WireProtocol::toInts(value, numbers, WireProtocol::MAX_FLEET * 4 + 1);
+            std::uint8_t ships[WireProtocol::MAX_FLEET * 2 + 2];
+            int bytes = 0;
+            bool valid = count % 4 == 0 && count <= WireProtocol::MAX_FLEET * 4;
+            for (int i = 0; valid && i < count; i += 4) {
+                valid = inBoard(numbers[i], numbers[i + 1]) && numbers[i + 2] >= 1 && numbers[i + 2] <= 4;
+                ships[bytes++] = std::uint8_t(numbers[i + 1] * 10 + numbers[i]);
+                ships[bytes++] = std::uint8_t(numbers[i + 2] | (numbers[i + 3] ? 0x80 : 0));
+            }
+            if (valid) storeFleet(conn, ships, bytes);
+            else sendError(conn, "Некорректная расстановка");
+        }
+        handleGameEvent(conn, type, intField(json, size, "x", -1), intField(json, size, "y", -1),
+                        type == WireProtocol::KeyRps ? shape : intField(json, size, "value", -1), json, size);
+        break;
+    }
+    default:
+        sendError(conn, "Неизвестное действие: " + rawString(action));
+        break;
+    }
+}
+
+void RelayWorker::handleFrame(Connection *conn, std::uint8_t op, const std::uint8_t *payload, int size) {
+    if (op >= WireProtocol::OpReady && op <= WireProtocol::OpBatchResult) acceptGameMessage(conn, 0);
+    switch (op) {
+    case WireProtocol::OpAck: {
+        std::uint32_t seq = 0;
+        if (WireProtocol::getVarint(payload, size, &seq) > 0) handleAck(conn, seq);
+        break;
+    }
+    case WireProtocol::OpPing: {
+        std::uint8_t frame[WireProtocol::MAX_VARINT * 2 + 1];
+        int n = WireProtocol::encodeFrame(WireProtocol::OpPong, payload, size, frame);
+        queueBytes(conn, reinterpret_cast<const char *>(frame), size_t(n));
+        break;
+    }
+    case WireProtocol::OpReady:
+        if (size > 0) storeFleet(conn, payload, size);
+        handleGameEvent(conn, WireProtocol::KeyReady, 0, 0, 0, nullptr, 0);
+        break;
+    case WireProtocol::OpRps:
+        handleGameEvent(conn, WireProtocol::KeyRps, 0, 0, payload[0], nullptr, 0);
+        break;
+    case WireProtocol::OpFire:
+        handleGameEvent(conn, WireProtocol::KeyFire, payload[0] % 10, payload[0] / 10, 0, nullptr, 0);
+        break;
+    case WireProtocol::OpFireResult:
+        handleGameEvent(conn, WireProtocol::KeyFireResult, payload[0] % 10, payload[0] / 10, payload[1], nullptr, 0);
+        break;
+    case WireProtocol::OpFireBatch:
+    case WireProtocol::OpBatchResult:
+        handleBatch(conn, op == WireProtocol::OpBatchResult, payload, size);
+        break;
+    case WireProtocol::OpJson:
+        handleJson(conn, reinterpret_cast<const char *>(payload), size);
+        break;
+    default: // Смену хода присылает только сервер
+        break;
+    }
+}
+
+// Аргументы: x, y — клетка (fire, fire_result), value — фигура К-Н-Б или результат выстрела
+void RelayWorker::handleGameEvent(Connection *conn, WireProtocol::MessageKey type, int x, int y, int value,
+                                  const char *json, int size) {
+    Room *room = conn->room;
+    if (!room) {
+        sendError(conn, "Вы не в игре");
+        return;
+    }
+    int other = 1 - conn->seat;
+    if (!room->players[other] && !room->seats[other].droppedAt) {
+        sendError(conn, "Соперник еще не подключился");
+        return;
+    }
+
+    switch (type) {
+    case WireProtocol::KeyReady:
+        deliverEvent(room, other, WireProtocol::OpReady);
+        break;
+    case WireProtocol::KeyRps:
+        if (value < 1 || value > 3) return;
+        room->rps[conn->seat] = value;
+        deliverEvent(room, other, WireProtocol::OpRps, value);
+        if (room->rps[0] && room->rps[1]) {
+            // Ничья — клиенты переигрывают раунд, победитель ходит первым
+            if (room->rps[0] != room->rps[1]) {
+                room->turn = rpsBeats(room->rps[0], room->rps[1]) ? 1 : 2;
+                sendTurn(room);
+            }
+            room->rps[0] = room->rps[1] = 0;
+        }
+        break;
+    case WireProtocol::KeyFire:
+        if (!inBoard(x, y)) return;
+        if (room->turn != conn->seat + 1) {
+            sendError(conn, "Сейчас не ваш ход");
+            return;
+        }
+        if (room->resolves()) resolveFire(conn, x, y);
+        else deliverEvent(room, other, WireProtocol::OpFire, x, y, -1);
+        break;
+    case WireProtocol::KeyFireResult:
+        // Если выстрелы разрешает сервер, ответ клиента не нужен
+        if (room->resolves() || !inBoard(x, y) || value < 0 || value > 2) return;
+        deliverEvent(room, other, WireProtocol::OpFireResult, x, y, value);
+        publishShot(room, other + 1, y * 10 + x, value);
+        // Промах — ход переходит к тому, по кому стреляли
+        if (value == 0) {
+            room->turn = conn->seat + 1;
+            sendTurn(room);
+        }
+        break;
+    case WireProtocol::KeyTurnChange:
+        break; // Ход считает сервер
+    default:
+        // chat и незнакомые типы — как пришли
+        if (!json) break;
+        deliverRaw(room, other, json, size);
+        if (type == WireProtocol::KeyChat && !room->spectators.empty()) {
+            WireProtocol::JsonValue text;
+            WireProtocol::findField(json, size, "data", &text);
+            publishSpectators(room, "{\"action\":\"spectate_event\",\"type\":\"chat\",\"by\":"
+                                        + std::to_string(conn->seat + 1) + ",\"data\":\"" + rawString(text) + "\"}");
+        }
+        break;
+    }
+}
+
+void RelayWorker::storeFleet(Connection *conn, const std::uint8_t *ships, int size) {
+    // Расстановку принимаем только до начала боя: иначе половина выстрелов прошла бы мимо сервера
+    Room *room = conn->room;
+    if (!room || room->turn != 0 || room->fleets[conn->seat].placed) return;
+    Fleet &fleet = room->fleets[conn->seat];
+    if (parseFleet(ships, size, &fleet)) {
+        fleet.placed = true;
+    } else {
+        // Игра продолжится по-старому: соперник сам ответит на выстрелы
+        sendError(conn, "Некорректная расстановка");
+    }
+}
+
+// Оба прислали расстановку: стрелявший сразу получает fire_result, соперник — fire с результатом
+void RelayWorker::resolveFire(Connection *conn, int x, int y) {
+    Room *room = conn->room;
+    int other = 1 - conn->seat;
+    Fleet &target = room->fleets[other];
+    int cell = y * 10 + x;
+    if (target.shot[cell]) {
+        sendError(conn, "Сюда уже стреляли");
+        return;
+    }
+    int result = shootAt(target, cell);
+    deliverEvent(room, conn->seat, WireProtocol::OpFireResult, x, y, result);
+    deliverEvent(room, other, WireProtocol::OpFire, x, y, result);
+    publishShot(room, conn->seat + 1, cell, result);
+
+    if (target.cellsLeft == 0) {
+        room->turn = 0; // Флот потоплен — больше не стреляют
+    } else if (result == 0) {
+        room->turn = other + 1;
+        sendTurn(room);
+    }
+}
+
+// Залп способности. Туман только пересылается; авиаудар и радар при расстановках обеих сторон
+// разрешает сервер, иначе отвечает соперник одним fire_batch_result.
+void RelayWorker::handleBatch(Connection *conn, bool isResult, const std::uint8_t *payload, int size) {
+    WireProtocol::Batch batch;
+    if (!WireProtocol::decodeBatch(payload, size, &batch) || batch.hasResults != isResult) {
+        sendError(conn, "Некорректный залп");
+        return;
+    }
+    Room *room = conn->room;
+    if (!room) {
+        sendError(conn, "Вы не в игре");
+        return;
+    }
+    int other = 1 - conn->seat;
+    if (!room->players[other] && !room->seats[other].droppedAt) {
+        sendError(conn, "Соперник еще не подключился");
+        return;
+    }
+
+    if (isResult) {
+        if (room->resolves() || batch.mode == WireProtocol::BatchFog) return;
+        deliverBatch(room, other, WireProtocol::OpBatchResult, payload, size);
+        if (batch.mode != WireProtocol::BatchFire) return;
+        for (int i = 0; i < batch.count; ++i) publishShot(room, other + 1, batch.cells[i], WireProtocol::batchResult(batch, i));
+        // Ни одного попадания — ход переходит к тому, по кому стреляли
+        for (int i = 0; i < batch.count; ++i) {
+            int status = WireProtocol::batchResult(batch, i);
+            if (status == WireProtocol::BatchHit || status == WireProtocol::BatchKill) return;
+        }
+        room->turn = conn->seat + 1;
+        sendTurn(room);
+        return;
+    }
+
+    if (room->turn != conn->seat + 1) {
+        sendError(conn, "Сейчас не ваш ход");
+        return;
+    }
+    if (batch.mode != WireProtocol::BatchFog && room->resolves()) resolveBatch(conn, batch);
+    else deliverBatch(room, other, WireProtocol::OpFireBatch, payload, size);
+}
+
+void RelayWorker::resolveBatch(Connection *conn, const WireProtocol::Batch &batch) {
+    Room *room = conn->room;
+    int other = 1 - conn->seat;
+    Fleet &target = room->fleets[other];
+    int results[WireProtocol::MAX_BATCH] = {};
+    std::uint8_t payload[WireProtocol::batchPayloadSize(WireProtocol::MAX_BATCH, true)];
+
+    if (batch.mode == WireProtocol::BatchScan) {
+        // Одна случайная клетка с целым кораблем среди присланных, соперник о радаре не узнает
+        int alive[WireProtocol::MAX_BATCH];
+        int found = 0;
+        for (int i = 0; i < batch.count; ++i) {
+            int cell = batch.cells[i];
+            if (target.shipAt[cell] >= 0 && !target.shot[cell]) alive[found++] = i;
+        }
+        if (found > 0) results[alive[random() % unsigned(found)]] = 1;
+        int size = WireProtocol::encodeBatch(batch.mode, batch.cells, results, batch.count, payload);
+        deliverBatch(room, conn->seat, WireProtocol::OpBatchResult, payload, size);
+        return;
+    }
+
+    bool hit = false;
+    for (int i = 0; i < batch.count; ++i) {
+        results[i] = shootAt(target, batch.cells[i]);
+        hit = hit || results[i] == WireProtocol::BatchHit || results[i] == WireProtocol::BatchKill;
+    }
+    int size = WireProtocol::encodeBatch(batch.mode, batch.cells, results, batch.count, payload);
+    deliverBatch(room, conn->seat, WireProtocol::OpBatchResult, payload, size);
+    deliverBatch(room, other, WireProtocol::OpFireBatch, payload, size);
+    for (int i = 0; i < batch.count; ++i) publishShot(room, conn->seat + 1, batch.cells[i], results[i]);
+
+    if (target.cellsLeft == 0) {
+        room->turn = 0;
+    } else if (!hit) {
+        room->turn = other + 1;
+        sendTurn(room);
+    }
+}
+
+void RelayWorker::createGame(Connection *conn, const WireProtocol::JsonValue &name) {
+    if (conn->room) {
+        sendError(conn, "Не удалось создать игру");
+        return;
+    }
+    std::unique_ptr<Room> room(new Room);
+    if (conn->watching) stopWatching(conn);
+    room->id = std::to_string(index) + "-" + std::to_string(++nextId);
+    room->name = rawString(name);
+    room->players[0] = conn;
+    conn->room = room.get();
+    conn->seat = 0;
+    if (!conn->session.empty()) {
+        room->seats[0].session = conn->session;
+        server->getSessions().add(conn->session, Sessions::Entry{index, room->id});
+    }
+
+    sendLine(conn, "{\"action\":\"game_created\",\"gameId\":\"" + room->id + "\",\"gameName\":\"" + room->name + "\"}");
+    conn->lobbyWatcher = false; // После партии клиент подпишется заново со своей версией
+    server->getLobby().add(room->id, Lobby::Entry{room->name, conn->playerId, index});
+    server->getRooms().add(room->id, index);
+    if (server->getSettings().verbose)
+        std::printf("[RelayServer] %s создал игру %s\n", conn->playerId.c_str(), room->id.c_str());
+    rooms.emplace(room->id, std::move(room));
+    stats.rooms++;
+}
+
+void RelayWorker::joinGame(Connection *conn, const std::string &roomId) {
+    int shard = -1;
+    if (conn->room || !server->getLobby().claim(roomId, &shard)) {
+        sendError(conn, "Не удалось присоединиться к игре");
+        return;
+    }
+    conn->lobbyWatcher = false;
+    if (conn->watching) stopWatching(conn);
+    if (shard == index) {
+        finishJoin(conn, roomId);
+        return;
+    }
+    // Комната в другом потоке: переносим игрока туда в конце итерации
+    conn->detached = true;
+    migrations.push_back(Migration{conn, shard, roomId, ArriveJoin});
+}
+
+void RelayWorker::finishJoin(Connection *conn, const std::string &roomId) {
+    auto it = rooms.find(roomId);
+    if (it == rooms.end() || !it->second->players[0] || it->second->players[1]) {
+        sendError(conn, "Не удалось присоединиться к игре"); // Создатель успел уйти
+        return;
+    }
+    Room *room = it->second.get();
+    Connection *host = room->players[0];
+    room->players[1] = conn;
+    room->joined = true;
+    conn->room = room;
+    conn->seat = 1;
+    if (!conn->session.empty()) {
+        room->seats[1].session = conn->session;
+        server->getSessions().add(conn->session, Sessions::Entry{index, roomId});
+    }
+
+    sendLine(host, "{\"action\":\"player_joined\",\"opponentId\":\"" + conn->playerId + "\",\"gameId\":\"" + roomId + "\"}");
+    sendLine(conn, "{\"action\":\"game_joined\",\"opponentId\":\"" + host->playerId + "\",\"gameId\":\"" + roomId
+                       + "\",\"yourTurn\":false}");
+    publishSpectators(room, "{\"action\":\"spectate_event\",\"type\":\"player_joined\",\"opponentId\":\"" + conn->playerId + "\"}");
+    if (server->getSettings().verbose)
+        std::printf("[RelayServer] %s присоединился к игре %s\n", conn->playerId.c_str(), roomId.c_str());
+}
+
+// Оставшиеся в комнате узнают, что соперника больше не будет, зрители — что смотреть больше нечего
+void RelayWorker::closeRoom(Room *room) {
+    bool waiting = !room->joined;
+    publishSpectators(room, "{\"action\":\"spectate_event\",\"type\":\"ended\"}");
+    for (Connection *spectator : room->spectators) spectator->watching = nullptr;
+    for (int seat = 0; seat < 2; ++seat) {
+        Connection *player = room->players[seat];
+        if (player) {
+            sendError(player, "Соперник отключился");
+            player->room = nullptr;
+            player->seat = -1;
+        }
+        if (room->seats[seat].droppedAt) droppedSeats--;
+        if (!room->seats[seat].session.empty()) server->getSessions().remove(room->seats[seat].session);
+    }
+    std::string id = room->id;
+    rooms.erase(id);
+    stats.rooms--;
+    server->getRooms().remove(id);
+    if (waiting) server->getLobby().remove(id);
+}
+
+// Подключение игрока закрылось. Посреди матча место ждет возобновления по токену сессии,
+// соперник продолжает играть: его сообщения копятся до возвращения.
+void RelayWorker::leaveRoom(Connection *conn) {
+    Room *room = conn->room;
+    int seat = conn->seat;
+    room->players[seat] = nullptr;
+    conn->room = nullptr;
+    conn->seat = -1;
+
+    int other = 1 - seat;
+    bool otherPresent = room->players[other] || room->seats[other].droppedAt;
+    if (!room->seats[seat].session.empty() && otherPresent && server->getSettings().resumeGraceMs > 0) {
+        room->seats[seat].droppedAt = nowMs();
+        droppedSeats++;
+        return;
+    }
+    closeRoom(room);
+}
+
+void RelayWorker::finishResume(Connection *conn, const std::string &roomId) {
+    auto it = rooms.find(roomId);
+    Room *room = it != rooms.end() ? it->second.get() : nullptr;
+    int seatIndex = -1;
+    for (int i = 0; room && i < 2; ++i) {
+        if (room->seats[i].session == conn->session) seatIndex = i;
+    }
+    // Возобновить можно, только если все, чего клиент не получил, еще хранится
+    Seat *seat = seatIndex >= 0 ? &room->seats[seatIndex] : nullptr;
+    bool complete = seat && conn->resumeAck <= seat->sent
+                    && (seat->unacked.empty() ? conn->resumeAck == seat->sent : seat->unacked.front().seq <= conn->resumeAck + 1);
+    if (!complete) {
+        conn->session = newSession();
+        sendHelloAck(conn, true, false, 0);
+        return;
+    }
+
+    // Старое подключение могло еще не закрыться (обрыв без FIN): место забирает новое
+    Connection *old = room->players[seatIndex];
+    if (old) {
+        old->room = nullptr;
+        old->seat = -1;
+        closeConnection(old);
+    } else {
+        seat->droppedAt = 0;
+        droppedSeats--;
+    }
+    room->players[seatIndex] = conn;
+    conn->room = room;
+    conn->seat = seatIndex;
+
+    sendHelloAck(conn, true, true, seat->received);
+    seat->acked = seat->received;
+    while (!seat->unacked.empty() && seat->unacked.front().seq <= conn->resumeAck) seat->unacked.pop_front();
+    for (const Outgoing &out : seat->unacked) writeOutgoing(conn, out);
+    if (server->getSettings().verbose)
+        std::printf("[RelayServer] %s вернулся в игру %s\n", conn->playerId.c_str(), roomId.c_str());
+}
+
+void RelayWorker::spectateGame(Connection *conn, const std::string &roomId) {
+    int shard = -1;
+    if (conn->room || !server->getRooms().find(roomId, &shard)) {
+        sendError(conn, "Не удалось наблюдать за игрой");
+        return;
+    }
+    conn->lobbyWatcher = false;
+    if (conn->watching) stopWatching(conn);
+    if (shard == index) {
+        finishSpectate(conn, roomId);
+        return;
+    }
+    conn->detached = true;
+    migrations.push_back(Migration{conn, shard, roomId, ArriveSpectate});
+}
+
+// Зритель получает состояние комнаты и журнал выстрелов, дальше — события по мере игры
+void RelayWorker::finishSpectate(Connection *conn, const std::string &roomId) {
+    auto it = rooms.find(roomId);
+    if (it == rooms.end() || it->second->spectators.size() >= MAX_SPECTATORS) {
+        sendError(conn, "Не удалось наблюдать за игрой");
+        return;
+    }
+    Room *room = it->second.get();
+    room->spectators.push_back(conn);
+    conn->watching = room;
+
+    std::string json = "{\"action\":\"spectate_begin\",\"gameId\":\"" + room->id + "\",\"gameName\":\"" + room->name + "\"";
+    for (int seat = 0; seat < 2; ++seat) {
+        json += seat ? ",\"player2Id\":\"" : ",\"player1Id\":\"";
+        if (room->players[seat]) json += room->players[seat]->playerId;
+        json += '"';
+    }
+    json += ",\"turn\":" + std::to_string(room->turn) + ",\"shots\":[";
+    for (size_t i = 0; i < room->shots.size(); ++i) {
+        const PublicShot &shot = room->shots[i];
+        if (i) json += ',';
+        json += std::to_string(shot.by) + ',' + std::to_string(shot.cell) + ',' + std::to_string(shot.result);
+    }
+    sendLine(conn, json + "]}");
+    if (server->getSettings().verbose)
+        std::printf("[RelayServer] %s смотрит игру %s\n", conn->playerId.c_str(), roomId.c_str());
+}
+
+void RelayWorker::stopWatching(Connection *conn) {
+    std::vector<Connection *> &spectators = conn->watching->spectators;
+    auto it = std::find(spectators.begin(), spectators.end(), conn);
+    if (it != spectators.end()) {
+        *it = spectators.back();
+        spectators.pop_back();
+    }
+    conn->watching = nullptr;
+}
+
+void RelayWorker::expireDroppedSeats() {
+    std::int64_t now = nowMs();
+    if (now < nextExpiryCheck) return;
+    nextExpiryCheck = now + EXPIRY_CHECK_MS;
+    std::vector<Room *> expired;
+    for (auto &entry : rooms) {
+        Room *room = entry.second.get();
+        for (const Seat &seat : room->seats) {
+            if (seat.droppedAt && now - seat.droppedAt > server->getSettings().resumeGraceMs) {
+                expired.push_back(room);
+                break;
+            }
+        }
+    }
+    for (Room *room : expired) closeRoom(room);
+}
+
+std::string RelayWorker::newSession() {
+    char token[33];
+    std::snprintf(token, sizeof(token), "%016llx%016llx", static_cast<unsigned long long>(random()),
+                  static_cast<unsigned long long>(random()));
+    return token;
+}
+
+// Подтверждение еще строкой, все после него — кадрами (если их просили)
+void RelayWorker::sendHelloAck(Connection *conn, bool resumeRequested, bool resumed, std::uint32_t ack) {
+    std::string line = std::string("{\"action\":\"hello_ack\",\"protocol\":\"") + (conn->helloBinary ? "binary" : "json")
+                       + "\",\"version\":" + std::to_string(WireProtocol::VERSION) + ",\"resolve\":true,\"session\":\""
+                       + conn->session + "\"";
+    if (resumeRequested) line += std::string(",\"resumed\":") + (resumed ? "true" : "false");
+    if (resumed) line += ",\"ack\":" + std::to_string(ack);
+    sendLine(conn, line + "}");
+    conn->binary = conn->helloBinary;
+}
+
+bool RelayWorker::acceptGameMessage(Connection *conn, std::uint32_t seq) {
+    if (!conn->room) return true; // Ответит ошибкой обработчик
+    Seat &seat = conn->room->seats[conn->seat];
+    if (seq && seq <= seat.received) return false;
+    seat.received = seq ? seq : seat.received + 1;
+    return true;
+}
+
+void RelayWorker::handleAck(Connection *conn, std::uint32_t seq) {
+    if (!conn->room) return;
+    Seat &seat = conn->room->seats[conn->seat];
+    while (!seat.unacked.empty() && seat.unacked.front().seq <= seq) seat.unacked.pop_front();
+}
+
+// --- Output ---
+
+void RelayWorker::deliver(Room *room, int seat, Outgoing out) {
+    Seat &state = room->seats[seat];
+    out.seq = ++state.sent;
+    Connection *conn = room->players[seat];
+    if (conn) writeOutgoing(conn, out);
+    // Без сессии клиент не вернется и не подтверждает — хранить незачем
+    if (state.session.empty()) return;
+    state.unacked.push_back(std::move(out));
+    if (state.unacked.size() > REPLAY_LIMIT) state.unacked.pop_front();
+}
+
+void RelayWorker::deliverEvent(Room *room, int seat, WireProtocol::Opcode op, int a, int b, int c) {
+    Outgoing out;
+    out.op = op;
+    out.a = a;
+    out.b = b;
+    out.c = c;
+    deliver(room, seat, std::move(out));
+}
+
+void RelayWorker::deliverBatch(Room *room, int seat, WireProtocol::Opcode op, const std::uint8_t *payload, int size) {
+    Outgoing out;
+    out.op = op;
+    out.data.assign(reinterpret_cast<const char *>(payload), size_t(size));
+    deliver(room, seat, std::move(out));
+}
+
+void RelayWorker::deliverRaw(Room *room, int seat, const char *json, int size) {
+    Outgoing out;
+    out.data.assign(json, size_t(size));
+    deliver(room, seat, std::move(out));
+}
+
+void RelayWorker::writeOutgoing(Connection *conn, const Outgoing &out) {
+    switch (out.op) {
+    case WireProtocol::OpJson: {
+        // Номер отправителя (если был) перекрываем своим: сканер берет первое вхождение поля
+        std::string json = "{\"seq\":" + std::to_string(out.seq) + ",";
+        json.append(out.data, out.data.find('{') + 1, std::string::npos);
+        sendLine(conn, json);
+        break;
+    }
+    case WireProtocol::OpFireBatch:
+    case WireProtocol::OpBatchResult:
+        sendBatch(conn, out.op, reinterpret_cast<const std::uint8_t *>(out.data.data()), int(out.data.size()), out.seq);
+        break;
+    default:
+        sendEvent(conn, out.op, out.a, out.b, out.c, out.seq);
+        break;
+    }
+}
+
+void RelayWorker::queueBytes(Connection *conn, const char *data, size_t size) {
+    if (conn->closed) return;
+    if (conn->out.size() - conn->outOffset + size > MAX_PENDING_OUT) {
+        closeConnection(conn);
+        return;
+    }
+    conn->out.append(data, size);
+    stats.messagesOut++;
+    if (!conn->dirty) {
+        conn->dirty = true;
+        dirty.push_back(conn);
+    }
+}
+
+void RelayWorker::sendRaw(Connection *conn, const char *json, int size) {
+    if (conn->binary) {
+        std::string frame = jsonFrame(json, size);
+        queueBytes(conn, frame.data(), frame.size());
+        return;
+    }
+    std::string line(json, size_t(size));
+    line += '\n';
+    queueBytes(conn, line.data(), line.size());
+}
+
+void RelayWorker::sendEvent(Connection *conn, WireProtocol::Opcode op, int a, int b, int c, std::uint32_t seq) {
+    if (conn->binary) {
+        std::uint8_t payload[2] = {};
+        int size = 0;
+        switch (op) {
+        case WireProtocol::OpRps: payload[0] = std::uint8_t(a); size = 1; break;
+        case WireProtocol::OpFire:
+            payload[0] = std::uint8_t(b * 10 + a);
+            payload[1] = std::uint8_t(c);
+            size = c >= 0 ? 2 : 1;
+            break;
+        case WireProtocol::OpFireResult: payload[0] = std::uint8_t(b * 10 + a); payload[1] = std::uint8_t(c); size = 2; break;
+        case WireProtocol::OpTurnChange: payload[0] = std::uint8_t(a); size = 1; break;
+        default: break;
+        }
+        std::uint8_t frame[WireProtocol::MAX_VARINT + 3];
+        int n = WireProtocol::encodeFrame(op, payload, size, frame);
+        queueBytes(conn, reinterpret_cast<const char *>(frame), size_t(n));
+        return;
+    }
+
+    char line[128];
+    int n = 0;
+    switch (op) {
+    case WireProtocol::OpReady:
+        n = std::snprintf(line, sizeof(line), "{\"action\":\"game_event\",\"type\":\"ready\"}\n");
+        break;
+    case WireProtocol::OpRps:
+        n = std::snprintf(line, sizeof(line), "{\"action\":\"game_event\",\"type\":\"rps\",\"value\":%d}\n", a);
+        break;
+    case WireProtocol::OpFire:
+        if (c >= 0)
+            n = std::snprintf(line, sizeof(line),
+                              "{\"action\":\"game_event\",\"type\":\"fire\",\"x\":%d,\"y\":%d,\"value\":%d}\n", a, b, c);
+        else
+            n = std::snprintf(line, sizeof(line), "{\"action\":\"game_event\",\"type\":\"fire\",\"x\":%d,\"y\":%d}\n", a, b);
+        break;
+    case WireProtocol::OpFireResult:
+        n = std::snprintf(line, sizeof(line),
+                          "{\"action\":\"game_event\",\"type\":\"fire_result\",\"x\":%d,\"y\":%d,\"value\":%d}\n", a, b, c);
+        break;
+    case WireProtocol::OpTurnChange:
+        n = std::snprintf(line, sizeof(line), "{\"action\":\"game_event\",\"type\":\"turn_change\",\"currentTurn\":\"%s\"}\n",
+                          turnName(a));
+        break;
+    default:
+        return;
+    }
+    n = appendSeq(line, n, sizeof(line), seq);
+    queueBytes(conn, line, size_t(n));
+}
+
+void RelayWorker::sendBatch(Connection *conn, WireProtocol::Opcode op, const std::uint8_t *payload, int size,
+                            std::uint32_t seq) {
+    if (conn->binary) {
+        std::uint8_t frame[WireProtocol::MAX_VARINT + 1 + WireProtocol::batchPayloadSize(WireProtocol::MAX_BATCH, true)];
+        int n = WireProtocol::encodeFrame(op, payload, size, frame);
+        queueBytes(conn, reinterpret_cast<const char *>(frame), size_t(n));
+        return;
+    }
+
+    WireProtocol::Batch batch;
+    WireProtocol::decodeBatch(payload, size, &batch);
+    std::string line = std::string("{\"action\":\"game_event\",\"type\":\"")
+                       + (op == WireProtocol::OpFireBatch ? "fire_batch" : "fire_batch_result")
+                       + "\",\"mode\":" + std::to_string(batch.mode) + ",\"cells\":[";
+    for (int i = 0; i < batch.count; ++i) {
+        if (i) line += ',';
+        line += std::to_string(batch.cells[i]);
+    }
+    line += ']';
+    if (batch.hasResults) {
+        line += ",\"results\":[";
+        for (int i = 0; i < batch.count; ++i) {
+            int status = WireProtocol::batchResult(batch, i);
+            if (i) line += ',';
+            line += status == WireProtocol::BatchRepeat ? "-1" : std::to_string(status);
+        }
+        line += ']';
+    }
+    if (seq) line += ",\"seq\":" + std::to_string(seq);
+    line += "}\n";
+    queueBytes(conn, line.data(), line.size());
+}
+
+void RelayWorker::sendAck(Connection *conn, std::uint32_t seq) {
+    if (conn->binary) {
+        std::uint8_t payload[WireProtocol::MAX_VARINT];
+        std::uint8_t frame[WireProtocol::MAX_VARINT * 2 + 1];
+        int n = WireProtocol::encodeFrame(WireProtocol::OpAck, payload, WireProtocol::putVarint(seq, payload), frame);
+        queueBytes(conn, reinterpret_cast<const char *>(frame), size_t(n));
+        return;
+    }
+    sendLine(conn, "{\"action\":\"ack\",\"seq\":" + std::to_string(seq) + "}");
+}
+
+void RelayWorker::sendError(Connection *conn, const std::string &message) {
+    sendLine(conn, "{\"action\":\"error\",\"message\":\"" + message + "\"}");
+}
+
+void RelayWorker::sendTurn(Room *room) {
+    for (int seat = 0; seat < 2; ++seat) {
+        if (room->players[seat] || room->seats[seat].droppedAt) deliverEvent(room, seat, WireProtocol::OpTurnChange, room->turn);
+    }
+    if (!room->spectators.empty()) {
+        publishSpectators(room, std::string("{\"action\":\"spectate_event\",\"type\":\"turn_change\",\"currentTurn\":\"")
+                                    + turnName(room->turn) + "\"}");
+    }
+}
+
+// Сотни зрителей не должны стоить сотни кодирований: строка и кадр собираются при первом зрителе
+// с таким протоколом, остальным копируются готовые байты. Обход с конца: если очередь зрителя
+// переполнена, queueBytes закрывает его, и на его место встает уже обслуженный последний.
+void RelayWorker::publishSpectators(Room *room, const std::string &json) {
+    std::string line;
+    std::string frame;
+    for (size_t i = room->spectators.size(); i-- > 0;) {
+        Connection *conn = room->spectators[i];
+        std::string &bytes = conn->binary ? frame : line;
+        if (bytes.empty()) bytes = conn->binary ? jsonFrame(json.data(), int(json.size())) : json + '\n';
+        queueBytes(conn, bytes.data(), bytes.size());
+    }
+}
+
+// Выстрел известен серверу: в журнал для будущих зрителей и нынешним. Повторы не меняют поле — пропускаем,
+// в том числе повторный ответ клиента по той же клетке: журнал ограничен двумя полями (200 записей).
+void RelayWorker::publishShot(Room *room, int by, int cell, int result) {
+    if (result < 0 || result == WireProtocol::BatchRepeat || cell < 0 || cell >= 100) return;
+    std::uint64_t &word = room->shotMask[by - 1][cell / 64];
+    std::uint64_t bit = std::uint64_t(1) << (cell % 64);
+    if (word & bit) return;
+    word |= bit;
+    room->shots.push_back(PublicShot{std::uint8_t(by), std::uint8_t(cell), std::uint8_t(result)});
+    if (room->spectators.empty()) return;
+    char json[128];
+    int n = std::snprintf(json, sizeof(json),
+                          "{\"action\":\"spectate_event\",\"type\":\"shot\",\"by\":%d,\"x\":%d,\"y\":%d,\"value\":%d}", by,
+                          cell % 10, cell / 10, result);
+    publishSpectators(room, std::string(json, size_t(n)));
+}
+
+void RelayWorker::flush(Connection *conn) {
+    while (conn->outOffset < conn->out.size()) {
+        ssize_t n = ::send(conn->fd, conn->out.data() + conn->outOffset, conn->out.size() - conn->outOffset, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn->outOffset += size_t(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            setWantWrite(conn, true);
+            return;
+        }
+        closeConnection(conn);
+        return;
+    }
+    conn->out.clear();
+    conn->outOffset = 0;
+    if (conn->out.capacity() > KEEP_OUT_CAPACITY) conn->out.shrink_to_fit();
+    setWantWrite(conn, false);
+}
+
+void RelayWorker::setWantWrite(Connection *conn, bool want) {
+    if (conn->wantWrite == want) return;
+    conn->wantWrite = want;
+    epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP | (want ? std::uint32_t(EPOLLOUT) : 0u);
+    ev.data.ptr = conn;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, conn->fd, &ev);
+}
+
+void RelayWorker::closeConnection(Connection *conn) {
+    if (conn->closed) return;
+    conn->closed = true;
+    if (conn->room) leaveRoom(conn);
+    if (conn->watching) stopWatching(conn);
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    ::close(conn->fd);
+    connections.erase(conn);
+    stats.connections--;
+    dead.push_back(conn);
+    if (server->getSettings().verbose) std::printf("[RelayServer] Отключился %s\n", conn->playerId.c_str());
+}
+
+// Конец итерации: одна запись на подключение, переезды, удаление закрытых
+void RelayWorker::finishIteration() {
+    if (droppedSeats > 0) expireDroppedSeats();
+    for (size_t i = 0; i < dirty.size(); ++i) {
+        Connection *conn = dirty[i];
+        conn->dirty = false;
+        if (!conn->closed && !conn->detached) flush(conn);
+    }
+    dirty.clear();
+
+    for (Migration &m : migrations) {
+        Connection *conn = m.conn;
+        if (conn->closed) continue; // closeConnection уже снял его с epoll и из счетчика
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+        connections.erase(conn);
+        stats.connections--;
+        server->worker(m.shard)->adopt(conn, m.roomId, m.arrival);
+    }
+    migrations.clear();
+
+    for (Connection *conn : dead) delete conn;
+    dead.clear();
+}
+
+// --- RelayServer ---
+
+RelayServer::RelayServer(const RelaySettings &settings) : settings(settings) {
+    lobby.setPublisher([this](const std::string &line) { broadcastLobby(line); });
+}
+
+RelayServer::~RelayServer() {
+    stop();
+}
+
+bool RelayServer::start() {
+    int threads = settings.threads > 0 ? settings.threads : int(std::max(1u, std::thread::hardware_concurrency()));
+    for (int i = 0; i < threads; ++i) workers.emplace_back(new RelayWorker(this, i));
+
+    // Первый поток занимает порт (0 — любой свободный), остальные садятся на тот же
+    if (!workers[0]->open(settings.port)) return false;
+    settings.port = workers[0]->boundPort();
+    for (int i = 1; i < threads; ++i) {
+        if (!workers[i]->open(settings.port)) return false;
+    }
+    for (auto &worker : workers) worker->start();
+    std::printf("[RelayServer] Порт %d, потоков %d\n", settings.port, threads);
+    std::fflush(stdout);
+    return true;
+}
+
+void RelayServer::stop() {
+    for (auto &worker : workers) worker->requestStop();
+    for (auto &worker : workers) worker->join();
+    workers.clear();
+}
+
+void RelayServer::broadcastLobby(const std::string &line) {
+    for (auto &worker : workers) worker->post(line);
+}
+
+void RelayServer::printStats(double seconds) {
+    std::int64_t connections = 0, rooms = 0, in = 0, out = 0;
+    for (auto &worker : workers) {
+        const RelayWorker::Stats &s = worker->getStats();
+        connections += s.connections;
+        rooms += s.rooms;
+        in += s.messagesIn;
+        out += s.messagesOut;
+    }
+    std::printf("[RelayServer] подключений %lld, комнат %lld, входящих %.0f/с, исходящих %.0f/с\n",
+                static_cast<long long>(connections), static_cast<long long>(rooms),
+                (in - lastIn) / seconds, (out - lastOut) / seconds);
+    std::fflush(stdout);
+    lastIn = in;
+    lastOut = out;
+}
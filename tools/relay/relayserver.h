@@ -0,0 +1,327 @@
+#ifndef RELAYSERVER_H
+#define RELAYSERVER_H
+
+#include <atomic>
+#include <deque>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "framereader.h"
+#include "wireprotocol.h"
+
+struct RelaySettings {
+    int port = 8888;
+    int threads = 0; // 0 — по числу ядер
+    bool verbose = false;
+    int resumeGraceMs = 15000; // Место игрока ждет возобновления после обрыва
+};
+
+struct Room;
+
+// Подключение игрока. Принадлежит одному рабочему потоку: сначала тому, что его принял,
+// после входа в комнату — потоку комнаты.
+struct Connection {
+    static const int READER_CAPACITY = 512; // Сообщения короткие: десятки тысяч подключений без лишней памяти
+
+    int fd = -1;
+    std::string playerId;
+    FrameReader reader{READER_CAPACITY};
+    std::string out;        // Еще не отправленное
+    size_t outOffset = 0;
+    bool binary = false;    // После hello/hello_ack — кадры WireProtocol в обе стороны
+    bool dirty = false;     // В списке на отправку в конце итерации
+    bool wantWrite = false; // Ждем EPOLLOUT
+    bool closed = false;
+    bool lobbyWatcher = false; // Подписан на лобби (subscribe_lobby) — получает lobby_update
+    Room *watching = nullptr;  // Зритель этой комнаты (spectate_game): только получает события
+    bool detached = false;  // Передается другому потоку — больше не трогаем
+    Room *room = nullptr;
+    int seat = -1;          // 0 — Player1 (создатель), 1 — Player2
+    std::string session;    // Выдан в hello_ack; с ним можно вернуться в матч после обрыва
+    bool helloBinary = false;     // Возобновление: протокол, запрошенный в hello
+    std::uint32_t resumeAck = 0;  // Возобновление: последнее полученное клиентом игровое сообщение
+};
+
+// Расстановка игрока, если клиент прислал ее с ready: тогда выстрелы разрешает сервер
+struct Fleet {
+    std::int8_t shipAt[100];      // Номер корабля в клетке, -1 — вода
+    std::uint8_t sizes[WireProtocol::MAX_FLEET];
+    std::uint8_t hits[WireProtocol::MAX_FLEET];
+    bool shot[100];
+    int cellsLeft = 0;            // Неподбитых клеток кораблей
+    bool placed = false;
+};
+
+// Игровое сообщение игроку. Хранится до подтверждения клиентом: после обрыва пересылается заново
+// в протоколе нового подключения.
+struct Outgoing {
+    std::uint32_t seq = 0;
+    WireProtocol::Opcode op = WireProtocol::OpJson;
+    int a = 0;
+    int b = 0;
+    int c = 0;
+    std::string data; // OpJson — JSON как есть, OpFireBatch/OpBatchResult — данные кадра
+};
+
+// Место игрока в комнате: переживает подключение, пока идет ожидание возобновления
+struct Seat {
+    std::string session;
+    std::uint32_t sent = 0;     // Номер последнего игрового сообщения игроку
+    std::uint32_t received = 0; // Номер последнего игрового сообщения от игрока
+    std::uint32_t acked = 0;    // Сколько из полученных мы уже подтвердили
+    std::deque<Outgoing> unacked;
+    std::int64_t droppedAt = 0; // Время обрыва (мс), 0 — игрок на связи
+};
+
+// Выстрел в журнале комнаты: новый зритель получает все сделанные до него
+struct PublicShot {
+    std::uint8_t by;     // 1 — стрелял Player1, 2 — Player2
+    std::uint8_t cell;
+    std::uint8_t result; // BatchStatus
+};
+
+// Комната живет в одном потоке (шарде), оба игрока и все зрители переносятся туда
+struct Room {
+    std::string id;
+    std::string name;       // Как прислал клиент (уже экранированный JSON)
+    Connection *players[2] = {nullptr, nullptr};
+    int rps[2] = {0, 0};
+    int turn = 0;           // 0 — еще не разыгран (или игра кончилась), 1 — Player1, 2 — Player2
+    Fleet fleets[2];
+    Seat seats[2];
+    bool joined = false;    // Второй игрок вошел — комнаты больше нет в лобби
+    std::vector<Connection *> spectators;
+    std::vector<PublicShot> shots; // Только если выстрел известен серверу: разрешен им или клиентом в ответе
+    std::uint64_t shotMask[2][2] = {}; // Клетки в журнале по стрелявшему (100 бит на поле-цель): не больше записи на клетку
+    bool resolves() const { return fleets[0].placed && fleets[1].placed; }
+};
+
+// Ожидающие комнаты всех потоков: список для get_games, подписка на изменения и поиск шарда для join_game.
+// Каждое изменение получает следующую версию и уходит подписчикам одной строкой lobby_update;
+// последние HISTORY изменений хранятся, чтобы переподписка отдавала только пропущенное.
+class Lobby
+{
+public:
+    static const int HISTORY = 256;
+
+    struct Entry {
+        std::string name;
+        std::string hostId;
+        int shard;
+    };
+
+    // Рассылка изменения подписчикам. Вызывается под замком лобби: версии приходят по порядку.
+    void setPublisher(std::function<void(const std::string &line)> publisher) { publish = std::move(publisher); }
+
+    void add(const std::string &id, const Entry &entry);
+    void remove(const std::string &id);
+    // Забирает комнату под присоединение: второй claim той же комнаты не пройдет
+    bool claim(const std::string &id, int *shard);
+    std::string listJson() const;
+    // Ответ на subscribe_lobby: изменения после version, если они еще в истории, иначе снимок
+    std::vector<std::string> subscribe(std::uint64_t version) const;
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> rooms;
+    std::uint64_t version = 0;
+    std::deque<std::string> history; // lobby_update версий version - size + 1 .. version
+    std::function<void(const std::string &line)> publish;
+
+    void publishLocked(const std::string &id, const Entry *added);
+};
+
+// Сессии игроков в матчах всех потоков: по токену из hello находится шард комнаты
+class Sessions
+{
+public:
+    struct Entry {
+        int shard;
+        std::string roomId;
+    };
+
+    void add(const std::string &token, const Entry &entry);
+    void remove(const std::string &token);
+    bool find(const std::string &token, Entry *out) const;
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> sessions;
+};
+
+// Все комнаты всех потоков, и ожидающие, и идущие: по id находится шард для spectate_game
+class RoomDirectory
+{
+public:
+    void add(const std::string &id, int shard);
+    void remove(const std::string &id);
+    bool find(const std::string &id, int *shard) const;
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, int> rooms;
+};
+
+class RelayServer;
+
+// Рабочий поток: свой слушающий сокет (SO_REUSEPORT), свой epoll, свои комнаты
+class RelayWorker
+{
+public:
+    struct Stats {
+        std::atomic<std::int64_t> connections{0};
+        std::atomic<std::int64_t> rooms{0};
+        std::atomic<std::int64_t> messagesIn{0};
+        std::atomic<std::int64_t> messagesOut{0};
+    };
+
+    RelayWorker(RelayServer *server, int index);
+    ~RelayWorker();
+
+    bool open(int port);
+    int boundPort() const;
+    void start();
+    void requestStop();
+    void join();
+    const Stats &getStats() const { return stats; }
+
+    // Зачем подключение переезжает в поток комнаты
+    enum Arrival {
+        ArriveJoin,     // Второй игрок
+        ArriveResume,   // Возвращается на свое место после обрыва
+        ArriveSpectate  // Зритель
+    };
+
+    // Вызываются из других потоков
+    void adopt(Connection *conn, const std::string &roomId, Arrival arrival = ArriveJoin);
+    void post(const std::string &line); // Подключениям в лобби, следящим за списком игр
+
+private:
+    struct Mail {
+        Connection *conn;   // nullptr — рассылка line
+        std::string text;   // Комната для присоединения или строка рассылки
+        Arrival arrival;
+    };
+    struct Migration {
+        Connection *conn;
+        int shard;
+        std::string roomId;
+        Arrival arrival;
+    };
+
+    RelayServer *server;
+    int index;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::thread thread;
+    std::atomic_bool stopping{false};
+    Stats stats;
+
+    std::mutex mailMutex;
+    std::vector<Mail> mailbox;
+
+    std::unordered_set<Connection *> connections;
+    std::unordered_map<std::string, std::unique_ptr<Room>> rooms;
+    std::vector<Connection *> dirty; // Отправить в конце итерации
+    std::vector<Connection *> dead;  // Удалить в конце итерации
+    std::vector<Migration> migrations; // Передать потоку комнаты
+    std::uint64_t nextId = 0;
+    std::mt19937_64 random{std::random_device{}()}; // Токены сессий, цель радара
+    int droppedSeats = 0;           // Мест, ждущих возобновления
+    std::int64_t nextExpiryCheck = 0;
+
+    void loop();
+    void acceptAll();
+    void drainMailbox();
+    void attach(Connection *conn);
+    void readFrom(Connection *conn);
+    void processInput(Connection *conn);
+    void handleJson(Connection *conn, const char *json, int size);
+    void handleFrame(Connection *conn, std::uint8_t op, const std::uint8_t *payload, int size);
+    void handleGameEvent(Connection *conn, WireProtocol::MessageKey type, int a, int b, int c,
+                         const char *json, int size);
+    void storeFleet(Connection *conn, const std::uint8_t *ships, int size);
+    void resolveFire(Connection *conn, int x, int y);
+    void handleBatch(Connection *conn, bool isResult, const std::uint8_t *payload, int size);
+    void resolveBatch(Connection *conn, const WireProtocol::Batch &batch);
+    bool acceptGameMessage(Connection *conn, std::uint32_t seq);
+    void handleAck(Connection *conn, std::uint32_t seq);
+
+    void createGame(Connection *conn, const WireProtocol::JsonValue &name);
+    void joinGame(Connection *conn, const std::string &roomId);
+    void finishJoin(Connection *conn, const std::string &roomId);
+    void closeRoom(Room *room);
+    void leaveRoom(Connection *conn);
+    void finishResume(Connection *conn, const std::string &roomId);
+    void spectateGame(Connection *conn, const std::string &roomId);
+    void finishSpectate(Connection *conn, const std::string &roomId);
+    void stopWatching(Connection *conn);
+    void expireDroppedSeats();
+    std::string newSession();
+    void sendHelloAck(Connection *conn, bool resumeRequested, bool resumed, std::uint32_t ack);
+
+    void sendRaw(Connection *conn, const char *json, int size);
+    void sendLine(Connection *conn, const std::string &json) { sendRaw(conn, json.data(), int(json.size())); }
+    // Игровые сообщения: номер, запоминание до подтверждения, отправка (если игрок на связи)
+    void deliver(Room *room, int seat, Outgoing out);
+    void deliverEvent(Room *room, int seat, WireProtocol::Opcode op, int a = 0, int b = 0, int c = 0);
+    void deliverBatch(Room *room, int seat, WireProtocol::Opcode op, const std::uint8_t *payload, int size);
+    void deliverRaw(Room *room, int seat, const char *json, int size);
+    void writeOutgoing(Connection *conn, const Outgoing &out);
+    // OpFire: c — результат, если выстрел разрешил сервер, иначе -1. seq идет в JSON полем "seq".
+    void sendEvent(Connection *conn, WireProtocol::Opcode op, int a, int b, int c, std::uint32_t seq);
+    void sendBatch(Connection *conn, WireProtocol::Opcode op, const std::uint8_t *payload, int size, std::uint32_t seq);
+    void sendAck(Connection *conn, std::uint32_t seq);
+    void sendError(Connection *conn, const std::string &message);
+    void sendTurn(Room *room);
+    // Публичные события зрителям: JSON кодируется в строку и в кадр один раз на всех
+    void publishSpectators(Room *room, const std::string &json);
+    void publishShot(Room *room, int by, int cell, int result);
+    void queueBytes(Connection *conn, const char *data, size_t size);
+    void flush(Connection *conn);
+    void setWantWrite(Connection *conn, bool want);
+    void closeConnection(Connection *conn);
+    void finishIteration();
+};
+
+// Сервер-ретранслятор протокола NetworkClient: лобби как у сервера на C#, плюс game_event
+// между игроками комнаты и смена хода (после К-Н-Б и после промаха), публичные события — зрителям.
+class RelayServer
+{
+public:
+    explicit RelayServer(const RelaySettings &settings);
+    ~RelayServer();
+
+    bool start(); // false — порт не открылся
+    void stop();
+
+    Lobby &getLobby() { return lobby; }
+    Sessions &getSessions() { return sessions; }
+    RoomDirectory &getRooms() { return roomDirectory; }
+    const RelaySettings &getSettings() const { return settings; }
+    int workerCount() const { return int(workers.size()); }
+    RelayWorker *worker(int i) { return workers[i].get(); }
+
+    // Рассылка изменения лобби подписчикам всех потоков
+    void broadcastLobby(const std::string &line);
+    void printStats(double seconds);
+
+private:
+    RelaySettings settings;
+    Lobby lobby;
+    Sessions sessions;
+    RoomDirectory roomDirectory;
+    std::vector<std::unique_ptr<RelayWorker>> workers;
+    std::int64_t lastIn = 0;
+    std::int64_t lastOut = 0;
+};
+
+#endif // RELAYSERVER_H
@@ -0,0 +1,71 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QTextStream>
+#include <QtConcurrent>
+#include "tournament.h"
+
+// Турнир ботов без интерфейса: morskoy_selfplay -a queue -b density -n 10000 -s 1
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("morskoy_selfplay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Партии бот против бота на всех ядрах. Стратегии: " + shooterNames().join(", "));
+    parser.addHelpOption();
+    QCommandLineOption firstOpt({"a", "first"}, "Первая стратегия.", "name", "queue");
+    QCommandLineOption secondOpt({"b", "second"}, "Вторая стратегия.", "name", "density");
+    QCommandLineOption gamesOpt({"n", "games"}, "Число партий.", "count", "1000");
+    QCommandLineOption seedOpt({"s", "seed"}, "Зерно генератора (одинаковое зерно — одинаковые партии).", "seed", "1");
+    QCommandLineOption threadsOpt({"j", "threads"}, "Потоков (0 — по числу ядер).", "count", "0");
+    QCommandLineOption samplesOpt("mc-samples", "Выборок на ход для montecarlo.", "count", "2000");
+    parser.addOptions({firstOpt, secondOpt, gamesOpt, seedOpt, threadsOpt, samplesOpt});
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    TournamentSettings settings;
+    settings.first = parser.value(firstOpt);
+    settings.second = parser.value(secondOpt);
+    settings.games = qMax(1, parser.value(gamesOpt).toInt());
+    settings.seed = parser.value(seedOpt).toULongLong();
+    settings.mcSamples = qMax(1, parser.value(samplesOpt).toInt());
+    for (const QString &name : {settings.first, settings.second}) {
+        if (!createShooter(name, settings)) {
+            err << "Неизвестная стратегия: " << name << "\n";
+            return 1;
+        }
+    }
+
+    int threads = parser.value(threadsOpt).toInt();
+    if (threads > 0) QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+    QVector<int> indices(settings.games);
+    for (int i = 0; i < settings.games; ++i) indices[i] = i;
+
+    QElapsedTimer timer;
+    timer.start();
+    QVector<GameResult> results = QtConcurrent::blockingMapped(indices, [&settings](int index) {
+        return playGame(settings, index);
+    });
+    double seconds = timer.nsecsElapsed() / 1e9;
+
+    out << settings.first << " vs " << settings.second << ": " << settings.games << " games, seed "
+        << settings.seed << ", " << QThreadPool::globalInstance()->maxThreadCount() << " threads\n\n";
+    out << qSetFieldWidth(12) << Qt::left << "strategy" << qSetFieldWidth(8) << Qt::right
+        << "wins" << "win%" << "mean" << "p50" << "p90" << "p99" << "min" << "max" << qSetFieldWidth(0) << "\n";
+    const QString names[2] = {settings.first + " (a)", settings.second + " (b)"};
+    for (int side = 0; side < 2; ++side) {
+        StrategyStats s = summarize(results, side);
+        out << qSetFieldWidth(12) << Qt::left << names[side] << qSetFieldWidth(8) << Qt::right
+            << s.wins << QString::number(100.0 * s.wins / settings.games, 'f', 1)
+            << QString::number(s.meanShotsToWin, 'f', 2) << s.p50 << s.p90 << s.p99 << s.best << s.worst
+            << qSetFieldWidth(0) << "\n";
+    }
+    out << "\n" << QString::number(settings.games / seconds, 'f', 1) << " games/s ("
+        << QString::number(seconds, 'f', 2) << " s)\n";
+    return 0;
+}
@@ -0,0 +1,29 @@
+QT       = core concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = morskoy_selfplay
+
+# Ядро игры и боты берутся из клиента без виджетов
+CLIENT_DIR = ../../client
+INCLUDEPATH += $$CLIENT_DIR
+
+SOURCES += \
+    main.cpp \
+    tournament.cpp \
+    $$CLIENT_DIR/boardmodel.cpp \
+    $$CLIENT_DIR/densitybot.cpp \
+    $$CLIENT_DIR/fleetplacer.cpp \
+    $$CLIENT_DIR/montecarlobot.cpp \
+    $$CLIENT_DIR/queuebot.cpp
+
+HEADERS += \
+    tournament.h \
+    $$CLIENT_DIR/Ship.h \
+    $$CLIENT_DIR/boardmodel.h \
+    $$CLIENT_DIR/densitybot.h \
+    $$CLIENT_DIR/fleetplacer.h \
+    $$CLIENT_DIR/montecarlobot.h \
+    $$CLIENT_DIR/queuebot.h \
+    $$CLIENT_DIR/shooter.h
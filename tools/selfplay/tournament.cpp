@@ -0,0 +1,74 @@
+#include "tournament.h"
+#include <QRandomGenerator>
+#include <algorithm>
+#include "Ship.h"
+#include "boardmodel.h"
+#include "fleetplacer.h"
+#include "queuebot.h"
+#include "densitybot.h"
+#include "montecarlobot.h"
+
+QStringList shooterNames() {
+    return {"queue", "density", "montecarlo"};
+}
+
+std::unique_ptr<Shooter> createShooter(const QString &name, const TournamentSettings &settings) {
+    if (name == "queue") return std::unique_ptr<Shooter>(new QueueBot());
+    if (name == "density") return std::unique_ptr<Shooter>(new DensityBot());
+    if (name == "montecarlo") return std::unique_ptr<Shooter>(new MonteCarloShooter(settings.mcSamples));
+    return nullptr;
+}
+
+GameResult playGame(const TournamentSettings &settings, int gameIndex) {
+    // Свой генератор на партию: результат не зависит от числа потоков и порядка партий
+    QRandomGenerator rng(settings.seed + quint64(gameIndex) * 0x9E3779B97F4A7C15ULL);
+
+    std::unique_ptr<Shooter> shooters[2] = {createShooter(settings.first, settings),
+                                            createShooter(settings.second, settings)};
+    BoardModel boards[2]; // boards[i] — флот стороны i, по нему стреляет другая сторона
+    for (int side = 0; side < 2; ++side) {
+        boards[side].setFleet(FLEET_SIZES, FLEET_SHIP_COUNT);
+        FleetPlacer::placeFleet(boards[side], rng);
+        shooters[side]->reset(FLEET_SIZES, FLEET_SHIP_COUNT);
+    }
+
+    GameResult result;
+    int side = gameIndex % 2;
+    while (result.winner < 0) {
+        BoardModel &target = boards[1 - side];
+        int cell = shooters[side]->nextShot(rng);
+        if (cell < 0) { result.winner = 1 - side; break; } // Стратегии некуда стрелять — поражение
+
+        int x = cell % BoardModel::SIZE, y = cell / BoardModel::SIZE;
+        int res = target.receiveShot(x, y);
+        // Больше выстрелов, чем клеток, — стратегия зациклилась на повторах
+        if (++result.shots[side] > BoardModel::CELLS) { result.winner = 1 - side; break; }
+        shooters[side]->onShotResult(x, y, res);
+
+        if (target.isAllDestroyed()) result.winner = side;
+        else if (res <= 0) side = 1 - side; // Промах (или повтор) передает ход
+    }
+    return result;
+}
+
+StrategyStats summarize(const QVector<GameResult> &results, int side) {
+    StrategyStats stats;
+    QVector<int> shots;
+    for (const GameResult &r : results) {
+        if (r.winner == side) shots.append(r.shots[side]);
+    }
+    stats.wins = shots.size();
+    if (shots.isEmpty()) return stats;
+
+    std::sort(shots.begin(), shots.end());
+    long long total = 0;
+    for (int s : shots) total += s;
+    auto percentile = [&](int p) { return shots[std::min<int>(shots.size() - 1, shots.size() * p / 100)]; };
+    stats.meanShotsToWin = double(total) / shots.size();
+    stats.p50 = percentile(50);
+    stats.p90 = percentile(90);
+    stats.p99 = percentile(99);
+    stats.best = shots.first();
+    stats.worst = shots.last();
+    return stats;
+}
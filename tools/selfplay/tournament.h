@@ -0,0 +1,45 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include "shooter.h"
+
+// Итог одной партии: победитель (0 — первая стратегия, 1 — вторая) и выстрелы каждой стороны
+struct GameResult {
+    int winner = -1;
+    int shots[2] = {0, 0};
+};
+
+// Сводка по одной стратегии за турнир
+struct StrategyStats {
+    int wins = 0;
+    double meanShotsToWin = 0;
+    int p50 = 0;
+    int p90 = 0;
+    int p99 = 0;
+    int best = 0;
+    int worst = 0;
+};
+
+struct TournamentSettings {
+    QString first = "queue";
+    QString second = "density";
+    int games = 1000;
+    quint64 seed = 1;
+    int mcSamples = 2000;
+};
+
+// Известные стратегии: queue, density, montecarlo
+QStringList shooterNames();
+std::unique_ptr<Shooter> createShooter(const QString &name, const TournamentSettings &settings);
+
+// Одна партия по правилам GameWindow: флот из FLEET_SIZES, попадание дает еще один выстрел.
+// Первыми ходят поочередно, все случайное — от seed партии.
+GameResult playGame(const TournamentSettings &settings, int gameIndex);
+
+StrategyStats summarize(const QVector<GameResult> &results, int side);
+
+#endif // TOURNAMENT_H